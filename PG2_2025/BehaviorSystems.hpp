@@ -0,0 +1,555 @@
+#pragma once
+
+#include <vector>
+#include <unordered_set>
+#include <stdexcept>
+#include <glm/glm.hpp>
+
+#include "EntityStore.hpp"
+#include "JobSystem.hpp"
+#include "FastMath.hpp"
+#include "PathService.hpp"
+#include "NeighbourGrid.hpp"
+
+// Typed, batched versions of the common Behaviors.
+// Each system keeps its per-entity parameters and state in contiguous arrays and
+// updates all of its entities in one loop, instead of one type-erased closure call per
+// entity per frame. An entity can be registered at most once per system, so entries
+// can be updated in parallel without two chunks writing the same entity.
+// The closure API (Entity::addBehavior) stays available for one-off scripts.
+namespace BehaviorSystems {
+
+    // Time step per entity: uniform, or per dense index from UpdateScheduler.
+    // A step of 0 means the entity is not updated this step.
+    struct StepTimes {
+        float dt = 0.0f;
+        const float* perEntity = nullptr;
+
+        StepTimes(float dt) : dt(dt) {}
+        StepTimes(const std::vector<float>& times) : perEntity(times.data()) {}
+
+        float operator()(uint32_t d) const { return perEntity ? perEntity[d] : dt; }
+    };
+
+    // Shared bookkeeping: handle list, dense-index cache and dead-entry pruning
+    class SystemBase {
+    public:
+        size_t size() const { return handles.size(); }
+
+        bool contains(EntityHandle h) const { return slots.count(key(h)) != 0; }
+
+    protected:
+        std::vector<EntityHandle> handles;
+        std::vector<uint32_t> dense;           // resolved each update
+        std::unordered_set<uint64_t> slots;     // by index and generation: a recycled slot is a new entity
+
+        static uint64_t key(EntityHandle h) { return (static_cast<uint64_t>(h.index) << 32) | h.generation; }
+
+        bool registerHandle(EntityHandle h) {
+            if (!slots.insert(key(h)).second) return false;
+            handles.push_back(h);
+            dense.push_back(EntityStore::INVALID);
+            return true;
+        }
+
+        // Resolves handles to dense indices and drops entries whose entity is gone.
+        // removeAt(i) must swap-remove the system's own arrays.
+        template<typename RemoveFn>
+        void resolve(const EntityStore& store, RemoveFn removeAt) {
+            for (size_t i = 0; i < handles.size();) {
+                uint32_t d = store.indexOf(handles[i]);
+                if (d == EntityStore::INVALID) {
+                    slots.erase(key(handles[i]));
+                    handles[i] = handles.back(); handles.pop_back();
+                    dense[i] = dense.back(); dense.pop_back();
+                    removeAt(i);
+                    continue;
+                }
+                dense[i] = d;
+                ++i;
+            }
+        }
+
+        void saveHandles(SnapshotWriter& w) const {
+            w.writeArray(handles);
+        }
+
+        void loadHandles(SnapshotReader& r) {
+            r.readArray(handles);
+            dense.assign(handles.size(), EntityStore::INVALID);
+            slots.clear();
+            for (EntityHandle h : handles) slots.insert(key(h));
+        }
+
+        // Per-entity arrays must match the handle count after a load
+        template<typename... Arrays>
+        void checkSizes(const Arrays&... arrays) const {
+            if (((arrays.size() != handles.size()) || ...)) throw std::runtime_error("Snapshot: behavior arrays differ in size");
+        }
+
+        template<typename T>
+        static void swapRemove(std::vector<T>& v, size_t i) {
+            v[i] = v.back();
+            v.pop_back();
+        }
+
+        static constexpr size_t CHUNK = 1024;
+    };
+
+    // Walk in a circle around a center point using applyForce()
+    class WalkInCircle : public SystemBase {
+    public:
+        void add(EntityHandle h, glm::vec3 center, float radius, float speed = 1.0f) {
+            if (!registerHandle(h)) return;
+            centerX.push_back(center.x);
+            centerZ.push_back(center.z);
+            radii.push_back(radius);
+            speeds.push_back(speed);
+            angles.push_back(0.0f);
+        }
+
+        void update(EntityStore& store, StepTimes dt, JobSystem* jobs = nullptr) {
+            resolve(store, [this](size_t i) {
+                swapRemove(centerX, i); swapRemove(centerZ, i); swapRemove(radii, i);
+                swapRemove(speeds, i); swapRemove(angles, i);
+            });
+            const size_t n = size();
+            sinA.resize(n);
+            cosA.resize(n);
+
+            auto run = [&](size_t begin, size_t end, size_t) {
+                for (size_t i = begin; i < end; ++i) {
+                    angles[i] = FastMath::wrapAngle(angles[i] + speeds[i] * dt(dense[i]));
+                }
+                FastMath::sinCos(angles.data() + begin, sinA.data() + begin, cosA.data() + begin, end - begin);
+
+                for (size_t i = begin; i < end; ++i) {
+                    uint32_t d = dense[i];
+                    if (dt(d) == 0.0f) continue;
+                    const glm::vec3& p = store.positions[d];
+                    glm::vec3 toTarget(centerX[i] + cosA[i] * radii[i] - p.x, 0.0f, centerZ[i] + sinA[i] * radii[i] - p.z);
+                    store.accelerations[d] += glm::normalize(toTarget) * store.bodies[d].movementSpeed;
+                }
+            };
+            if (jobs) jobs->parallelFor(n, CHUNK, run);
+            else run(0, n, 0);
+        }
+
+        void save(SnapshotWriter& w) const {
+            saveHandles(w);
+            w.writeArray(centerX); w.writeArray(centerZ); w.writeArray(radii);
+            w.writeArray(speeds); w.writeArray(angles);
+        }
+
+        void load(SnapshotReader& r) {
+            loadHandles(r);
+            r.readArray(centerX); r.readArray(centerZ); r.readArray(radii);
+            r.readArray(speeds); r.readArray(angles);
+            checkSizes(centerX, centerZ, radii, speeds, angles);
+        }
+
+    private:
+        std::vector<float> centerX, centerZ, radii, speeds, angles;
+        std::vector<float> sinA, cosA;
+    };
+
+    // Jump on a timer (e.g., every 2 seconds)
+    class PeriodicJump : public SystemBase {
+    public:
+        void add(EntityHandle h, float strength = 5.0f, float interval = 2.0f) {
+            if (!registerHandle(h)) return;
+            strengths.push_back(strength);
+            intervals.push_back(interval);
+            timers.push_back(0.0f);
+        }
+
+        void update(EntityStore& store, StepTimes dt, JobSystem* jobs = nullptr) {
+            resolve(store, [this](size_t i) {
+                swapRemove(strengths, i); swapRemove(intervals, i); swapRemove(timers, i);
+            });
+
+            auto run = [&](size_t begin, size_t end, size_t) {
+                for (size_t i = begin; i < end; ++i) {
+                    timers[i] += dt(dense[i]);
+                }
+                for (size_t i = begin; i < end; ++i) {
+                    if (timers[i] < intervals[i]) continue;
+                    timers[i] = 0.0f;
+
+                    uint32_t d = dense[i];
+                    PhysicsBody& body = store.bodies[d];
+                    if (body.isGrounded) {
+                        store.velocities[d].y = strengths[i];
+                        body.isGrounded = false;
+                    }
+                }
+            };
+            if (jobs) jobs->parallelFor(size(), CHUNK, run);
+            else run(0, size(), 0);
+        }
+
+        void save(SnapshotWriter& w) const {
+            saveHandles(w);
+            w.writeArray(strengths); w.writeArray(intervals); w.writeArray(timers);
+        }
+
+        void load(SnapshotReader& r) {
+            loadHandles(r);
+            r.readArray(strengths); r.readArray(intervals); r.readArray(timers);
+            checkSizes(strengths, intervals, timers);
+        }
+
+    private:
+        std::vector<float> strengths, intervals, timers;
+    };
+
+    // Idle spin (rotate yaw)
+    class Spin : public SystemBase {
+    public:
+        void add(EntityHandle h, float degreesPerSecond = 90.0f) {
+            if (!registerHandle(h)) return;
+            rates.push_back(degreesPerSecond);
+        }
+
+        void update(EntityStore& store, StepTimes dt, JobSystem* jobs = nullptr) {
+            resolve(store, [this](size_t i) { swapRemove(rates, i); });
+            const size_t n = size();
+            yawRad.resize(n);
+            sinY.resize(n);
+            cosY.resize(n);
+
+            auto run = [&](size_t begin, size_t end, size_t) {
+                for (size_t i = begin; i < end; ++i) {
+                    Orientation& o = store.orientations[dense[i]];
+                    o.yaw += rates[i] * dt(dense[i]);
+                    yawRad[i] = glm::radians(o.yaw);
+                }
+                FastMath::sinCos(yawRad.data() + begin, sinY.data() + begin, cosY.data() + begin, end - begin);
+
+                static const glm::vec3 worldUp(0.0f, 1.0f, 0.0f);
+                for (size_t i = begin; i < end; ++i) {
+                    Orientation& o = store.orientations[dense[i]];
+                    float cp = std::cos(glm::radians(o.pitch));
+                    float sp = std::sin(glm::radians(o.pitch));
+                    o.front = glm::normalize(glm::vec3(cosY[i] * cp, sp, sinY[i] * cp));
+                    o.right = glm::normalize(glm::cross(o.front, worldUp));
+                    o.up = glm::normalize(glm::cross(o.right, o.front));
+                }
+            };
+            if (jobs) jobs->parallelFor(n, CHUNK, run);
+            else run(0, n, 0);
+        }
+
+        void save(SnapshotWriter& w) const {
+            saveHandles(w);
+            w.writeArray(rates);
+        }
+
+        void load(SnapshotReader& r) {
+            loadHandles(r);
+            r.readArray(rates);
+            checkSizes(rates);
+        }
+
+    private:
+        std::vector<float> rates;
+        std::vector<float> yawRad, sinY, cosY;
+    };
+
+    // Walk to a goal along a path from the PathService.
+    // Paths are requested in a serial pass and arrive in a later step (the service
+    // answers a bounded batch per step); until then the entity waits. A result is
+    // either waypoints, walked one after the other, or a flow field shared with every
+    // other entity heading for the same goal.
+    class FollowPath : public SystemBase {
+    public:
+        enum State : uint8_t { NeedsPath, Waiting, Following, Arrived, Failed };
+
+        void setService(PathService* pathService) { service = pathService; }
+
+        void add(EntityHandle h, glm::vec3 goal, float arriveRadius = 1.0f) {
+            if (!registerHandle(h)) return;
+            goals.push_back(goal);
+            radii.push_back(arriveRadius);
+            states.push_back(NeedsPath);
+            tickets.push_back(0);
+            routes.emplace_back();
+        }
+
+        State state(EntityHandle h) const {
+            for (size_t i = 0; i < handles.size(); ++i) if (handles[i] == h) return static_cast<State>(states[i]);
+            return Failed;
+        }
+
+        void update(EntityStore& store, StepTimes dt, JobSystem* jobs = nullptr) {
+            resolve(store, [this](size_t i) {
+                if (service && tickets[i]) service->cancel(tickets[i]);
+                swapRemove(goals, i); swapRemove(radii, i); swapRemove(states, i);
+                swapRemove(tickets, i); swapRemove(routes, i);
+            });
+            if (!service || !service->ready()) return;
+
+            // A rebuilt navigation grid invalidates every route
+            if (navigation != service->generation()) {
+                navigation = service->generation();
+                for (size_t i = 0; i < size(); ++i) {
+                    if (states[i] == Arrived) continue;
+                    if (tickets[i]) service->cancel(tickets[i]);
+                    tickets[i] = 0;
+                    routes[i] = Route{};
+                    states[i] = NeedsPath;
+                }
+            }
+
+            // Requests and results go through the service, one entity at a time
+            for (size_t i = 0; i < size(); ++i) {
+                if (states[i] == NeedsPath) {
+                    tickets[i] = service->request(store.positions[dense[i]], goals[i]);
+                    states[i] = Waiting;
+                }
+                if (states[i] != Waiting) continue;
+                PathResult result;
+                if (!service->take(tickets[i], result)) continue;
+                tickets[i] = 0;
+                if (result.status != PathStatus::Ready) {
+                    states[i] = Failed;
+                    continue;
+                }
+                routes[i].waypoints = std::move(result.waypoints);
+                routes[i].field = std::move(result.field);
+                routes[i].next = 0;
+                states[i] = Following;
+            }
+
+            const NavGrid& grid = service->navGrid();
+            const float cell = grid.cellSize();
+            auto run = [&](size_t begin, size_t end, size_t) {
+                for (size_t i = begin; i < end; ++i) {
+                    uint32_t d = dense[i];
+                    if (states[i] != Following || dt(d) == 0.0f) continue;
+                    const glm::vec3& p = store.positions[d];
+                    const float r2 = radii[i] * radii[i];
+                    if (distance2(p, goals[i]) <= r2) {
+                        states[i] = Arrived;
+                        continue;
+                    }
+
+                    Route& route = routes[i];
+                    glm::vec3 direction(0.0f);
+                    if (route.field) {
+                        direction = route.field->direction(p);
+                    }
+                    else {
+                        // Waypoints count as reached within a cell, the last one within the radius
+                        const float reach = std::max(r2, 0.25f * cell * cell);
+                        while (route.next + 1 < route.waypoints.size() && distance2(p, route.waypoints[route.next]) <= reach) ++route.next;
+                        if (route.next < route.waypoints.size()) {
+                            glm::vec3 toTarget = route.waypoints[route.next] - p;
+                            toTarget.y = 0.0f;
+                            const float length = glm::length(toTarget);
+                            if (length > 1e-4f) direction = toTarget / length;
+                        }
+                    }
+                    if (direction == glm::vec3(0.0f)) {
+                        // On the goal cell (the goal snapped to a walkable one) or at the end
+                        // of the waypoints: arrived. Anywhere else the route was lost, e.g.
+                        // pushed off it by a collision; ask again (Failed if no route is left).
+                        const bool atGoal = grid.cellAt(p) == grid.nearestWalkable(grid.cellAt(goals[i]))
+                            || (!route.field && !route.waypoints.empty() && route.next + 1 == route.waypoints.size());
+                        if (!atGoal) route = Route{};
+                        states[i] = atGoal ? Arrived : NeedsPath;
+                        continue;
+                    }
+                    store.accelerations[d] += direction * store.bodies[d].movementSpeed;
+                }
+            };
+            if (jobs) jobs->parallelFor(size(), CHUNK, run);
+            else run(0, size(), 0);
+        }
+
+        // Drops the outstanding path requests (before this system is replaced by a loaded one)
+        void cancelRequests() {
+            if (service) {
+                for (uint64_t ticket : tickets) if (ticket) service->cancel(ticket);
+            }
+            tickets.assign(size(), 0);
+        }
+
+        // Goals and arrivals are saved; routes are requested again after a load
+        void save(SnapshotWriter& w) const {
+            saveHandles(w);
+            w.writeArray(goals); w.writeArray(radii); w.writeArray(states);
+        }
+
+        void load(SnapshotReader& r) {
+            loadHandles(r);
+            r.readArray(goals); r.readArray(radii); r.readArray(states);
+            checkSizes(goals, radii, states);
+            for (uint8_t& s : states) if (s != Arrived) s = NeedsPath;
+            tickets.assign(size(), 0);
+            routes.assign(size(), Route{});
+        }
+
+    private:
+        struct Route {
+            std::vector<glm::vec3> waypoints;
+            std::shared_ptr<const FlowField> field;
+            size_t next = 0;
+        };
+
+        static float distance2(const glm::vec3& a, const glm::vec3& b) {
+            const float dx = a.x - b.x, dz = a.z - b.z;
+            return dx * dx + dz * dz;
+        }
+
+        PathService* service = nullptr;
+        uint64_t navigation = 0;            // service generation the routes belong to
+        std::vector<glm::vec3> goals;
+        std::vector<float> radii;
+        std::vector<uint8_t> states;
+        std::vector<PathTicket> tickets;
+        std::vector<Route> routes;
+    };
+
+    // Separation, alignment and cohesion between nearby members of the same group
+    // (fish schools, crowds). Each step the members' positions go into a NeighbourGrid,
+    // then every member looks at its nearest neighbours in parallel and accelerates by
+    // up to movementSpeed, like applyForce() from a closure behavior.
+    struct FlockSettings {
+        float neighbourRadius = 6.0f;
+        float separationRadius = 2.0f;
+        size_t maxNeighbours = 7;
+        float separation = 1.5f;
+        float alignment = 1.0f;
+        float cohesion = 0.8f;
+        bool planar = true;         // steer in the horizontal plane only (ground crowds)
+    };
+
+    class Flock : public SystemBase {
+    public:
+        FlockSettings settings;
+
+        void add(EntityHandle h, uint32_t group = 0) {
+            if (!registerHandle(h)) return;
+            groups.push_back(group);
+        }
+
+        void update(EntityStore& store, StepTimes dt, JobSystem* jobs = nullptr) {
+            resolve(store, [this](size_t i) { swapRemove(groups, i); });
+            const size_t n = size();
+            if (n == 0) return;
+            points.resize(n);
+            for (size_t i = 0; i < n; ++i) points[i] = store.positions[dense[i]];
+            grid.build(points.data(), n, settings.neighbourRadius, settings.planar);
+            scratch.resize(jobs ? jobs->threadCount() : 1);
+
+            const float separation2 = settings.separationRadius * settings.separationRadius;
+            const glm::vec3 axes = settings.planar ? glm::vec3(1.0f, 0.0f, 1.0f) : glm::vec3(1.0f);
+            auto run = [&](size_t begin, size_t end, size_t) {
+                NeighbourGrid::Scratch& s = scratch[jobs ? jobs->currentThread() : 0];
+                NeighbourGrid::Neighbour nearest[NeighbourGrid::MAX_NEIGHBOURS];
+                for (size_t i = begin; i < end; ++i) {
+                    uint32_t d = dense[i];
+                    if (dt(d) == 0.0f) continue;
+                    const size_t found = grid.nearest(points[i], static_cast<uint32_t>(i), settings.maxNeighbours, s, nearest);
+
+                    glm::vec3 away(0.0f), heading(0.0f), centre(0.0f);
+                    size_t mates = 0;
+                    for (size_t k = 0; k < found; ++k) {
+                        const uint32_t j = nearest[k].point;
+                        if (groups[j] != groups[i]) continue;
+                        const glm::vec3 offset = (points[i] - points[j]) * axes;
+                        if (nearest[k].distance2 < separation2) away += offset / std::max(nearest[k].distance2, 1e-4f);
+                        heading += store.velocities[dense[j]];
+                        centre += points[j];
+                        ++mates;
+                    }
+                    if (mates == 0) continue;
+
+                    const float inverse = 1.0f / static_cast<float>(mates);
+                    glm::vec3 steer = settings.separation * safeNormalize(away)
+                        + settings.alignment * safeNormalize((heading * inverse - store.velocities[d]) * axes)
+                        + settings.cohesion * safeNormalize((centre * inverse - points[i]) * axes);
+                    const float length = glm::length(steer);
+                    if (length > 1.0f) steer /= length;
+                    store.accelerations[d] += steer * store.bodies[d].movementSpeed;
+                }
+            };
+            if (jobs) jobs->parallelFor(n, FLOCK_CHUNK, run);
+            else run(0, n, 0);
+        }
+
+        void save(SnapshotWriter& w) const {
+            saveHandles(w);
+            w.writeArray(groups);
+        }
+
+        void load(SnapshotReader& r) {
+            loadHandles(r);
+            r.readArray(groups);
+            checkSizes(groups);
+        }
+
+    private:
+        static constexpr size_t FLOCK_CHUNK = 256;     // each member costs a neighbour query
+
+        static glm::vec3 safeNormalize(const glm::vec3& v) {
+            const float length2 = glm::dot(v, v);
+            return length2 > 1e-8f ? v / std::sqrt(length2) : glm::vec3(0.0f);
+        }
+
+        std::vector<uint32_t> groups;
+        std::vector<glm::vec3> points;      // positions by entry, this step
+        NeighbourGrid grid;
+        std::vector<NeighbourGrid::Scratch> scratch;
+    };
+
+    // All typed systems, updated once per simulation step before integration
+    struct Systems {
+        WalkInCircle walkInCircle;
+        PeriodicJump periodicJump;
+        Spin spin;
+        FollowPath followPath;
+        Flock flock;
+
+        bool contains(EntityHandle h) const {
+            return walkInCircle.contains(h) || periodicJump.contains(h) || spin.contains(h) || followPath.contains(h) || flock.contains(h);
+        }
+
+        void update(EntityStore& store, StepTimes dt, JobSystem* jobs = nullptr) {
+            walkInCircle.update(store, dt, jobs);
+            periodicJump.update(store, dt, jobs);
+            spin.update(store, dt, jobs);
+            followPath.update(store, dt, jobs);
+            flock.update(store, dt, jobs);
+        }
+
+        void save(SnapshotWriter& w) const {
+            w.beginSection(Snapshot::fourcc("BSYS"));
+            walkInCircle.save(w);
+            periodicJump.save(w);
+            spin.save(w);
+            w.endSection();
+
+            // Own section, so snapshots from before path following still load
+            w.beginSection(Snapshot::fourcc("FPTH"));
+            followPath.save(w);
+            w.endSection();
+
+            w.beginSection(Snapshot::fourcc("FLCK"));
+            flock.save(w);
+            w.endSection();
+        }
+
+        // False (and nothing read) if the snapshot has no behavior systems
+        bool load(SnapshotReader& r) {
+            if (!r.openSection(Snapshot::fourcc("BSYS"))) return false;
+            walkInCircle.load(r);
+            periodicJump.load(r);
+            spin.load(r);
+            if (r.openSection(Snapshot::fourcc("FPTH"))) followPath.load(r);
+            if (r.openSection(Snapshot::fourcc("FLCK"))) flock.load(r);
+            return true;
+        }
+    };
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Entity.hpp"
+#include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
 #include <functional>
 #include <cmath>
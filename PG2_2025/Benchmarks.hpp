@@ -0,0 +1,1524 @@
+#pragma once
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cmath>
+#include <cfloat>
+#include <random>
+#include <algorithm>
+#include <iterator>
+#include <filesystem>
+#include <memory>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/random.hpp>
+
+#include "EntityStore.hpp"
+#include "HeightField.hpp"
+#include "JobSystem.hpp"
+#include "Behaviors.hpp"
+#include "BehaviorSystems.hpp"
+#include "UpdateScheduler.hpp"
+#include "ScriptedBehaviors.hpp"
+#include "Snapshot.hpp"
+#include "World.hpp"
+#include "TransformHierarchy.hpp"
+#include "PathService.hpp"
+
+// CPU benchmarks, run with: PG2_2025.exe --bench [name]
+// They need no window or GL context.
+namespace Benchmarks {
+
+    using Clock = std::chrono::steady_clock;
+
+    inline double msSince(Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    // Rolling hills, roughly the size of the default heightmap
+    inline HeightField makeTestTerrain(int size = 205, float step = 5.0f) {
+        HeightField field;
+        field.cols = size;
+        field.rows = size;
+        field.step = step;
+        field.xOffset = (size - 1) * step * 0.5f;
+        field.zOffset = (size - 1) * step * 0.5f;
+        field.heights.resize(static_cast<size_t>(size) * size);
+        for (int j = 0; j < size; ++j)
+            for (int i = 0; i < size; ++i)
+                field.heights[static_cast<size_t>(j) * size + i] = 10.0f + 8.0f * std::sin(i * 0.1f) * std::cos(j * 0.13f);
+        return field;
+    }
+
+    // Deterministic entity layout on a grid, every 4th entity walks and jumps
+    inline void populate(EntityStore& store, size_t count) {
+        store.reserve(count);
+        int side = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(count))));
+        for (size_t i = 0; i < count; ++i) {
+            glm::vec3 p(static_cast<float>(i % side) * 2.0f - side, 20.0f, static_cast<float>(i / side) * 2.0f - side);
+            Entity e = store.get(store.create(p));
+            if (i % 4 == 0) {
+                e.addBehavior(Behaviors::WalkInCircle(p, 5.0f, 1.0f + (i % 7) * 0.1f));
+                e.addBehavior(Behaviors::PeriodicJump(5.0f, 1.0f + (i % 5) * 0.25f));
+            }
+        }
+    }
+
+    // Order-dependent hash of all positions, used to check determinism across runs
+    inline uint64_t checksum(const EntityStore& store) {
+        uint64_t h = 1469598103934665603ull;
+        for (const glm::vec3& p : store.positions) {
+            uint32_t bits[3];
+            std::memcpy(bits, &p, sizeof(bits));
+            for (uint32_t b : bits) { h ^= b; h *= 1099511628211ull; }
+        }
+        return h;
+    }
+
+    inline void entityUpdateScaling(size_t entityCount = 50000, int steps = 120) {
+        std::cout << "== Entity update scaling: " << entityCount << " entities, " << steps << " steps\n";
+        HeightField terrain = makeTestTerrain();
+        double baseline = 0.0;
+        uint64_t reference = 0;
+
+        for (unsigned int threads : { 1u, 2u, 4u, 8u, 16u }) {
+            EntityStore store;
+            populate(store, entityCount);
+            JobSystem jobs(threads);
+
+            auto start = Clock::now();
+            for (int s = 0; s < steps; ++s) {
+                store.integrate(1.0f / 60.0f, terrain, &jobs);
+            }
+            double ms = msSince(start) / steps;
+
+            uint64_t sum = checksum(store);
+            if (threads == 1) { baseline = ms; reference = sum; }
+
+            std::cout << "  threads " << std::setw(2) << threads
+                << ": " << std::fixed << std::setprecision(3) << ms << " ms/step"
+                << "  speedup " << std::setprecision(2) << baseline / ms << "x"
+                << "  " << (sum == reference ? "deterministic" : "MISMATCH") << "\n";
+        }
+    }
+
+    // Same WalkInCircle + PeriodicJump workload as closures and as typed systems
+    inline void behaviorPools(size_t entityCount = 50000, int steps = 120) {
+        std::cout << "== Behavior dispatch: " << entityCount << " entities, " << steps << " steps\n";
+        const float dt = 1.0f / 60.0f;
+
+        EntityStore closures;
+        closures.reserve(entityCount);
+        EntityStore typed;
+        typed.reserve(entityCount);
+        BehaviorSystems::Systems systems;
+        for (size_t i = 0; i < entityCount; ++i) {
+            glm::vec3 p(static_cast<float>(i % 256), 0.0f, static_cast<float>(i / 256));
+            Entity e = closures.get(closures.create(p));
+            e.addBehavior(Behaviors::WalkInCircle(p, 5.0f, 1.0f));
+            e.addBehavior(Behaviors::PeriodicJump(5.0f, 2.0f));
+
+            EntityHandle h = typed.create(p);
+            systems.walkInCircle.add(h, p, 5.0f, 1.0f);
+            systems.periodicJump.add(h, 5.0f, 2.0f);
+        }
+
+        // Behaviors only, no integration: isolates the dispatch cost
+        auto start = Clock::now();
+        for (int s = 0; s < steps; ++s) {
+            for (uint32_t i = 0; i < closures.size(); ++i) {
+                Entity self = closures.view(i);
+                for (auto& b : closures.behaviors[i]) b(self, dt);
+            }
+        }
+        double closureMs = msSince(start) / steps;
+
+        start = Clock::now();
+        for (int s = 0; s < steps; ++s) {
+            systems.update(typed, dt);
+        }
+        double typedMs = msSince(start) / steps;
+
+        std::cout << "  closures: " << std::fixed << std::setprecision(3) << closureMs << " ms/step\n"
+            << "  typed systems: " << typedMs << " ms/step (" << std::setprecision(2) << closureMs / typedMs << "x)\n";
+    }
+
+    // Full update of every entity vs. sleeping + distance-based tick rates.
+    // Entities are spread 4x wider than populate() so most of them are far from the focus.
+    inline void updateScheduling(size_t entityCount = 50000, int steps = 240) {
+        std::cout << "== Update scheduling: " << entityCount << " entities, " << steps << " steps\n";
+        const float dt = 1.0f / 60.0f;
+        HeightField terrain = makeTestTerrain();
+        int side = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(entityCount))));
+
+        auto build = [&](EntityStore& store, BehaviorSystems::Systems& systems) {
+            store.reserve(entityCount);
+            for (size_t i = 0; i < entityCount; ++i) {
+                glm::vec3 p((static_cast<float>(i % side) * 2.0f - side) * 2.0f, 20.0f, (static_cast<float>(i / side) * 2.0f - side) * 2.0f);
+                EntityHandle h = store.create(p);
+                if (i % 10 == 0) systems.walkInCircle.add(h, p, 5.0f, 1.0f);
+            }
+        };
+
+        // Let everything land first, then time the steady state
+        const int settleSteps = 300;
+
+        EntityStore fullStore;
+        BehaviorSystems::Systems fullSystems;
+        build(fullStore, fullSystems);
+        for (int s = 0; s < settleSteps; ++s) {
+            fullSystems.update(fullStore, dt);
+            fullStore.integrate(dt, terrain);
+        }
+        auto start = Clock::now();
+        for (int s = 0; s < steps; ++s) {
+            fullSystems.update(fullStore, dt);
+            fullStore.integrate(dt, terrain);
+        }
+        double fullMs = msSince(start) / steps;
+
+        EntityStore store;
+        BehaviorSystems::Systems systems;
+        build(store, systems);
+        UpdateScheduler scheduler;
+        scheduler.settings.ticksPerStep = SIZE_MAX; // measure the scheduling itself, not the budget
+        size_t ticked = 0, sleeping = 0;
+        for (int s = 0; s < settleSteps + steps; ++s) {
+            if (s == settleSteps) { start = Clock::now(); ticked = 0; }
+            scheduler.schedule(store, dt, glm::vec3(0.0f), systems);
+            systems.update(store, scheduler.stepTimes());
+            store.integrate(scheduler.due(), scheduler.stepTimes(), terrain);
+            ticked += scheduler.getStats().ticked;
+            sleeping = scheduler.getStats().sleeping;
+        }
+        double scheduledMs = msSince(start) / steps;
+
+        std::cout << "  every entity: " << std::fixed << std::setprecision(3) << fullMs << " ms/step\n"
+            << "  scheduled: " << scheduledMs << " ms/step (" << std::setprecision(2) << fullMs / scheduledMs << "x)"
+            << ", avg ticked " << ticked / steps << ", sleeping at end " << sleeping << "\n";
+    }
+
+    // PeriodicJump as per-step closures vs. coroutines parked in the timer wheel
+    inline void scriptedBehaviors(size_t entityCount = 50000, int steps = 240) {
+        std::cout << "== Scripted behaviors: " << entityCount << " entities, " << steps << " steps\n";
+        const float dt = 1.0f / 60.0f;
+
+        EntityStore closures;
+        closures.reserve(entityCount);
+        EntityStore scripted;
+        scripted.reserve(entityCount);
+        Scripts::Scheduler scripts(dt);
+        for (size_t i = 0; i < entityCount; ++i) {
+            glm::vec3 p(static_cast<float>(i % 256), 0.0f, static_cast<float>(i / 256));
+            float interval = 2.0f + (i % 16) * 0.25f;
+            closures.get(closures.create(p)).addBehavior(Behaviors::PeriodicJump(5.0f, interval));
+            scripts.start(scripted.create(p), ScriptedBehaviors::PeriodicJump(5.0f, interval));
+        }
+        scripts.update(scripted, 0.0f); // first resume parks every script in the wheel
+
+        // The scripted store integrates so jumps land and untilGrounded() resumes;
+        // the closures keep their timers without it. Only dispatch is timed.
+        HeightField terrain = makeTestTerrain();
+        double closureMs = 0.0, scriptMs = 0.0;
+        for (int s = 0; s < steps; ++s) {
+            auto start = Clock::now();
+            for (uint32_t i = 0; i < closures.size(); ++i) {
+                Entity self = closures.view(i);
+                for (auto& b : closures.behaviors[i]) b(self, dt);
+            }
+            closureMs += msSince(start);
+
+            start = Clock::now();
+            scripts.update(scripted, dt);
+            scriptMs += msSince(start);
+
+            scripted.integrate(dt, terrain);
+        }
+        closureMs /= steps;
+        scriptMs /= steps;
+
+        std::cout << "  closures: " << std::fixed << std::setprecision(3) << closureMs << " ms/step\n"
+            << "  coroutines: " << scriptMs << " ms/step (" << std::setprecision(2) << closureMs / scriptMs << "x)"
+            << ", " << scripts.sleeping() << " parked in the timer wheel\n";
+    }
+
+    // Spawn/despawn churn through the slot free list, with stale-handle checks
+    inline void handleChurn(size_t liveCount = 20000, size_t churnPerStep = 5000, int steps = 240) {
+        std::cout << "== Handle churn: " << liveCount << " live, " << churnPerStep << " spawn+despawn per step, " << steps << " steps\n";
+        EntityStore store;
+        store.reserve(liveCount + churnPerStep);
+        std::vector<EntityHandle> live;
+        for (size_t i = 0; i < liveCount; ++i) {
+            EntityHandle h = store.create(glm::vec3(0.0f));
+            store.get(h).addBehavior(Behaviors::Spin(10.0f));
+            live.push_back(h);
+        }
+        const EntityHandle first = live.front();
+        store.setName(first, "first");
+
+        std::vector<EntityHandle> stale;
+        size_t staleAccepted = 0;
+        uint64_t rng = 88172645463325252ull;
+        auto start = Clock::now();
+        for (int s = 0; s < steps; ++s) {
+            for (size_t k = 0; k < churnPerStep; ++k) {
+                rng ^= rng << 13; rng ^= rng >> 7; rng ^= rng << 17;
+                size_t pick = rng % live.size();
+                store.destroy(live[pick]);
+                if (stale.size() < 1024) stale.push_back(live[pick]);
+                live[pick] = store.create(glm::vec3(static_cast<float>(k), 0.0f, 0.0f));
+                store.get(live[pick]).addBehavior(Behaviors::Spin(10.0f));
+            }
+            for (EntityHandle h : stale) staleAccepted += store.alive(h);
+        }
+        double ms = msSince(start) / steps;
+
+        std::cout << "  " << std::fixed << std::setprecision(3) << ms << " ms/step ("
+            << std::setprecision(1) << ms * 1e6 / churnPerStep << " ns per spawn+despawn)"
+            << ", stale handles accepted: " << staleAccepted
+            << ", name lookup: " << (store.find("first") == (store.alive(first) ? first : EntityHandle{}) ? "ok" : "WRONG") << "\n";
+    }
+
+    // Full snapshot, delta against it, and restore of both, checked against the live state
+    inline void snapshots(size_t entityCount = 100000) {
+        std::cout << "== Snapshots: " << entityCount << " entities\n";
+        const float dt = 1.0f / 60.0f;
+        HeightField terrain = makeTestTerrain();
+        EntityStore store;
+        BehaviorSystems::Systems systems;
+        int side = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(entityCount))));
+        store.reserve(entityCount);
+        for (size_t i = 0; i < entityCount; ++i) {
+            EntityHandle h = store.create(glm::vec3(static_cast<float>(i % side) - side * 0.5f, 20.0f, static_cast<float>(i / side) - side * 0.5f));
+            if (i % 10 == 0) systems.walkInCircle.add(h, store.positions.back(), 5.0f, 1.0f);
+        }
+        for (int s = 0; s < 120; ++s) { systems.update(store, dt); store.integrate(dt, terrain); }
+        const std::vector<Model*> noModels;
+
+        // Writers are reused, as a checkpoint ring would; the first save only warms the buffer
+        SnapshotWriter base, current, delta, rebuilt;
+        store.save(base, noModels);
+        systems.save(base);
+
+        auto start = Clock::now();
+        base.reset();
+        store.save(base, noModels);
+        systems.save(base);
+        double saveMs = msSince(start);
+        uint64_t baseSum = checksum(store);
+
+        // Most entities are asleep on the ground, only the walkers move
+        for (int s = 0; s < 30; ++s) { systems.update(store, dt); store.integrate(dt, terrain); }
+        store.save(current, noModels);
+        systems.save(current);
+        uint64_t currentSum = checksum(store);
+
+        Snapshot::makeDelta(base.buffer, current.buffer, delta);
+        start = Clock::now();
+        Snapshot::makeDelta(base.buffer, current.buffer, delta);
+        double deltaMs = msSince(start);
+
+        start = Clock::now();
+        SnapshotReader fromBase(base.buffer);
+        store.load(fromBase, noModels);
+        systems.load(fromBase);
+        double loadMs = msSince(start);
+        bool baseOk = checksum(store) == baseSum;
+
+        Snapshot::applyDelta(base.buffer, delta.buffer, rebuilt);
+        start = Clock::now();
+        Snapshot::applyDelta(base.buffer, delta.buffer, rebuilt);
+        SnapshotReader fromDelta(rebuilt.buffer);
+        store.load(fromDelta, noModels);
+        systems.load(fromDelta);
+        double applyMs = msSince(start);
+        bool deltaOk = checksum(store) == currentSum;
+
+        std::cout << std::fixed << std::setprecision(3)
+            << "  save: " << saveMs << " ms (" << base.buffer.size() / 1024 << " KiB)\n"
+            << "  load: " << loadMs << " ms, " << (baseOk ? "matches" : "MISMATCH") << "\n"
+            << "  delta: " << deltaMs << " ms (" << delta.buffer.size() / 1024 << " KiB)\n"
+            << "  apply delta + load: " << applyMs << " ms, " << (deltaOk ? "matches" : "MISMATCH") << "\n";
+    }
+
+    // The collision pass as it was before the broadphase: every ordered pair, so each
+    // contact is found twice. Kept as the reference for collisionBroadphase.
+    inline void bruteForceContacts(const EntityStore& store, std::vector<World::Contact>& out) {
+        out.clear();
+        const size_t entityCount = store.size();
+        const std::vector<glm::vec3>& positions = store.positions;
+        const std::vector<Model*>& models = store.models;
+        for (size_t a = 0; a < entityCount; ++a) {
+            if (!models[a]) continue;
+            const glm::vec3 aPos = positions[a];
+            const float aRadius = glm::length(models[a]->boundingBoxMax - models[a]->boundingBoxMin) * 0.5f;
+
+            for (size_t b = 0; b < entityCount; ++b) {
+                if (a == b || !models[b]) continue;
+                const glm::vec3 bPos = positions[b];
+
+                float dist = glm::distance(aPos, bPos);
+                float combinedRadius = aRadius + glm::length(models[b]->boundingBoxMax - models[b]->boundingBoxMin) * 0.5f;
+                if (dist >= combinedRadius) continue;
+
+                glm::vec3 aMin = aPos + models[a]->boundingBoxMin;
+                glm::vec3 aMax = aPos + models[a]->boundingBoxMax;
+                glm::vec3 bMin = bPos + models[b]->boundingBoxMin;
+                glm::vec3 bMax = bPos + models[b]->boundingBoxMax;
+                bool intersects =
+                    (aMin.x <= bMax.x && aMax.x >= bMin.x) &&
+                    (aMin.y <= bMax.y && aMax.y >= bMin.y) &&
+                    (aMin.z <= bMax.z && aMax.z >= bMin.z);
+                if (intersects) out.push_back(World::Contact{ static_cast<uint32_t>(a), static_cast<uint32_t>(b) });
+            }
+        }
+    }
+
+    // Contact search of the old nested loop against the spatial hash and narrowphase, same
+    // random layout (about one entity per 16 m^2, three box sizes). The broadphase is
+    // checked against testing every pair of collider bounds.
+    inline void collisionBroadphase() {
+        std::cout << "== Collisions: nested loop vs spatial hash + GJK\n";
+        Model small, medium, large;
+        small.boundingBoxMin = glm::vec3(-0.4f, 0.0f, -0.4f);   small.boundingBoxMax = glm::vec3(0.4f, 0.6f, 0.4f);
+        medium.boundingBoxMin = glm::vec3(-0.8f, 0.0f, -0.6f);  medium.boundingBoxMax = glm::vec3(0.8f, 1.0f, 0.6f);
+        large.boundingBoxMin = glm::vec3(-1.5f, 0.0f, -1.5f);   large.boundingBoxMax = glm::vec3(1.5f, 2.0f, 1.5f);
+        Model* kinds[] = { &small, &medium, &medium, &large };
+
+        for (size_t entityCount : { 100u, 1000u, 10000u, 50000u }) {
+            World world(1);
+            world.contactMargin = 0.0f;     // exact bounds, for the check below
+            std::mt19937 rng(1234);
+            const float half = std::sqrt(entityCount * 16.0f) * 0.5f;
+            std::uniform_real_distribution<float> xz(-half, half);
+            std::uniform_real_distribution<float> y(0.0f, 1.5f);
+            world.entities.reserve(entityCount);
+            for (size_t i = 0; i < entityCount; ++i)
+                world.entities.create(glm::vec3(xz(rng), y(rng), xz(rng)), kinds[i % 4]);
+
+            // Enough repeats for a stable time, at least one pass
+            const int bruteRuns = std::max(1, static_cast<int>(2e7 / (static_cast<double>(entityCount) * entityCount)));
+            const int hashRuns = std::max(5, static_cast<int>(2e6 / entityCount));
+
+            std::vector<World::Contact> brute, hashed;
+            auto start = Clock::now();
+            for (int r = 0; r < bruteRuns; ++r) bruteForceContacts(world.entities, brute);
+            double bruteMs = msSince(start) / bruteRuns;
+
+            world.findContacts(hashed);
+            start = Clock::now();
+            for (int r = 0; r < hashRuns; ++r) world.findContacts(hashed);
+            double hashMs = msSince(start) / hashRuns;
+
+            // The broadphase must find exactly the pairs whose collider bounds overlap
+            std::vector<uint64_t> expected, found;
+            std::vector<glm::vec3> mins(entityCount), maxs(entityCount);
+            for (uint32_t i = 0; i < entityCount; ++i) world.colliderBounds(i, mins[i], maxs[i]);
+            for (uint32_t a = 0; a < entityCount; ++a) {
+                for (uint32_t b = a + 1; b < entityCount; ++b) {
+                    if (mins[a].x <= maxs[b].x && maxs[a].x >= mins[b].x && mins[a].y <= maxs[b].y && maxs[a].y >= mins[b].y &&
+                        mins[a].z <= maxs[b].z && maxs[a].z >= mins[b].z)
+                        expected.push_back(uint64_t(a) << 32 | b);
+                }
+            }
+            std::vector<World::Contact> candidates;
+            world.findCandidates(candidates);
+            for (const World::Contact& c : candidates) found.push_back(uint64_t(c.a) << 32 | c.b);
+            std::sort(found.begin(), found.end());
+            bool same = expected == found;
+
+            std::cout << "  " << std::setw(6) << entityCount << " entities: "
+                << std::fixed << std::setprecision(3)
+                << "nested loop " << std::setw(10) << bruteMs << " ms, "
+                << "spatial hash " << std::setw(7) << hashMs << " ms ("
+                << std::setprecision(1) << bruteMs / hashMs << "x), "
+                << brute.size() / 2 << " -> " << hashed.size() << " contacts, " << (same ? "broadphase exact" : "MISMATCH") << "\n";
+        }
+    }
+
+    // Yawed, elongated entities: contacts of the old axis-aligned test against GJK/EPA on
+    // convex hulls, narrowphase cost with and without the cached axes, and an EPA check
+    // (backing off by the reported depth must separate the pair, half of it must not).
+    inline void narrowphase(size_t entityCount = 10000, int steps = 60) {
+        std::cout << "== Narrowphase: " << entityCount << " yawed entities, " << steps << " steps\n";
+
+        // Fish-like body: points on an ellipsoid 3 x 0.8 x 0.8 standing on y = 0
+        std::mt19937 rng(7);
+        std::normal_distribution<float> gauss;
+        std::vector<glm::vec3> cloud(60000);
+        for (glm::vec3& p : cloud) {
+            glm::vec3 d = glm::normalize(glm::vec3(gauss(rng), gauss(rng), gauss(rng)));
+            p = glm::vec3(d.x * 1.5f, 0.4f + d.y * 0.4f, d.z * 0.4f);
+        }
+        Model fish;
+        auto start = Clock::now();
+        fish.hull = ConvexHull::build(cloud, Model::HULL_VERTICES);
+        double hullMs = msSince(start);
+        fish.boundingBoxMin = glm::vec3(-1.5f, 0.0f, -0.4f);
+        fish.boundingBoxMax = glm::vec3(1.5f, 0.8f, 0.4f);
+
+        World world(1);
+        world.contactMargin = 0.0f;     // exact shapes, for the EPA check
+        const float half = std::sqrt(entityCount * 20.0f) * 0.5f;
+        std::uniform_real_distribution<float> xz(-half, half);
+        std::uniform_real_distribution<float> angle(0.0f, 360.0f);
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+        world.entities.reserve(entityCount);
+        for (size_t i = 0; i < entityCount; ++i) {
+            world.entities.create(glm::vec3(xz(rng), 0.0f, xz(rng)), &fish);
+            world.entities.orientations[i].yaw = angle(rng);
+        }
+
+        std::vector<World::Contact> old, contacts;
+        bruteForceContacts(world.entities, old);
+        world.findContacts(contacts);
+        std::vector<uint64_t> oldPairs, newPairs, oldOnly, newOnly;
+        for (const World::Contact& c : old) if (c.a < c.b) oldPairs.push_back(uint64_t(c.a) << 32 | c.b);
+        for (const World::Contact& c : contacts) newPairs.push_back(uint64_t(std::min(c.a, c.b)) << 32 | std::max(c.a, c.b));
+        std::sort(oldPairs.begin(), oldPairs.end());
+        std::sort(newPairs.begin(), newPairs.end());
+        std::set_difference(oldPairs.begin(), oldPairs.end(), newPairs.begin(), newPairs.end(), std::back_inserter(oldOnly));
+        std::set_difference(newPairs.begin(), newPairs.end(), oldPairs.begin(), oldPairs.end(), std::back_inserter(newOnly));
+        const size_t newContacts = contacts.size();
+
+        // EPA check on the contacts found
+        size_t epaFailures = 0;
+        std::vector<glm::vec3>& positions = world.entities.positions;
+        for (const World::Contact& c : contacts) {
+            const glm::vec3 saved = positions[c.a];
+            World::Contact probe;
+            positions[c.a] = saved - c.normal * (c.depth * 1.01f + 1e-3f);
+            if (world.collide(c.a, c.b, probe)) ++epaFailures;
+            positions[c.a] = saved - c.normal * (c.depth * 0.5f);
+            if (!world.collide(c.a, c.b, probe)) ++epaFailures;
+            positions[c.a] = saved;
+        }
+
+        // Same motion twice: once starting every GJK query from scratch, once warm
+        auto simulate = [&](bool warm) {
+            std::mt19937 motion(11);
+            std::vector<glm::vec3> startPositions = positions;
+            std::vector<float> startYaws(entityCount);
+            for (size_t i = 0; i < entityCount; ++i) startYaws[i] = world.entities.orientations[i].yaw;
+            world.clearContactCache();
+            world.findContacts(contacts);
+            size_t found = 0;
+            double ms = 0.0;
+            for (int s = 0; s < steps; ++s) {
+                for (size_t i = 0; i < entityCount; ++i) {
+                    positions[i] += glm::vec3(std::uniform_real_distribution<float>(-0.02f, 0.02f)(motion), 0.0f,
+                        std::uniform_real_distribution<float>(-0.02f, 0.02f)(motion));
+                    world.entities.orientations[i].yaw += 0.5f;
+                }
+                if (!warm) world.clearContactCache();
+                auto t = Clock::now();
+                world.findContacts(contacts);
+                ms += msSince(t);
+                found += contacts.size();
+            }
+            positions = startPositions;
+            for (size_t i = 0; i < entityCount; ++i) world.entities.orientations[i].yaw = startYaws[i];
+            return std::make_pair(ms / steps, found);
+        };
+        auto [coldMs, coldFound] = simulate(false);
+        auto [warmMs, warmFound] = simulate(true);
+
+        std::cout << std::fixed << std::setprecision(2)
+            << "  quickhull: " << cloud.size() << " points -> " << fish.hull.points.size() << " vertices in " << hullMs << " ms\n"
+            << "  contacts: axis-aligned boxes " << oldPairs.size() << ", convex hulls " << newContacts
+            << " (" << oldOnly.size() << " false positives dropped, " << newOnly.size() << " missed contacts found)\n"
+            << "  EPA depth check: " << (epaFailures == 0 ? "ok" : "FAILED") << " (" << epaFailures << " of " << newContacts * 2 << ")\n"
+            << "  findContacts: " << coldMs << " ms/step cold, " << warmMs << " ms/step warm-started"
+            << (coldFound == warmFound ? ", same contacts" : ", MISMATCH") << "\n";
+    }
+
+    // The same moving crowd of yawed entities through findContacts on 1, 2, 4 and 8 worker
+    // threads. Contacts and impacts are merged in handle order, so every thread count must
+    // give the same lists.
+    inline void narrowphaseThreads(size_t entityCount = 20000, int steps = 30) {
+        std::cout << "== Parallel narrowphase: " << entityCount << " yawed entities, " << steps << " steps\n";
+        std::mt19937 rng(7);
+        std::normal_distribution<float> gauss;
+        std::vector<glm::vec3> cloud(4000);
+        for (glm::vec3& p : cloud) {
+            glm::vec3 d = glm::normalize(glm::vec3(gauss(rng), gauss(rng), gauss(rng)));
+            p = glm::vec3(d.x * 1.5f, 0.4f + d.y * 0.4f, d.z * 0.4f);
+        }
+        Model fish;
+        fish.hull = ConvexHull::build(cloud, Model::HULL_VERTICES);
+        fish.boundingBoxMin = glm::vec3(-1.5f, 0.0f, -0.4f);
+        fish.boundingBoxMax = glm::vec3(1.5f, 0.8f, 0.4f);
+
+        uint64_t reference = 0;
+        double singleMs = 0.0;
+        for (unsigned threads : { 1u, 2u, 4u, 8u }) {
+            World world(threads);
+            std::mt19937 placement(9);
+            const float half = std::sqrt(entityCount * 20.0f) * 0.5f;
+            std::uniform_real_distribution<float> xz(-half, half);
+            std::uniform_real_distribution<float> angle(0.0f, 360.0f);
+            std::uniform_real_distribution<float> nudge(-0.05f, 0.05f);
+            world.entities.reserve(entityCount);
+            for (size_t i = 0; i < entityCount; ++i) {
+                world.entities.create(glm::vec3(xz(placement), 0.0f, xz(placement)), &fish);
+                world.entities.orientations[i].yaw = angle(placement);
+                world.entities.velocities[i] = glm::vec3(nudge(placement), 0.0f, nudge(placement)) * 20.0f;
+            }
+
+            // Hash of every contact and impact, in the order findContacts returned them
+            uint64_t hash = 1469598103934665603ull;
+            auto mix = [&](uint64_t v) { hash = (hash ^ v) * 1099511628211ull; };
+            auto bits = [](float f) { uint32_t u; std::memcpy(&u, &f, sizeof(u)); return uint64_t(u); };
+
+            std::vector<World::Contact> contacts;
+            size_t contactCount = 0, impactCount = 0;
+            double ms = 0.0;
+            for (int s = 0; s < steps; ++s) {
+                for (size_t i = 0; i < entityCount; ++i) {
+                    world.entities.positions[i] += world.entities.velocities[i] * World::STEP;
+                    world.entities.orientations[i].yaw += 0.5f;
+                }
+                auto start = Clock::now();
+                world.findContacts(contacts);
+                ms += msSince(start);
+                for (const World::Contact& c : contacts) { mix(uint64_t(c.a) << 32 | c.b); mix(bits(c.depth)); }
+                for (const World::Impact& impact : world.getImpacts()) { mix(uint64_t(impact.a.index) << 32 | impact.b.index); mix(bits(impact.speed)); }
+                contactCount += contacts.size();
+                impactCount += world.getImpacts().size();
+            }
+            ms /= steps;
+            if (threads == 1) { reference = hash; singleMs = ms; }
+
+            std::cout << std::fixed << std::setprecision(2) << "  " << threads << " thread" << (threads > 1 ? "s: " : ":  ")
+                << ms << " ms/step (" << singleMs / ms << "x), " << contactCount / steps << " contacts and "
+                << impactCount / steps << " impacts per step, " << (hash == reference ? "same result" : "DIFFERENT RESULT") << "\n";
+        }
+    }
+
+    // Scene tree queries against iterating every entity, 50k entities with ~2% moving per step.
+    // Both sides test the same entity boxes, so the results must match exactly.
+    inline void sceneQueries(size_t entityCount = 50000, int queries = 2000) {
+        std::cout << "== Scene queries: " << entityCount << " entities, " << queries << " queries of each kind\n";
+        Model small, large;
+        small.boundingBoxMin = glm::vec3(-0.5f, 0.0f, -0.5f);  small.boundingBoxMax = glm::vec3(0.5f, 1.0f, 0.5f);
+        large.boundingBoxMin = glm::vec3(-1.5f, 0.0f, -1.5f);  large.boundingBoxMax = glm::vec3(1.5f, 2.5f, 1.5f);
+
+        World world(4);
+        std::mt19937 rng(99);
+        const float half = std::sqrt(entityCount * 25.0f) * 0.5f;
+        std::uniform_real_distribution<float> xz(-half, half);
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+        world.entities.reserve(entityCount);
+        for (size_t i = 0; i < entityCount; ++i)
+            world.entities.create(glm::vec3(xz(rng), 0.0f, xz(rng)), i % 8 == 0 ? &large : &small);
+
+        auto start = Clock::now();
+        world.updateScene();
+        double buildMs = msSince(start);
+
+        // A few seconds of wandering so the tree has been through many reinserts
+        double updateMs = 0.0;
+        const int moveSteps = 120;
+        for (int s = 0; s < moveSteps; ++s) {
+            for (size_t i = s % 50; i < entityCount; i += 50)
+                world.entities.positions[i] += glm::vec3(unit(rng), 0.0f, unit(rng)) * 0.5f;
+            start = Clock::now();
+            world.updateScene();
+            updateMs += msSince(start);
+        }
+        updateMs /= moveSteps;
+
+        const EntityStore& store = world.entities;
+        auto boxOf = [&](uint32_t i, glm::vec3& min, glm::vec3& max) {
+            min = store.positions[i] + store.models[i]->boundingBoxMin;
+            max = store.positions[i] + store.models[i]->boundingBoxMax;
+        };
+
+        std::vector<glm::vec3> origins(queries), directions(queries);
+        for (int q = 0; q < queries; ++q) {
+            origins[q] = glm::vec3(xz(rng), 0.5f + (unit(rng) + 1.0f), xz(rng));
+            directions[q] = glm::normalize(glm::vec3(unit(rng), unit(rng) * 0.1f, unit(rng)));
+        }
+        const float rayLength = 60.0f, sphereRadius = 10.0f;
+
+        // Rays: nearest hit
+        size_t mismatches = 0;
+        std::vector<float> bruteRay(queries), treeRay(queries);
+        start = Clock::now();
+        for (int q = 0; q < queries; ++q) {
+            float best = FLT_MAX;
+            const glm::vec3 inverse = 1.0f / directions[q];
+            for (uint32_t i = 0; i < store.size(); ++i) {
+                glm::vec3 min, max;
+                boxOf(i, min, max);
+                glm::vec3 t0 = (min - origins[q]) * inverse, t1 = (max - origins[q]) * inverse;
+                glm::vec3 tn = glm::min(t0, t1), tf = glm::max(t0, t1);
+                float enter = std::max(std::max(tn.x, tn.y), std::max(tn.z, 0.0f));
+                float exit = std::min(std::min(tf.x, tf.y), std::min(tf.z, rayLength));
+                if (enter <= exit && enter < best) best = enter;
+            }
+            bruteRay[q] = best;
+        }
+        double bruteRayMs = msSince(start);
+        start = Clock::now();
+        for (int q = 0; q < queries; ++q) {
+            World::SceneHit hit = world.raycast(origins[q], directions[q], rayLength);
+            treeRay[q] = hit.entity.isNull() ? FLT_MAX : hit.distance;
+        }
+        double treeRayMs = msSince(start);
+        for (int q = 0; q < queries; ++q) mismatches += bruteRay[q] != treeRay[q];
+
+        // Spheres and frustums: compare the sets found
+        auto sortedSlots = [](std::vector<EntityHandle>& v) {
+            std::vector<uint32_t> slots;
+            for (const EntityHandle& h : v) slots.push_back(h.index);
+            std::sort(slots.begin(), slots.end());
+            v.clear();
+            return slots;
+        };
+        std::vector<EntityHandle> found;
+        std::vector<std::vector<uint32_t>> bruteSets(queries);
+        size_t sphereHits = 0;
+        start = Clock::now();
+        for (int q = 0; q < queries; ++q) {
+            for (uint32_t i = 0; i < store.size(); ++i) {
+                glm::vec3 min, max;
+                boxOf(i, min, max);
+                glm::vec3 d = glm::max(glm::max(min - origins[q], origins[q] - max), glm::vec3(0.0f));
+                if (glm::dot(d, d) <= sphereRadius * sphereRadius) found.push_back(store.handles[i]);
+            }
+            bruteSets[q] = sortedSlots(found);
+        }
+        double bruteSphereMs = msSince(start);
+        start = Clock::now();
+        for (int q = 0; q < queries; ++q) {
+            world.entitiesInSphere(origins[q], sphereRadius, found);
+            sphereHits += found.size();
+            mismatches += sortedSlots(found) != bruteSets[q];
+        }
+        double treeSphereMs = msSince(start);
+
+        const int frustums = std::max(1, queries / 20);
+        std::vector<Frustum> views(frustums);
+        for (int q = 0; q < frustums; ++q) {
+            glm::mat4 projection = glm::perspective(glm::radians(70.0f), 16.0f / 9.0f, 0.1f, 150.0f);
+            glm::mat4 view = glm::lookAt(origins[q], origins[q] + directions[q], glm::vec3(0.0f, 1.0f, 0.0f));
+            views[q] = extractFrustum(projection * view);
+        }
+        size_t visible = 0;
+        start = Clock::now();
+        for (int q = 0; q < frustums; ++q) {
+            for (uint32_t i = 0; i < store.size(); ++i) {
+                glm::vec3 min, max;
+                boxOf(i, min, max);
+                if (isBoxInsideFrustum(views[q], min, max)) found.push_back(store.handles[i]);
+            }
+            bruteSets[q] = sortedSlots(found);
+        }
+        double bruteFrustumMs = msSince(start);
+        start = Clock::now();
+        for (int q = 0; q < frustums; ++q) {
+            world.entitiesInFrustum(views[q], found);
+            visible += found.size();
+            mismatches += sortedSlots(found) != bruteSets[q];
+        }
+        double treeFrustumMs = msSince(start);
+
+        // Concurrent readers must see the same answers
+        std::vector<float> parallelRay(queries);
+        world.jobs.parallelFor(queries, 64, [&](size_t begin, size_t end, size_t) {
+            for (size_t q = begin; q < end; ++q) {
+                World::SceneHit hit = world.raycast(origins[q], directions[q], rayLength);
+                parallelRay[q] = hit.entity.isNull() ? FLT_MAX : hit.distance;
+            }
+        });
+        mismatches += parallelRay != treeRay;
+
+        auto row = [](const char* what, double brute, double tree, int count) {
+            std::cout << "  " << std::left << std::setw(8) << what << std::right << std::fixed << std::setprecision(2)
+                << "brute force " << std::setw(8) << brute * 1000.0 / count << " us, tree " << std::setw(6) << tree * 1000.0 / count
+                << " us per query (" << std::setprecision(0) << brute / tree << "x)\n";
+        };
+        std::cout << std::fixed << std::setprecision(2)
+            << "  build: " << buildMs << " ms, update: " << std::setprecision(3) << updateMs << " ms/step, height " << world.getScene().height() << "\n";
+        row("ray", bruteRayMs, treeRayMs, queries);
+        row("sphere", bruteSphereMs, treeSphereMs, queries);
+        row("frustum", bruteFrustumMs, treeFrustumMs, frustums);
+        std::cout << "  " << sphereHits / queries << " entities per sphere, " << visible / frustums << " per frustum, "
+            << (mismatches == 0 ? "results match" : "MISMATCH") << "\n";
+    }
+
+    // Bumpy sphere of radius ~1 with 2 * rows * cols triangles
+    inline void makeBumpySphere(int rows, int cols, std::vector<glm::vec3>& positions, std::vector<uint32_t>& indices) {
+        positions.clear();
+        indices.clear();
+        for (int r = 0; r <= rows; ++r) {
+            float theta = glm::pi<float>() * r / rows;
+            for (int c = 0; c <= cols; ++c) {
+                float phi = glm::two_pi<float>() * c / cols;
+                float radius = 1.0f + 0.15f * std::sin(5.0f * theta) * std::cos(7.0f * phi);
+                positions.push_back(radius * glm::vec3(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi)));
+            }
+        }
+        for (int r = 0; r < rows; ++r) {
+            for (int c = 0; c < cols; ++c) {
+                uint32_t a = r * (cols + 1) + c, b = a + 1, d = a + cols + 1, e = d + 1;
+                indices.insert(indices.end(), { a, d, b, b, d, e });
+            }
+        }
+    }
+
+    // Every triangle, for checking the BVH
+    inline float bruteForceRay(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices,
+        const glm::vec3& o, const glm::vec3& d, float maxDistance) {
+        float best = maxDistance;
+        for (size_t t = 0; t < indices.size(); t += 3) {
+            const glm::vec3 v0 = positions[indices[t]];
+            const glm::vec3 e1 = positions[indices[t + 1]] - v0, e2 = positions[indices[t + 2]] - v0;
+            const glm::vec3 p = glm::cross(d, e2);
+            const float det = glm::dot(e1, p);
+            if (std::abs(det) <= 1e-12f) continue;
+            const glm::vec3 s = o - v0;
+            const float u = glm::dot(s, p) / det;
+            const glm::vec3 q = glm::cross(s, e1);
+            const float v = glm::dot(d, q) / det;
+            const float dist = glm::dot(e2, q) / det;
+            if (u >= 0.0f && v >= 0.0f && u + v <= 1.0f && dist >= 0.0f && dist < best) best = dist;
+        }
+        return best;
+    }
+
+    // Triangle BVH: build and cache load time, closest-hit and any-hit rays per second on a
+    // 200k triangle mesh (checked against every triangle), and exact world ray casts
+    // against yawed entities sharing one mesh.
+    inline void triangleBVH(int rays = 1000000) {
+        std::vector<glm::vec3> positions;
+        std::vector<uint32_t> indices;
+        makeBumpySphere(250, 400, positions, indices);
+        std::cout << "== Triangle BVH: " << indices.size() / 3 << " triangles, " << rays << " rays\n";
+
+        auto start = Clock::now();
+        auto bvh = std::make_shared<TriangleBVH>();
+        bvh->build(positions, indices);
+        double buildMs = msSince(start);
+
+        // Rays from a shell around the mesh towards points near it: about half hit
+        std::mt19937 rng(7);
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+        auto onSphere = [&](float radius) {
+            glm::vec3 p;
+            do p = glm::vec3(unit(rng), unit(rng), unit(rng)); while (glm::dot(p, p) > 1.0f || glm::dot(p, p) < 1e-4f);
+            return glm::normalize(p) * radius;
+        };
+        std::vector<glm::vec3> origins(rays), directions(rays);
+        for (int q = 0; q < rays; ++q) {
+            origins[q] = onSphere(3.0f);
+            directions[q] = glm::normalize(onSphere(1.6f * std::abs(unit(rng))) - origins[q]);
+        }
+        const float rayLength = 10.0f;
+
+        size_t hits = 0;
+        start = Clock::now();
+        for (int q = 0; q < rays; ++q) {
+            TriangleBVH::Hit hit;
+            hits += bvh->raycast(origins[q], directions[q], rayLength, hit);
+        }
+        double closestMs = msSince(start);
+        size_t blocked = 0;
+        start = Clock::now();
+        for (int q = 0; q < rays; ++q) blocked += bvh->occluded(origins[q], directions[q], rayLength);
+        double anyMs = msSince(start);
+
+        const int checked = 300;
+        int mismatches = blocked != hits ? 1 : 0;
+        for (int q = 0; q < checked; ++q) {
+            float expected = bruteForceRay(positions, indices, origins[q], directions[q], rayLength);
+            TriangleBVH::Hit hit;
+            float got = bvh->raycast(origins[q], directions[q], rayLength, hit) ? hit.distance : rayLength;
+            mismatches += std::abs(expected - got) > 1e-4f;
+        }
+
+        // Cache file: first call builds and writes it, second reads it back
+        const std::filesystem::path cachePath = std::filesystem::temp_directory_path() / "pg2_bench.bvh";
+        std::filesystem::remove(cachePath);
+        start = Clock::now();
+        auto built = TriangleBVH::loadOrBuild(positions, indices, cachePath);
+        double buildSaveMs = msSince(start);
+        start = Clock::now();
+        auto loaded = TriangleBVH::loadOrBuild(positions, indices, cachePath);
+        double loadMs = msSince(start);
+        const uintmax_t cacheBytes = std::filesystem::file_size(cachePath);
+        std::filesystem::remove(cachePath);
+        int cacheMismatches = 0;
+        for (int q = 0; q < 10000; ++q) {
+            TriangleBVH::Hit a, b;
+            bool ha = built->raycast(origins[q], directions[q], rayLength, a);
+            bool hb = loaded->raycast(origins[q], directions[q], rayLength, b);
+            cacheMismatches += ha != hb || a.triangle != b.triangle || a.distance != b.distance;
+        }
+
+        // World: a field of yawed copies of a smaller mesh, each ray checked against the
+        // triangles moved to world space
+        std::vector<glm::vec3> small;
+        std::vector<uint32_t> smallIndices;
+        makeBumpySphere(24, 40, small, smallIndices);
+        auto smallBvh = std::make_shared<TriangleBVH>();
+        smallBvh->build(small, smallIndices);
+        Model blob;
+        blob.origin = glm::vec3(0.0f, 1.0f, 0.0f);
+        blob.boundingBoxMin = glm::vec3(-1.2f, -0.2f, -1.2f);
+        blob.boundingBoxMax = glm::vec3(1.2f, 2.2f, 1.2f);
+        blob.hull = ConvexHull::build(small, Model::HULL_VERTICES);
+        blob.setTriangleBVH(smallBvh);
+
+        const size_t entityCount = 2000;
+        World world(1);
+        const float half = std::sqrt(entityCount * 40.0f) * 0.5f;
+        std::uniform_real_distribution<float> xz(-half, half);
+        std::uniform_real_distribution<float> yaw(0.0f, 360.0f);
+        for (size_t i = 0; i < entityCount; ++i) {
+            world.entities.create(glm::vec3(xz(rng), 0.0f, xz(rng)), &blob);
+            world.entities.orientations[i].yaw = yaw(rng);
+        }
+        world.updateScene();
+
+        const int worldRays = 20000;
+        std::vector<glm::vec3> worldOrigins(worldRays), worldDirections(worldRays);
+        for (int q = 0; q < worldRays; ++q) {
+            worldOrigins[q] = glm::vec3(xz(rng), 1.0f + unit(rng), xz(rng));
+            worldDirections[q] = glm::normalize(glm::vec3(unit(rng), unit(rng) * 0.2f, unit(rng)));
+        }
+        const float worldLength = 30.0f;
+        size_t boxHits = 0, meshHits = 0, segmentsBlocked = 0;
+        start = Clock::now();
+        for (int q = 0; q < worldRays; ++q) boxHits += !world.raycast(worldOrigins[q], worldDirections[q], worldLength).entity.isNull();
+        double boxMs = msSince(start);
+        start = Clock::now();
+        for (int q = 0; q < worldRays; ++q) meshHits += !world.raycastMesh(worldOrigins[q], worldDirections[q], worldLength).entity.isNull();
+        double meshMs = msSince(start);
+        start = Clock::now();
+        for (int q = 0; q < worldRays; ++q)
+            segmentsBlocked += world.segmentBlocked(worldOrigins[q], worldOrigins[q] + worldDirections[q] * worldLength);
+        double segmentMs = msSince(start);
+
+        int worldMismatches = segmentsBlocked != meshHits ? 1 : 0;
+        std::vector<glm::vec3> moved(small.size());
+        std::vector<float> expected(200, worldLength);
+        for (uint32_t i = 0; i < world.entities.size(); ++i) {
+            const glm::mat3 r = glm::mat3_cast(glm::quat(glm::radians(glm::vec3(0.0f, -world.entities.orientations[i].yaw - 90.0f, 0.0f))));
+            for (size_t k = 0; k < small.size(); ++k) moved[k] = world.entities.positions[i] + blob.origin + r * small[k];
+            for (int q = 0; q < 200; ++q)
+                expected[q] = std::min(expected[q], bruteForceRay(moved, smallIndices, worldOrigins[q], worldDirections[q], worldLength));
+        }
+        for (int q = 0; q < 200; ++q) {
+            World::SceneHit hit = world.raycastMesh(worldOrigins[q], worldDirections[q], worldLength);
+            float got = hit.entity.isNull() ? worldLength : hit.distance;
+            worldMismatches += std::abs(got - expected[q]) > 1e-3f;
+        }
+
+        std::cout << std::fixed << std::setprecision(2)
+            << "  build: " << buildMs << " ms, " << bvh->nodeCount() << " nodes\n"
+            << "  closest hit: " << rays / closestMs / 1000.0 << " M rays/s (" << hits << " hits)\n"
+            << "  any hit:     " << rays / anyMs / 1000.0 << " M rays/s\n"
+            << "  against every triangle: " << (mismatches == 0 ? "ok" : "MISMATCH") << " (" << checked << " rays)\n"
+            << "  cache file: " << cacheBytes / 1024 << " KiB, build + write " << buildSaveMs << " ms, load " << loadMs << " ms"
+            << (cacheMismatches == 0 ? ", same hits" : ", MISMATCH") << "\n"
+            << "  world, " << entityCount << " entities of " << smallIndices.size() / 3 << " triangles: box "
+            << worldRays / boxMs / 1000.0 << " M rays/s (" << boxHits << " hits), mesh "
+            << worldRays / meshMs / 1000.0 << " M rays/s (" << meshHits << " hits), segments "
+            << worldRays / segmentMs / 1000.0 << " M/s\n"
+            << "  world rays against every triangle: " << (worldMismatches == 0 ? "ok" : "MISMATCH") << "\n";
+    }
+
+    // Crowd settling: piles of overlapping boxes dropped on flat ground. The old response
+    // (a fixed velocity kick per contact and step, copied from World before the solver)
+    // against the contact solver after ten seconds, and the solver's result on one and
+    // four threads, which must be identical since islands share no bodies.
+    inline void contactSolver(size_t piles = 40, size_t perPile = 100, int steps = 600) {
+        std::cout << "== Contact solver: " << piles << " piles of " << perPile << " boxes, " << steps << " steps\n";
+        Model box;
+        box.boundingBoxMin = glm::vec3(-0.5f, 0.0f, -0.5f);
+        box.boundingBoxMax = glm::vec3(0.5f, 1.0f, 0.5f);
+        box.hull = ConvexHull::box(box.boundingBoxMin, box.boundingBoxMax);
+
+        struct Result {
+            double stepMs = 0.0;
+            size_t contacts = 0, sleeping = 0, islands = 0;
+            float meanDepth = 0.0f, maxDepth = 0.0f, meanSpeed = 0.0f;
+            uint64_t checksum = 0;
+        };
+        auto simulate = [&](unsigned threads, bool legacy) {
+            World world(threads);
+            std::mt19937 rng(5);
+            std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+            const int side = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(piles))));
+            for (size_t p = 0; p < piles; ++p) {
+                const glm::vec3 center((p % side) * 30.0f, 0.0f, (p / side) * 30.0f);
+                for (size_t k = 0; k < perPile; ++k) {
+                    float angle = glm::two_pi<float>() * unit(rng), radius = 3.0f * std::sqrt(unit(rng));
+                    world.entities.create(center + glm::vec3(radius * std::cos(angle), 4.0f * unit(rng), radius * std::sin(angle)), &box);
+                }
+            }
+
+            Result r;
+            std::vector<World::Contact> contacts;
+            const glm::vec3 focus(0.0f);
+            for (int s = 0; s < steps; ++s) {
+                auto start = Clock::now();
+                if (legacy) {
+                    world.scheduler.schedule(world.entities, World::STEP, focus, world.behaviorSystems);
+                    world.entities.integrate(world.scheduler.due(), world.scheduler.stepTimes(), world.terrain, &world.jobs);
+                    world.findContacts(contacts);
+                    for (const World::Contact& c : contacts) {
+                        world.entities.velocities[c.a] -= c.normal * 10.0f;
+                        world.entities.velocities[c.b] += c.normal * 10.0f;
+                        Particles::spawn(c.point, 100);
+                    }
+                    Particles::update(World::STEP);
+                }
+                else {
+                    world.step(World::STEP, focus);
+                }
+                r.stepMs += msSince(start);
+            }
+            r.stepMs /= steps;
+
+            if (!legacy) {
+                contacts = world.getContacts();
+                r.islands = world.contactSolver.getStats().islands;
+            }
+            r.contacts = contacts.size();
+            for (const World::Contact& c : contacts) {
+                r.meanDepth += c.depth;
+                r.maxDepth = std::max(r.maxDepth, c.depth);
+            }
+            if (!contacts.empty()) r.meanDepth /= contacts.size();
+            for (uint32_t i = 0; i < world.entities.size(); ++i) {
+                r.meanSpeed += glm::length(world.entities.velocities[i]);
+                r.sleeping += world.entities.activity[i].sleeping;
+            }
+            r.meanSpeed /= world.entities.size();
+            r.checksum = checksum(world.entities);
+            return r;
+        };
+
+        auto report = [](const char* label, const Result& r) {
+            std::cout << std::fixed << std::setprecision(3) << "  " << label << ": " << r.stepMs << " ms/step, "
+                << r.contacts << " contacts left, depth mean " << r.meanDepth << " max " << r.maxDepth
+                << ", mean speed " << r.meanSpeed << " m/s, " << r.sleeping << " asleep";
+            if (r.islands) std::cout << ", " << r.islands << " islands";
+            std::cout << "\n";
+        };
+        Result legacy = simulate(1, true);
+        Result single = simulate(1, false);
+        Result parallel = simulate(4, false);
+        report("velocity kick ", legacy);
+        report("solver, 1 thread ", single);
+        report("solver, 4 threads", parallel);
+        std::cout << "  thread count " << (single.checksum == parallel.checksum ? "does not change the result" : "CHANGES THE RESULT") << "\n";
+
+        // A box resting on another; destroying an unrelated entity moves the top box to
+        // dense index 0, ahead of the box under it. The pair keeps touching: no new impact.
+        World world(1);
+        const EntityHandle other = world.entities.create(glm::vec3(100.0f, 0.0f, 100.0f));
+        world.entities.create(glm::vec3(0.0f), &box);
+        world.entities.create(glm::vec3(0.0f, 1.0f, 0.0f), &box);
+        for (int s = 0; s < 300; ++s) world.step(World::STEP, glm::vec3(0.0f));
+        const size_t touching = world.getContacts().size();
+        world.entities.destroy(other);
+        size_t falseImpacts = 0;
+        for (int s = 0; s < 10; ++s) {
+            world.step(World::STEP, glm::vec3(0.0f));
+            falseImpacts += world.getImpacts().size();
+        }
+        std::cout << "  resting pair across a swap-remove: " << touching << " contact, "
+            << (falseImpacts == 0 && world.getContacts().size() == touching ? "no new impacts" : "NEW IMPACTS") << "\n";
+    }
+
+    // Per-draw matrices as Mesh::draw built them (Euler angles -> quaternion -> matrix,
+    // translate, projection * view * model, inverse(view)) against the cached hierarchy:
+    // 20k entities with a prop attached and a light on each prop, 2% of the entities moving
+    // per frame. Draw-side work on both sides ends in the same MVP matrices.
+    inline void transformCache(size_t entityCount = 20000, int frames = 120) {
+        std::cout << "== Transform cache: " << entityCount << " entities with 2 attached nodes each, " << frames << " frames\n";
+        std::mt19937 rng(3);
+        std::uniform_real_distribution<float> xz(-500.0f, 500.0f);
+        std::uniform_real_distribution<float> angle(0.0f, 360.0f);
+        std::vector<glm::vec3> positions(entityCount);
+        std::vector<float> yaws(entityCount);
+        for (size_t i = 0; i < entityCount; ++i) { positions[i] = glm::vec3(xz(rng), 0.0f, xz(rng)); yaws[i] = angle(rng); }
+        const glm::vec3 propOffset(0.5f, 1.2f, 0.0f), lightOffset(0.0f, 0.3f, 0.2f);
+        const glm::vec3 propEuler(0.0f, 30.0f, 10.0f);
+
+        const glm::mat4 projection = glm::perspective(glm::radians(45.0f), 800.0f / 600.0f, 0.1f, 1000.0f);
+        const glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 20.0f, 50.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        auto move = [&](int frame) {
+            for (size_t i = frame % 50; i < entityCount; i += 50) { positions[i].x += 0.01f; yaws[i] += 1.0f; }
+        };
+        auto checksumOf = [](const glm::mat4& m) { return m[0][0] + m[1][1] + m[2][2] + m[3][0] + m[3][1] + m[3][2]; };
+
+        // Legacy: every node's chain rebuilt on every draw
+        std::vector<glm::vec3> startPositions = positions;
+        std::vector<float> startYaws = yaws;
+        double legacySum = 0.0;
+        auto start = Clock::now();
+        for (int f = 0; f < frames; ++f) {
+            move(f);
+            for (size_t i = 0; i < entityCount; ++i) {
+                const glm::mat4 body = glm::translate(glm::mat4(1.0f), positions[i]) * glm::mat4_cast(glm::quat(glm::radians(glm::vec3(0.0f, yaws[i], 0.0f))));
+                const glm::mat4 prop = body * glm::translate(glm::mat4(1.0f), propOffset) * glm::mat4_cast(glm::quat(glm::radians(propEuler)));
+                const glm::mat4 light = prop * glm::translate(glm::mat4(1.0f), lightOffset);
+                for (const glm::mat4* model : { &body, &prop, &light }) {
+                    glm::mat4 mvp = projection * view * *model;
+                    glm::vec3 eye = glm::vec3(glm::inverse(view)[3]);
+                    legacySum += checksumOf(mvp) + eye.x;
+                }
+            }
+        }
+        double legacyMs = msSince(start) / frames;
+
+        auto cached = [&](JobSystem* jobs, double& sum, double& updateMs, size_t& recomputed) {
+            positions = startPositions;
+            yaws = startYaws;
+            TransformHierarchy transforms;
+            std::vector<TransformHierarchy::Id> bodies(entityCount), props(entityCount), lights(entityCount);
+            for (size_t i = 0; i < entityCount; ++i) {
+                bodies[i] = transforms.create();
+                props[i] = transforms.create(bodies[i]);
+                lights[i] = transforms.create(props[i]);
+                transforms.setTranslation(props[i], propOffset);
+                transforms.setRotation(props[i], glm::quat(glm::radians(propEuler)));
+                transforms.setTranslation(lights[i], lightOffset);
+            }
+            auto sync = [&]() {
+                for (size_t i = 0; i < entityCount; ++i) {
+                    transforms.setTranslation(bodies[i], positions[i]);
+                    transforms.setRotation(bodies[i], glm::angleAxis(glm::radians(yaws[i]), glm::vec3(0.0f, 1.0f, 0.0f)));
+                }
+                transforms.update(jobs);
+            };
+            sync();
+            sum = 0.0;
+            updateMs = 0.0;
+            recomputed = 0;
+            auto begin = Clock::now();
+            for (int f = 0; f < frames; ++f) {
+                move(f);
+                auto t = Clock::now();
+                sync();
+                updateMs += msSince(t);
+                recomputed += transforms.lastRecomputed();
+                const glm::vec3 eye = Mesh::eyePosition(view);
+                for (size_t i = 0; i < entityCount; ++i) {
+                    for (TransformHierarchy::Id node : { bodies[i], props[i], lights[i] }) {
+                        glm::mat4 mvp = projection * view * transforms.world(node);
+                        sum += checksumOf(mvp) + eye.x;
+                    }
+                }
+            }
+            updateMs /= frames;
+            return msSince(begin) / frames;
+        };
+        double singleSum, singleUpdate, parallelSum, parallelUpdate;
+        size_t singleRecomputed, parallelRecomputed;
+        JobSystem pool(4);
+        double singleMs = cached(nullptr, singleSum, singleUpdate, singleRecomputed);
+        double parallelMs = cached(&pool, parallelSum, parallelUpdate, parallelRecomputed);
+        const double tolerance = 1e-6 * std::abs(legacySum) + 1e-3;
+
+        std::cout << std::fixed << std::setprecision(3)
+            << "  rebuilt per draw: " << legacyMs << " ms/frame\n"
+            << "  cached:           " << singleMs << " ms/frame (" << legacyMs / singleMs << "x), hierarchy update "
+            << singleUpdate << " ms, " << singleRecomputed / frames << " of " << entityCount * 3 << " nodes recomputed per frame\n"
+            << "  cached, 4 threads: " << parallelMs << " ms/frame, hierarchy update " << parallelUpdate << " ms\n"
+            << "  MVP matrices " << (std::abs(singleSum - legacySum) < tolerance ? "match" : "MISMATCH")
+            << ", thread count " << (singleSum == parallelSum && singleRecomputed == parallelRecomputed ? "does not change the result" : "CHANGES THE RESULT") << "\n";
+    }
+
+    // Hills split by steep ridges with a few gaps, so paths have to detour
+    inline HeightField makeRidgeTerrain(int size = 257, float step = 5.0f) {
+        HeightField field = makeTestTerrain(size, step);
+        for (int j = 0; j < size; ++j) {
+            for (int i = 0; i < size; ++i) {
+                const bool ridgeX = i % 48 == 24 && j % 64 > 6;
+                const bool ridgeZ = j % 48 == 40 && (i + 20) % 72 > 8;
+                if (ridgeX || ridgeZ) field.heights[static_cast<size_t>(j) * size + i] += 40.0f;
+            }
+        }
+        return field;
+    }
+
+    inline void pathfinding(size_t queries = 500, size_t agents = 5000) {
+        std::cout << "== Pathfinding: " << queries << " queries, " << agents << " agents\n";
+        const HeightField terrain = makeRidgeTerrain();
+        JobSystem pool(4);
+
+        PathService service;
+        auto start = Clock::now();
+        service.build(terrain, &pool);
+        const double buildMs = msSince(start);
+        const NavGrid& grid = service.navGrid();
+        const HierarchicalPathfinder::Stats& hpa = service.hierarchy().getStats();
+
+        std::mt19937 rng(11);
+        glm::vec2 lo = terrain.minXZ(), hi = terrain.maxXZ();
+        std::uniform_real_distribution<float> x(lo.x, hi.x), z(lo.y, hi.y);
+        auto randomWalkable = [&]() {
+            for (;;) {
+                const NavGrid::Cell c = grid.cellAt(glm::vec3(x(rng), 0.0f, z(rng)));
+                if (grid.walkable(c)) return c;
+            }
+        };
+        auto lengthOf = [&](const std::vector<NavGrid::Cell>& path) {
+            float length = 0.0f;
+            for (size_t k = 1; k < path.size(); ++k) length += glm::distance(grid.position(path[k - 1]), grid.position(path[k]));
+            return length;
+        };
+        std::vector<std::pair<NavGrid::Cell, NavGrid::Cell>> pairs(queries);
+        for (auto& pair : pairs) pair = { randomWalkable(), randomWalkable() };
+
+        // Grid A* over the whole map, smoothed the same way
+        NavGrid::Scratch gridScratch;
+        std::vector<NavGrid::Cell> path;
+        std::vector<float> gridLengths(queries, -1.0f);
+        start = Clock::now();
+        for (size_t q = 0; q < queries; ++q) {
+            if (grid.findPath(pairs[q].first, pairs[q].second, grid.whole(), gridScratch, &path) < 0.0f) continue;
+            grid.smooth(path);
+            gridLengths[q] = lengthOf(path);
+        }
+        const double gridMs = msSince(start) / queries;
+
+        HierarchicalPathfinder::Scratch hpaScratch;
+        size_t agree = 0, found = 0;
+        double ratioSum = 0.0, worstRatio = 1.0;
+        start = Clock::now();
+        std::vector<float> hpaLengths(queries, -1.0f);
+        for (size_t q = 0; q < queries; ++q) {
+            if (service.hierarchy().findPath(grid.position(pairs[q].first), grid.position(pairs[q].second), hpaScratch, path)) hpaLengths[q] = lengthOf(path);
+        }
+        const double hpaMs = msSince(start) / queries;
+        for (size_t q = 0; q < queries; ++q) {
+            agree += (gridLengths[q] >= 0.0f) == (hpaLengths[q] >= 0.0f);
+            if (gridLengths[q] <= 0.0f || hpaLengths[q] < 0.0f) continue;
+            const double ratio = hpaLengths[q] / gridLengths[q];
+            ratioSum += ratio;
+            worstRatio = std::max(worstRatio, ratio);
+            ++found;
+        }
+
+        FlowField field;
+        start = Clock::now();
+        field.build(grid, randomWalkable());
+        const double fieldMs = msSince(start);
+
+        // Agents all asking on the same step: most head for a few rally points, the rest
+        // for goals of their own. Served under the per-step budget, then all at once.
+        std::vector<glm::vec3> rally;
+        for (int k = 0; k < 4; ++k) rally.push_back(grid.position(randomWalkable()));
+        std::vector<std::pair<glm::vec3, glm::vec3>> requests(agents);
+        for (size_t a = 0; a < agents; ++a) {
+            const glm::vec3 from = grid.position(randomWalkable());
+            requests[a] = { from, a % 5 == 4 ? grid.position(randomWalkable()) : rally[a % 4] };
+        }
+        auto serve = [&](size_t perStep, JobSystem* jobs, double& worstMs, double& meanMs, size_t& fields, size_t& failed, double& sum) {
+            service.settings.pathsPerStep = perStep;
+            service.build(terrain, jobs);
+            std::vector<PathTicket> tickets;
+            for (const auto& r : requests) tickets.push_back(service.request(r.first, r.second));
+            int steps = 0;
+            worstMs = 0.0;
+            fields = failed = 0;
+            for (;;) {
+                auto stepStart = Clock::now();
+                service.update(jobs);
+                worstMs = std::max(worstMs, msSince(stepStart));
+                meanMs += msSince(stepStart);
+                fields += service.getStats().flowFields;
+                ++steps;
+                if (service.getStats().pending == 0) break;
+            }
+            PathResult result;
+            sum = 0.0;
+            for (PathTicket t : tickets) {
+                if (!service.take(t, result)) continue;
+                failed += result.status == PathStatus::Failed;
+                for (const glm::vec3& w : result.waypoints) sum += w.x + w.z;
+                if (result.field) sum += result.field->goalCell();
+            }
+            meanMs /= steps;
+            return steps;
+        };
+        double budgetWorst, budgetMean = 0.0, budgetSum, singleWorst, singleMean = 0.0, singleSum, allWorst, allMean = 0.0, allSum;
+        size_t budgetFields, singleFields, allFields, budgetFailed, singleFailed, allFailed;
+        const size_t perStep = PathServiceSettings{}.pathsPerStep;
+        const int budgetSteps = serve(perStep, &pool, budgetWorst, budgetMean, budgetFields, budgetFailed, budgetSum);
+        serve(perStep, nullptr, singleWorst, singleMean, singleFields, singleFailed, singleSum);
+        const int allSteps = serve(agents, &pool, allWorst, allMean, allFields, allFailed, allSum);
+
+        std::cout << std::fixed << std::setprecision(3)
+            << "  build: " << buildMs << " ms, " << grid.width() << "x" << grid.height() << " cells, " << hpa.clusters << " clusters, "
+            << hpa.nodes << " portal nodes, " << hpa.edges << " edges\n"
+            << "  grid A*: " << gridMs << " ms/path\n"
+            << "  HPA*:    " << hpaMs << " ms/path (" << gridMs / hpaMs << "x), length " << (found ? ratioSum / found : 0.0)
+            << "x of grid A* on average (worst " << worstRatio << "x), reachability agrees on " << agree << " of " << queries << "\n"
+            << "  flow field: " << fieldMs << " ms for the whole grid\n"
+            << "  " << agents << " requests, " << perStep << " searches per step: " << budgetSteps << " steps, " << budgetMean << " ms mean, "
+            << budgetWorst << " ms worst step, " << budgetFields << " flow fields, " << budgetFailed << " unreachable\n"
+            << "  " << agents << " requests in one step: " << allSteps << " step, " << allWorst << " ms, "
+            << allFields << " flow field, " << allFailed << " unreachable\n"
+            << "  thread count " << (budgetSum == singleSum && budgetFailed == singleFailed ? "does not change the result" : "CHANGES THE RESULT") << "\n";
+    }
+
+    // Flock steering with grid neighbour queries vs. the all-pairs scan, per agent count
+    inline void flocking(const std::vector<size_t>& counts = { 1000, 10000, 50000 }, int steps = 60) {
+        std::cout << "== Flocking: " << steps << " steps\n";
+        const float dt = 1.0f / 60.0f;
+        const BehaviorSystems::FlockSettings settings;
+        JobSystem pool(4);
+
+        for (size_t count : counts) {
+            // About 10 agents within the neighbour radius of each other
+            const float side = std::sqrt(static_cast<float>(count) * glm::pi<float>() * settings.neighbourRadius * settings.neighbourRadius / 10.0f);
+            std::mt19937 rng(5);
+            std::uniform_real_distribution<float> xz(-0.5f * side, 0.5f * side), v(-1.0f, 1.0f);
+            EntityStore stores[2];
+            BehaviorSystems::Flock flocks[2];
+            for (size_t i = 0; i < count; ++i) {
+                const glm::vec3 p(xz(rng), 0.0f, xz(rng)), velocity(v(rng), 0.0f, v(rng));
+                for (int k = 0; k < 2; ++k) {
+                    EntityHandle h = stores[k].create(p);
+                    stores[k].velocities.back() = velocity;
+                    stores[k].bodies.back().movementSpeed = 5.0f;
+                    flocks[k].add(h, static_cast<uint32_t>(i % 2));
+                }
+            }
+
+            // All-pairs neighbour search, the pattern of the old collision loop
+            double naiveMs = -1.0;
+            size_t agree = 0, checked = 0;
+            if (count <= 10000) {
+                const std::vector<glm::vec3> positions = stores[0].positions;
+                const float radius2 = settings.neighbourRadius * settings.neighbourRadius;
+                std::vector<std::pair<float, uint32_t>> all;
+                std::vector<std::vector<uint32_t>> naive(count);
+                auto start = Clock::now();
+                for (uint32_t i = 0; i < count; ++i) {
+                    all.clear();
+                    for (uint32_t j = 0; j < count; ++j) {
+                        const glm::vec3 d = positions[j] - positions[i];
+                        const float d2 = glm::dot(d, d);
+                        if (j != i && d2 <= radius2) all.emplace_back(d2, j);
+                    }
+                    const size_t k = std::min(all.size(), settings.maxNeighbours);
+                    std::partial_sort(all.begin(), all.begin() + k, all.end());
+                    for (size_t n = 0; n < k; ++n) naive[i].push_back(all[n].second);
+                }
+                naiveMs = msSince(start);
+
+                NeighbourGrid grid;
+                NeighbourGrid::Scratch scratch;
+                NeighbourGrid::Neighbour nearest[NeighbourGrid::MAX_NEIGHBOURS];
+                grid.build(positions.data(), count, settings.neighbourRadius, settings.planar);
+                for (uint32_t i = 0; i < count; ++i) {
+                    const size_t found = grid.nearest(positions[i], i, settings.maxNeighbours, scratch, nearest);
+                    bool same = found == naive[i].size();
+                    for (size_t n = 0; same && n < found; ++n) same = nearest[n].point == naive[i][n];
+                    agree += same;
+                    ++checked;
+                }
+            }
+
+            auto run = [&](int k, JobSystem* jobs) {
+                EntityStore& store = stores[k];
+                auto start = Clock::now();
+                for (int step = 0; step < steps; ++step) {
+                    flocks[k].update(store, dt, jobs);
+                    for (size_t i = 0; i < store.size(); ++i) {
+                        store.velocities[i] = (store.velocities[i] + store.accelerations[i] * dt) * 0.98f;
+                        store.positions[i] += store.velocities[i] * dt;
+                        store.accelerations[i] = glm::vec3(0.0f);
+                    }
+                }
+                return msSince(start) / steps;
+            };
+            const double singleMs = run(0, nullptr);
+            const double parallelMs = run(1, &pool);
+
+            std::cout << "  " << std::setw(5) << count << " agents: " << std::fixed << std::setprecision(3)
+                << singleMs << " ms/step, " << parallelMs << " ms/step on 4 threads";
+            if (naiveMs >= 0.0) {
+                std::cout << ", all-pairs neighbour search alone " << naiveMs << " ms/step (" << std::setprecision(1) << naiveMs / singleMs
+                    << "x), neighbours agree for " << agree << " of " << checked;
+            }
+            std::cout << ", thread count " << (checksum(stores[0]) == checksum(stores[1]) ? "does not change the result" : "CHANGES THE RESULT") << "\n";
+        }
+    }
+
+    // A world much larger than the simulated area, crossed by the focus: everything
+    // resident vs. regions streamed in and frozen around the focus
+    inline void streaming(size_t perRegion = 50, int regionsPerSide = 64, int steps = 600) {
+        WorldPartitionSettings settings;
+        const float side = regionsPerSide * settings.regionSize;
+        const size_t total = perRegion * regionsPerSide * regionsPerSide;
+        std::cout << "== Streaming: " << total << " entities on " << side / 1000.0f << " km square, " << steps << " steps\n";
+        std::mt19937 rng(9);
+        std::uniform_real_distribution<float> xz(-0.5f * side, 0.5f * side);
+        std::vector<glm::vec3> points(total);
+        for (glm::vec3& p : points) p = glm::vec3(xz(rng), 0.0f, xz(rng));
+
+        // Diagonal across the world, about 100 m/s
+        auto focusAt = [&](int step) {
+            const float t = static_cast<float>(step) / steps;
+            return glm::vec3(-0.4f * side + 0.8f * side * t, 0.0f, -0.3f * side + 0.6f * side * t);
+        };
+        auto run = [&](World& world, double& worstMs, size_t& peakLive) {
+            worstMs = 0.0;
+            peakLive = 0;
+            auto begin = Clock::now();
+            for (int s = 0; s < steps; ++s) {
+                auto start = Clock::now();
+                world.entities.beginStep();
+                world.step(World::STEP, focusAt(s));
+                worstMs = std::max(worstMs, msSince(start));
+                peakLive = std::max(peakLive, world.entities.size());
+            }
+            return msSince(begin) / steps;
+        };
+
+        double residentWorst, residentMs;
+        size_t residentLive;
+        {
+            World world(4);
+            world.terrain = makeTestTerrain();
+            for (const glm::vec3& p : points) world.entities.create(p + glm::vec3(0.0f, world.terrain.getHeight(p) + 1.0f, 0.0f));
+            residentMs = run(world, residentWorst, residentLive);
+        }
+
+        const std::filesystem::path directory = std::filesystem::temp_directory_path() / "pg2_regions";
+        for (bool toDisk : { false, true }) {
+            World world(4);
+            world.terrain = makeTestTerrain();
+            world.partition.settings = settings;
+            if (toDisk) world.partition.settings.directory = directory;
+            auto start = Clock::now();
+            for (const glm::vec3& p : points) world.partition.place(p + glm::vec3(0.0f, world.terrain.getHeight(p) + 1.0f, 0.0f), nullptr, world.modelTable);
+            world.partition.commit();
+            const double placeMs = msSince(start);
+
+            double worstMs;
+            size_t peakLive;
+            const double ms = run(world, worstMs, peakLive);
+            const WorldPartitionStats& stats = world.partition.getStats();
+            std::cout << std::fixed << std::setprecision(3)
+                << "  streamed (" << (toDisk ? "frozen to disk" : "frozen in memory") << "): " << ms << " ms/step, worst " << worstMs << " ms, "
+                << peakLive << " live at most, " << stats.frozenEntities << " frozen, " << stats.frozenBytes / 1024 << " KiB frozen in memory at the end, "
+                << "placing and encoding took " << placeMs << " ms, "
+                << (world.entities.size() + stats.frozenEntities == total ? "no entity lost" : "ENTITIES LOST") << "\n";
+        }
+        std::filesystem::remove_all(directory);
+        std::cout << "  all resident: " << residentMs << " ms/step, worst " << residentWorst << " ms, " << residentLive << " live\n";
+    }
+
+    // Collision sparks: the old fixed pool of structs (scan for free slots, rand())
+    // vs. the SoA store, at the old capacity and with a million live particles
+    inline void particles(int frames = 120) {
+        std::cout << "== Particles: " << frames << " frames\n";
+        struct LegacyParticle {
+            glm::vec3 position;
+            glm::vec3 velocity;
+            float life = 1.0f;
+            bool active = false;
+        };
+        std::vector<LegacyParticle> legacy;
+        auto legacyUpdate = [&](float dt) {
+            for (auto& p : legacy) {
+                if (!p.active) continue;
+                p.position += p.velocity * dt;
+                p.life -= dt;
+                if (p.life <= 0.0f) p.active = false;
+            }
+        };
+        auto legacySpawn = [&](const glm::vec3& origin, int count) {
+            int spawned = 0;
+            for (auto& p : legacy) {
+                if (!p.active) {
+                    p.position = origin;
+                    p.velocity = glm::sphericalRand(5.0f);
+                    p.life = 0.5f + static_cast<float>(rand()) / RAND_MAX;
+                    p.active = true;
+                    if (++spawned >= count) break;
+                }
+            }
+        };
+
+        JobSystem pool(4);
+        const float dt = 1.0f / 60.0f;
+        // `pairs` colliding pairs per frame, 100 sparks each
+        auto run = [&](size_t legacyCapacity, int pairs) {
+            legacy.assign(legacyCapacity, LegacyParticle{});
+            auto start = Clock::now();
+            size_t legacyLive = 0;
+            for (int f = 0; f < frames; ++f) {
+                for (int p = 0; p < pairs; ++p) legacySpawn(glm::vec3(static_cast<float>(p), 0.0f, 0.0f), 100);
+                legacyUpdate(dt);
+            }
+            const double legacyMs = msSince(start) / frames;
+            for (const auto& p : legacy) legacyLive += p.active;
+
+            double soaMs[2];
+            size_t soaLive = 0;
+            for (int threaded = 0; threaded < 2; ++threaded) {
+                Particles::pool.clear();
+                Particles::threadRandom = Particles::Random{};
+                start = Clock::now();
+                for (int f = 0; f < frames; ++f) {
+                    for (int p = 0; p < pairs; ++p) Particles::spawn(glm::vec3(static_cast<float>(p), 0.0f, 0.0f), 100);
+                    Particles::update(dt, threaded ? &pool : nullptr);
+                }
+                soaMs[threaded] = msSince(start) / frames;
+                soaLive = Particles::activeCount();
+            }
+            std::cout << std::fixed << std::setprecision(3)
+                << "  " << pairs << " pairs/frame, old pool of " << legacyCapacity << ": " << legacyMs << " ms/frame (" << legacyLive << " live)\n"
+                << "  " << pairs << " pairs/frame, SoA: " << soaMs[0] << " ms/frame, " << soaMs[1] << " ms/frame on 4 threads (" << soaLive << " live, "
+                << std::setprecision(1) << legacyMs / soaMs[0] << "x)\n";
+        };
+        run(10000, 1);
+        run(1000000, 100);
+        Particles::pool.clear();
+    }
+
+    inline int run(const std::string& name) {
+        bool all = name.empty() || name == "all";
+        bool any = false;
+        if (all || name == "update") { entityUpdateScaling(); any = true; }
+        if (all || name == "behaviors") { behaviorPools(); any = true; }
+        if (all || name == "schedule") { updateScheduling(); any = true; }
+        if (all || name == "scripts") { scriptedBehaviors(); any = true; }
+        if (all || name == "handles") { handleChurn(); any = true; }
+        if (all || name == "snapshot") { snapshots(); any = true; }
+        if (all || name == "collisions") { collisionBroadphase(); any = true; }
+        if (all || name == "scene") { sceneQueries(); any = true; }
+        if (all || name == "narrowphase") { narrowphase(); any = true; }
+        if (all || name == "pairs") { narrowphaseThreads(); any = true; }
+        if (all || name == "bvh") { triangleBVH(); any = true; }
+        if (all || name == "solver") { contactSolver(); any = true; }
+        if (all || name == "transforms") { transformCache(); any = true; }
+        if (all || name == "paths") { pathfinding(); any = true; }
+        if (all || name == "flocking") { flocking(); any = true; }
+        if (all || name == "streaming") { streaming(); any = true; }
+        if (all || name == "particles") { particles(); any = true; }
+
+        if (!any) {
+            std::cerr << "Unknown benchmark: " << name << std::endl;
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+}
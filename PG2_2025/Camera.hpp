@@ -1,7 +1,12 @@
 #pragma once
-#include "Entity.hpp"
-
-class Camera : public Entity {
+#include <unordered_set>
+#include <algorithm>
+#include <GLFW/glfw3.h>
+#include "EntityStore.hpp"
+
+// Player camera. The player body is a regular entity in the EntityStore;
+// the camera only keeps its handle plus the look/view state.
+class Camera {
 public:
     float sensitivity;
     bool firstMouse;
@@ -14,38 +19,52 @@ public:
     float camPitch = 0.0f;   // Vertical look angle
     glm::vec3 cameraFront = glm::vec3(0.0f, 0.0f, -1.0f);  // Initial look direction
 
-    Camera(glm::vec3 startPosition, Model* entityModel = nullptr)
-        : Entity(startPosition, entityModel), sensitivity(0.1f), firstMouse(true),
+    glm::vec3 startPosition;
+    EntityHandle body;
+
+    Camera(glm::vec3 startPosition)
+        : sensitivity(0.1f), firstMouse(true),
         lastX(400), lastY(300),
         viewpointOffset(glm::vec3(0.0f, 3.0f, 0.0f)), // First-person offset (head position)
         thirdPersonOffset(glm::vec3(0.0f, 5.0f, 15.0f)), // Third-person offset (behind player)
-        thirdPerson(true) // Start in first-person mode
+        thirdPerson(true), // Start in first-person mode
+        startPosition(startPosition)
     {
     }
 
-    void addModel(Model* entityModel = nullptr) {
-        model = entityModel;
+    // Spawns the player body into the store
+    EntityHandle attach(EntityStore& store, Model* entityModel = nullptr) {
+        entities = &store;
+        body = store.create(startPosition, entityModel);
+        return body;
     }
 
-    void processKeyboard(std::unordered_set<int> pressedKeys, float deltaTime) {
+    Entity player() { return entities->get(body); }
+    glm::vec3 position() const { return entities->positions[entities->indexOf(body)]; }
+
+    // Player position between the last two simulation steps
+    glm::vec3 renderPosition(float alpha) const { return entities->renderPosition(entities->indexOf(body), alpha); }
+
+    void processKeyboard(const std::unordered_set<int>& pressedKeys, float deltaTime) {
+        Entity self = player();
         glm::vec3 force = glm::vec3(0.0f);
-        glm::vec3 flatFront = glm::normalize(glm::vec3(front.x, 0.0f, front.z));
+        glm::vec3 flatFront = glm::normalize(glm::vec3(self.front.x, 0.0f, self.front.z));
         // Process continuous movement
-        if (pressedKeys.count(GLFW_KEY_W)) force += flatFront * movementSpeed;
-        if (pressedKeys.count(GLFW_KEY_S)) force -= flatFront * movementSpeed;
-        if (pressedKeys.count(GLFW_KEY_A)) force -= right * movementSpeed;
-        if (pressedKeys.count(GLFW_KEY_D)) force += right * movementSpeed;
-        if (pressedKeys.count(GLFW_KEY_SPACE)) jump(10.0f);
+        if (pressedKeys.count(GLFW_KEY_W)) force += flatFront * self.movementSpeed;
+        if (pressedKeys.count(GLFW_KEY_S)) force -= flatFront * self.movementSpeed;
+        if (pressedKeys.count(GLFW_KEY_A)) force -= self.right * self.movementSpeed;
+        if (pressedKeys.count(GLFW_KEY_D)) force += self.right * self.movementSpeed;
+        if (pressedKeys.count(GLFW_KEY_SPACE)) self.jump(10.0f);
 
-        applyForce(force);
+        self.applyForce(force);
         if (glm::length(force) > 0.001f) {
-            float yawOffset = camYaw - yaw;
+            float yawOffset = camYaw - self.yaw;
 
             // Normalize to [-180, 180] range for smooth rotation
             if (yawOffset > 180.0f) yawOffset -= 360.0f;
             if (yawOffset < -180.0f) yawOffset += 360.0f;
 
-            rotate(yawOffset, 0.0f);
+            self.rotate(yawOffset, 0.0f);
         }
 
     }
@@ -79,30 +98,79 @@ public:
 
     void swapViewMode() {
         thirdPerson = !thirdPerson;
+        Model* model = player().model;
         if (model) {
             if (thirdPerson) { model->alpha = 1; }
             else { model->alpha = 0; }
         }
     }
 
-    // Compute the View Matrix for rendering
-    glm::mat4 getViewMatrix() {
+    // Compute the View Matrix for rendering (alpha interpolates between simulation steps)
+    glm::mat4 getViewMatrix(float alpha = 1.0f) {
+        Entity self = player();
+        glm::vec3 pos = renderPosition(alpha);
         if (thirdPerson) {
-            glm::vec3 camPos = position - cameraFront * thirdPersonOffset.z + glm::vec3(0.0f, thirdPersonOffset.y, 0.0f);
-            return glm::lookAt(camPos, position + cameraFront, up);
+            glm::vec3 camPos = pos - cameraFront * thirdPersonOffset.z + glm::vec3(0.0f, thirdPersonOffset.y, 0.0f);
+            return glm::lookAt(camPos, pos + cameraFront, self.up);
         }
         else {
-            return glm::lookAt(position + viewpointOffset, position + viewpointOffset + cameraFront, up);
+            return glm::lookAt(pos + viewpointOffset, pos + viewpointOffset + cameraFront, self.up);
         }
     }
 
 
-    glm::vec3 getEfPos() {
+    glm::vec3 getEfPos(float alpha = 1.0f) {
+        Entity self = player();
+        glm::vec3 pos = renderPosition(alpha);
         if (thirdPerson) {
-            return position - front * thirdPersonOffset.z + glm::vec3(0.0f, thirdPersonOffset.y, 0.0f);
+            return pos - self.front * thirdPersonOffset.z + glm::vec3(0.0f, thirdPersonOffset.y, 0.0f);
         }
         else {
-            return position + viewpointOffset;
+            return pos + viewpointOffset;
         }
     }
+
+    // Look and view state; the player body itself is saved with the EntityStore
+    void save(SnapshotWriter& w) const {
+        w.beginSection(Snapshot::fourcc("CAMR"));
+        w.write(camYaw);
+        w.write(camPitch);
+        w.write(cameraFront);
+        w.write(thirdPerson);
+        w.write(body);
+        w.endSection();
+    }
+
+    // A decoded CAMR section, not yet applied
+    struct Loaded {
+        float yaw = 0.0f, pitch = 0.0f;
+        glm::vec3 front = glm::vec3(0.0f);
+        bool thirdPerson = false;
+        EntityHandle body;
+    };
+
+    // False if the snapshot has no camera; throws on a truncated section. The body is
+    // checked by the caller against the entities it is loaded with.
+    static bool decode(SnapshotReader& r, Loaded& out) {
+        if (!r.openSection(Snapshot::fourcc("CAMR"))) return false;
+        out.yaw = r.read<float>();
+        out.pitch = r.read<float>();
+        out.front = r.read<glm::vec3>();
+        out.thirdPerson = r.read<bool>();
+        out.body = r.read<EntityHandle>();
+        return true;
+    }
+
+    // After the world it was saved with is loaded; the body must be alive in it
+    void apply(const Loaded& l) {
+        camYaw = l.yaw;
+        camPitch = l.pitch;
+        cameraFront = l.front;
+        thirdPerson = l.thirdPerson;
+        body = l.body;
+        if (player().model) player().model->alpha = thirdPerson ? 1.0f : 0.0f;
+    }
+
+private:
+    EntityStore* entities = nullptr;
 };
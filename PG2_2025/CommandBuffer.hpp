@@ -0,0 +1,77 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "Entity.hpp"
+
+class EntityStore;
+
+// Structural changes and writes to other entities requested while entities update in
+// parallel. Each update chunk records into its own buffer; the buffers are applied
+// in chunk order once the parallel phase has finished, so the result does not depend
+// on which thread ran which chunk.
+class CommandBuffer {
+public:
+    using Behavior = Entity::Behavior;
+
+    void spawn(glm::vec3 position, Model* model = nullptr, std::vector<Behavior> behaviors = {}) {
+        Command c;
+        c.type = Type::Spawn;
+        c.vec = position;
+        c.model = model;
+        c.behaviors = std::move(behaviors);
+        commands.push_back(std::move(c));
+    }
+
+    void destroy(EntityHandle target) {
+        Command c;
+        c.type = Type::Destroy;
+        c.target = target;
+        commands.push_back(std::move(c));
+    }
+
+    void applyForce(EntityHandle target, glm::vec3 force) {
+        Command c;
+        c.type = Type::ApplyForce;
+        c.target = target;
+        c.vec = force;
+        commands.push_back(std::move(c));
+    }
+
+    void addVelocity(EntityHandle target, glm::vec3 deltaVelocity) {
+        Command c;
+        c.type = Type::AddVelocity;
+        c.target = target;
+        c.vec = deltaVelocity;
+        commands.push_back(std::move(c));
+    }
+
+    void addBehavior(EntityHandle target, Behavior behavior) {
+        Command c;
+        c.type = Type::AddBehavior;
+        c.target = target;
+        c.behaviors.push_back(std::move(behavior));
+        commands.push_back(std::move(c));
+    }
+
+    bool empty() const { return commands.empty(); }
+    size_t size() const { return commands.size(); }
+    void clear() { commands.clear(); }
+
+    // Defined in EntityStore.hpp
+    inline void apply(EntityStore& store);
+
+private:
+    enum class Type { Spawn, Destroy, ApplyForce, AddVelocity, AddBehavior };
+
+    struct Command {
+        Type type = Type::ApplyForce;
+        EntityHandle target;
+        glm::vec3 vec{ 0.0f };
+        Model* model = nullptr;
+        std::vector<Behavior> behaviors;
+    };
+
+    std::vector<Command> commands;
+};
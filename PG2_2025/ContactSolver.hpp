@@ -0,0 +1,270 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+#include "EntityStore.hpp"
+#include "JobSystem.hpp"
+#include "UpdateScheduler.hpp"
+
+// One touching pair from the narrowphase, plus the impulses the solver applied to it.
+// The impulses are kept per pair between steps (World's contact cache) to warm start
+// the next solve.
+struct Contact {
+    uint32_t a;
+    uint32_t b;
+    glm::vec3 normal{ 0.0f };   // from a into b
+    float depth = 0.0f;         // negative: still apart by that much (speculative contact)
+    glm::vec3 point{ 0.0f };
+
+    float normalImpulse = 0.0f;
+    glm::vec3 tangentImpulse{ 0.0f };
+    float bounce = 0.0f;        // separation speed the solver aims for
+    bool fresh = true;          // not touching in the previous step
+};
+
+struct ContactSolverSettings {
+    int iterations = 10;
+    int positionIterations = 3;
+    float friction = 0.4f;
+    float restitution = 0.2f;
+    float restitutionSpeed = 1.0f;     // slower impacts do not bounce, so stacks can settle
+    float slop = 0.01f;                // penetration left alone, keeps resting contacts touching
+    float correction = 0.6f;           // share of the remaining penetration removed per pass
+};
+
+struct ContactSolverStats {
+    size_t islands = 0;
+    size_t sleepingIslands = 0;
+    size_t solvedContacts = 0;
+};
+
+// Sequential impulse solver for entity contacts. Entities have unit mass and no angular
+// response (yaw is driven by behaviors), so each contact is one point along its normal
+// with a friction cone around it.
+//
+// Contacts are grouped into islands (connected components of the contact graph). An
+// island whose bodies have all come to rest is put to sleep as a whole and skipped; one
+// touched by a moving body is woken as a whole. Awake islands share no bodies and are
+// solved in parallel.
+class ContactSolver {
+public:
+    // Contact normals steeper than ~45 degrees hold the upper body up
+    static constexpr float SUPPORT_SLOPE = 0.7f;
+
+    ContactSolverSettings settings;
+
+    void solve(EntityStore& store, std::vector<Contact>& contacts, float dt,
+        const UpdateSchedulerSettings& sleep, JobSystem* jobs = nullptr) {
+        stats = ContactSolverStats{};
+        for (Activity& a : store.activity) {
+            if (!a.sleeping) a.supported = false;   // set again below for bodies still resting on another
+        }
+        buildIslands(store, contacts);
+        stats.islands = islands.size();
+        startPositions.resize(store.size());
+
+        // Islands sleep as a whole once every body in them has rested long enough (the
+        // scheduler keeps the per-body rest time); until then all of them stay awake
+        awake.clear();
+        for (uint32_t k = 0; k < islands.size(); ++k) {
+            const Island& island = islands[k];
+            bool resting = true;
+            for (uint32_t m = island.firstBody; m < island.firstBody + island.bodyCount; ++m) {
+                const Activity& a = store.activity[bodies[m]];
+                if (!a.sleeping && a.restTime < sleep.sleepDelay) { resting = false; break; }
+            }
+            for (uint32_t m = island.firstBody; m < island.firstBody + island.bodyCount; ++m) {
+                Activity& a = store.activity[bodies[m]];
+                if (!resting) {
+                    a.sleeping = false;
+                    a.supported = false;
+                }
+                else if (!a.sleeping) {
+                    a.sleeping = true;
+                    a.pendingTime = 0.0f;
+                    store.velocities[bodies[m]] = glm::vec3(0.0f);
+                }
+            }
+            if (resting) ++stats.sleepingIslands;
+            else awake.push_back(k);
+        }
+
+        auto solveRange = [&](size_t begin, size_t end, size_t) {
+            for (size_t k = begin; k < end; ++k) solveIsland(store, contacts, islands[awake[k]], dt);
+        };
+        if (jobs) jobs->parallelFor(awake.size(), ISLAND_CHUNK, solveRange);
+        else solveRange(0, awake.size(), 0);
+
+        for (uint32_t k : awake) stats.solvedContacts += islands[k].contactCount;
+    }
+
+    const ContactSolverStats& getStats() const { return stats; }
+
+private:
+    static constexpr size_t ISLAND_CHUNK = 8;
+
+    struct Island {
+        uint32_t firstContact = 0, contactCount = 0;   // into `order`
+        uint32_t firstBody = 0, bodyCount = 0;         // into `bodies`
+    };
+
+    uint32_t find(uint32_t i) {
+        while (parent[i] != i) {
+            parent[i] = parent[parent[i]];
+            i = parent[i];
+        }
+        return i;
+    }
+
+    // Union-find over the contact graph, then contacts and bodies sorted by island
+    // (counting sort; within an island both keep their original order)
+    void buildIslands(const EntityStore& store, const std::vector<Contact>& contacts) {
+        islands.clear();
+        order.clear();
+        bodies.clear();
+        if (contacts.empty()) return;
+
+        parent.resize(store.size());
+        std::iota(parent.begin(), parent.end(), 0u);
+        for (const Contact& c : contacts) {
+            uint32_t ra = find(c.a), rb = find(c.b);
+            if (ra != rb) parent[std::max(ra, rb)] = std::min(ra, rb);
+        }
+
+        islandOf.assign(store.size(), UINT32_MAX);
+        for (const Contact& c : contacts) {
+            for (uint32_t i : { c.a, c.b }) {
+                const uint32_t root = find(i);
+                if (islandOf[root] == UINT32_MAX) {
+                    islandOf[root] = static_cast<uint32_t>(islands.size());
+                    islands.emplace_back();
+                }
+            }
+            ++islands[islandOf[find(c.a)]].contactCount;
+        }
+
+        uint32_t offset = 0;
+        for (Island& island : islands) { island.firstContact = offset; offset += island.contactCount; island.contactCount = 0; }
+        order.resize(contacts.size());
+        for (uint32_t k = 0; k < contacts.size(); ++k) {
+            Island& island = islands[islandOf[find(contacts[k].a)]];
+            order[island.firstContact + island.contactCount++] = k;
+        }
+
+        // Bodies in any contact, each once, in index order
+        for (uint32_t i = 0; i < store.size(); ++i) {
+            const uint32_t island = islandOf[find(i)];
+            if (island != UINT32_MAX) ++islands[island].bodyCount;
+        }
+        offset = 0;
+        for (Island& island : islands) { island.firstBody = offset; offset += island.bodyCount; island.bodyCount = 0; }
+        bodies.resize(offset);
+        for (uint32_t i = 0; i < store.size(); ++i) {
+            const uint32_t k = islandOf[find(i)];
+            if (k == UINT32_MAX) continue;
+            Island& island = islands[k];
+            bodies[island.firstBody + island.bodyCount++] = i;
+        }
+    }
+
+    static void applyImpulse(EntityStore& store, const Contact& c, const glm::vec3& impulse) {
+        store.velocities[c.a] -= impulse;
+        store.velocities[c.b] += impulse;
+    }
+
+    void solveIsland(EntityStore& store, std::vector<Contact>& contacts, const Island& island, float dt) {
+        const uint32_t* first = order.data() + island.firstContact;
+        const uint32_t* last = first + island.contactCount;
+        constexpr float effectiveMass = 0.5f;   // 1 / (1/ma + 1/mb), unit masses
+
+        // Target speeds along the normals: a bounce for hard impacts, and pairs still apart
+        // may close their gap within the step. Then warm start with last step's impulses.
+        for (const uint32_t* k = first; k != last; ++k) {
+            Contact& c = contacts[*k];
+            const float approach = glm::dot(store.velocities[c.b] - store.velocities[c.a], c.normal);
+            if (c.depth < 0.0f) c.bounce = c.depth / dt;
+            else c.bounce = approach < -settings.restitutionSpeed ? -settings.restitution * approach : 0.0f;
+        }
+        for (const uint32_t* k = first; k != last; ++k) {
+            const Contact& c = contacts[*k];
+            applyImpulse(store, c, c.normal * c.normalImpulse + c.tangentImpulse);
+        }
+
+        for (int it = 0; it < settings.iterations; ++it) {
+            for (const uint32_t* k = first; k != last; ++k) {
+                Contact& c = contacts[*k];
+
+                // Normal: no approach along n, impulses only push
+                glm::vec3 relative = store.velocities[c.b] - store.velocities[c.a];
+                const float lambda = (c.bounce - glm::dot(relative, c.normal)) * effectiveMass;
+                const float total = std::max(c.normalImpulse + lambda, 0.0f);
+                applyImpulse(store, c, c.normal * (total - c.normalImpulse));
+                c.normalImpulse = total;
+
+                // Friction: stop sliding, within the cone of the normal impulse
+                relative = store.velocities[c.b] - store.velocities[c.a];
+                const glm::vec3 sliding = relative - c.normal * glm::dot(relative, c.normal);
+                glm::vec3 tangent = c.tangentImpulse - sliding * effectiveMass;
+                const float limit = settings.friction * c.normalImpulse;
+                const float length = glm::length(tangent);
+                if (length > limit) tangent *= limit / length;
+                applyImpulse(store, c, tangent - c.tangentImpulse);
+                c.tangentImpulse = tangent;
+            }
+
+            // The terrain takes part as an immovable contact under grounded bodies, otherwise
+            // the weight of a stack would push its bottom body into the ground
+            for (uint32_t m = island.firstBody; m < island.firstBody + island.bodyCount; ++m) {
+                const uint32_t i = bodies[m];
+                if (store.bodies[i].isGrounded && store.velocities[i].y < 0.0f) store.velocities[i].y = 0.0f;
+            }
+        }
+
+        // Positional correction: push overlapping bodies apart directly, so no velocity
+        // (and no energy) is added to resolve penetration. Each pass measures what is left of
+        // the overlap from how far both bodies already moved, so a body held by several
+        // contacts is not pushed several times over. A grounded body is not pushed into the
+        // terrain (the one on top moves instead) nor lifted off it by a sideways push.
+        for (uint32_t m = island.firstBody; m < island.firstBody + island.bodyCount; ++m)
+            startPositions[bodies[m]] = store.positions[bodies[m]];
+        for (int it = 0; it < settings.positionIterations; ++it) {
+            for (const uint32_t* k = first; k != last; ++k) {
+                const Contact& c = contacts[*k];
+                const glm::vec3 moved = (store.positions[c.b] - startPositions[c.b]) - (store.positions[c.a] - startPositions[c.a]);
+                const float depth = c.depth - glm::dot(moved, c.normal);
+                const float push = std::max(depth - settings.slop, 0.0f) * settings.correction;
+                if (push <= 0.0f) continue;
+                float shareA = 0.5f, shareB = 0.5f;
+                if (c.normal.y > SUPPORT_SLOPE && store.bodies[c.a].isGrounded) { shareA = 0.0f; shareB = 1.0f; }
+                else if (c.normal.y < -SUPPORT_SLOPE && store.bodies[c.b].isGrounded) { shareA = 1.0f; shareB = 0.0f; }
+                glm::vec3 moveA = c.normal * (-push * shareA), moveB = c.normal * (push * shareB);
+                if (store.bodies[c.a].isGrounded) moveA.y = 0.0f;
+                if (store.bodies[c.b].isGrounded) moveB.y = 0.0f;
+                store.positions[c.a] += moveA;
+                store.positions[c.b] += moveB;
+            }
+        }
+
+        // A body resting on another is marked supported, so the scheduler lets it fall
+        // asleep like one on the terrain
+        for (const uint32_t* k = first; k != last; ++k) {
+            const Contact& c = contacts[*k];
+            if (c.normal.y < -SUPPORT_SLOPE) store.activity[c.a].supported = true;
+            if (c.normal.y > SUPPORT_SLOPE) store.activity[c.b].supported = true;
+        }
+    }
+
+    std::vector<uint32_t> parent;
+    std::vector<uint32_t> islandOf;     // by root body
+    std::vector<Island> islands;
+    std::vector<uint32_t> order;        // contact indices grouped by island
+    std::vector<uint32_t> bodies;       // body indices grouped by island
+    std::vector<uint32_t> awake;        // islands to solve this step
+    std::vector<glm::vec3> startPositions;  // by body, before positional correction
+    ContactSolverStats stats;
+};
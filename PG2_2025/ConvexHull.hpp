@@ -0,0 +1,244 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cfloat>
+#include <glm/glm.hpp>
+
+// Convex hull of a point cloud, kept as its vertices only (all GJK needs).
+// Built with quickhull; the hull grows by the farthest remaining point until it is
+// exact or reaches the vertex budget, so a capped hull is the best-fitting one of
+// that size and always lies inside the true hull.
+class ConvexHull {
+public:
+    std::vector<glm::vec3> points;
+
+    // Bounds that hold under any rotation about the vertical axis
+    float radiusXZ = 0.0f;
+    float minY = 0.0f;
+    float maxY = 0.0f;
+
+    bool empty() const { return points.empty(); }
+
+    // Index of the point furthest along `direction`
+    size_t support(const glm::vec3& direction) const {
+        size_t best = 0;
+        float bestDot = -FLT_MAX;
+        for (size_t i = 0; i < points.size(); ++i) {
+            float d = glm::dot(points[i], direction);
+            if (d > bestDot) { bestDot = d; best = i; }
+        }
+        return best;
+    }
+
+    static ConvexHull build(const std::vector<glm::vec3>& cloud, size_t maxVertices = 32) {
+        ConvexHull hull;
+        if (cloud.empty()) return hull;
+
+        glm::vec3 boxMin(FLT_MAX), boxMax(-FLT_MAX);
+        for (const glm::vec3& p : cloud) { boxMin = glm::min(boxMin, p); boxMax = glm::max(boxMax, p); }
+        const glm::vec3 extent = boxMax - boxMin;
+        const float epsilon = 1e-5f * std::max(std::max(extent.x, extent.y), std::max(extent.z, 1e-3f));
+
+        Quickhull qh(cloud, epsilon);
+        if (!qh.initialSimplex()) {
+            // Flat or degenerate cloud: its bounding box is a safe stand-in
+            return box(boxMin, boxMax);
+        }
+        qh.expand(std::max<size_t>(maxVertices, 4));
+        hull.points = qh.vertices();
+        hull.computeBounds();
+        return hull;
+    }
+
+    static ConvexHull box(const glm::vec3& min, const glm::vec3& max) {
+        ConvexHull hull;
+        for (int corner = 0; corner < 8; ++corner)
+            hull.points.emplace_back(corner & 1 ? max.x : min.x, corner & 2 ? max.y : min.y, corner & 4 ? max.z : min.z);
+        hull.computeBounds();
+        return hull;
+    }
+
+private:
+    void computeBounds() {
+        radiusXZ = 0.0f;
+        minY = FLT_MAX;
+        maxY = -FLT_MAX;
+        for (const glm::vec3& p : points) {
+            radiusXZ = std::max(radiusXZ, std::sqrt(p.x * p.x + p.z * p.z));
+            minY = std::min(minY, p.y);
+            maxY = std::max(maxY, p.y);
+        }
+    }
+
+    class Quickhull {
+    public:
+        Quickhull(const std::vector<glm::vec3>& cloud, float epsilon) : cloud(cloud), epsilon(epsilon) {}
+
+        // Largest tetrahedron from the extreme points; false if the cloud is flat
+        bool initialSimplex() {
+            uint32_t extremes[6] = {};
+            for (uint32_t i = 0; i < cloud.size(); ++i) {
+                for (int axis = 0; axis < 3; ++axis) {
+                    if (cloud[i][axis] < cloud[extremes[axis * 2]][axis]) extremes[axis * 2] = i;
+                    if (cloud[i][axis] > cloud[extremes[axis * 2 + 1]][axis]) extremes[axis * 2 + 1] = i;
+                }
+            }
+            uint32_t i0 = 0, i1 = 0;
+            float best = -1.0f;
+            for (int a = 0; a < 6; ++a) {
+                for (int b = a + 1; b < 6; ++b) {
+                    glm::vec3 d = cloud[extremes[a]] - cloud[extremes[b]];
+                    if (glm::dot(d, d) > best) { best = glm::dot(d, d); i0 = extremes[a]; i1 = extremes[b]; }
+                }
+            }
+            if (best <= epsilon * epsilon) return false;
+
+            const glm::vec3 p0 = cloud[i0];
+            const glm::vec3 axis = glm::normalize(cloud[i1] - p0);
+            uint32_t i2 = 0;
+            best = -1.0f;
+            for (uint32_t i = 0; i < cloud.size(); ++i) {
+                glm::vec3 d = cloud[i] - p0;
+                d -= axis * glm::dot(d, axis);
+                if (glm::dot(d, d) > best) { best = glm::dot(d, d); i2 = i; }
+            }
+            if (best <= epsilon * epsilon) return false;
+
+            const glm::vec3 normal = glm::normalize(glm::cross(cloud[i1] - p0, cloud[i2] - p0));
+            uint32_t i3 = 0;
+            best = -1.0f;
+            for (uint32_t i = 0; i < cloud.size(); ++i) {
+                float d = std::abs(glm::dot(cloud[i] - p0, normal));
+                if (d > best) { best = d; i3 = i; }
+            }
+            if (best <= epsilon) return false;
+
+            addFace(i0, i1, i2, i3);
+            addFace(i0, i1, i3, i2);
+            addFace(i0, i2, i3, i1);
+            addFace(i1, i2, i3, i0);
+            vertexCount = 4;
+
+            for (uint32_t i = 0; i < cloud.size(); ++i) {
+                if (i == i0 || i == i1 || i == i2 || i == i3) continue;
+                assign(i, 0, faces.size());
+            }
+            return true;
+        }
+
+        void expand(size_t maxVertices) {
+            std::vector<uint32_t> visible, orphans;
+            std::vector<std::pair<uint32_t, uint32_t>> edges, horizon;
+
+            while (vertexCount < maxVertices) {
+                // Farthest outside point over all faces
+                int32_t from = -1;
+                float bestDistance = epsilon;
+                for (uint32_t f = 0; f < faces.size(); ++f) {
+                    const Face& face = faces[f];
+                    if (!face.alive || face.outside.empty()) continue;
+                    if (face.farthestDistance > bestDistance) { bestDistance = face.farthestDistance; from = static_cast<int32_t>(f); }
+                }
+                if (from < 0) break;
+                const uint32_t eye = faces[from].farthest;
+                const glm::vec3 eyePoint = cloud[eye];
+
+                visible.clear();
+                edges.clear();
+                for (uint32_t f = 0; f < faces.size(); ++f) {
+                    const Face& face = faces[f];
+                    if (!face.alive || distance(face, eyePoint) <= epsilon) continue;
+                    visible.push_back(f);
+                    for (int e = 0; e < 3; ++e) edges.emplace_back(face.v[e], face.v[(e + 1) % 3]);
+                }
+
+                // Horizon: edges of visible faces whose neighbour across the edge is not visible
+                horizon.clear();
+                for (const auto& edge : edges) {
+                    if (std::find(edges.begin(), edges.end(), std::make_pair(edge.second, edge.first)) == edges.end())
+                        horizon.push_back(edge);
+                }
+
+                orphans.clear();
+                for (uint32_t f : visible) {
+                    Face& face = faces[f];
+                    face.alive = false;
+                    for (uint32_t p : face.outside) if (p != eye) orphans.push_back(p);
+                    face.outside.clear();
+                    face.outside.shrink_to_fit();
+                }
+
+                // Same winding as the visible faces they replace, so still facing out
+                const size_t firstNew = faces.size();
+                for (const auto& edge : horizon) addFace(edge.first, edge.second, eye);
+                ++vertexCount;
+
+                for (uint32_t p : orphans) assign(p, firstNew, faces.size());
+            }
+        }
+
+        std::vector<glm::vec3> vertices() const {
+            std::vector<uint32_t> ids;
+            for (const Face& face : faces) {
+                if (!face.alive) continue;
+                ids.insert(ids.end(), face.v, face.v + 3);
+            }
+            std::sort(ids.begin(), ids.end());
+            ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+            std::vector<glm::vec3> out;
+            out.reserve(ids.size());
+            for (uint32_t id : ids) out.push_back(cloud[id]);
+            return out;
+        }
+
+    private:
+        struct Face {
+            uint32_t v[3];
+            glm::vec3 normal;
+            float offset;
+            std::vector<uint32_t> outside;
+            uint32_t farthest = 0;
+            float farthestDistance = 0.0f;
+            bool alive = true;
+        };
+
+        static float distance(const Face& face, const glm::vec3& p) { return glm::dot(face.normal, p) - face.offset; }
+
+        // Face a-b-c, wound so that `inside` is behind it
+        void addFace(uint32_t a, uint32_t b, uint32_t c, uint32_t inside) {
+            glm::vec3 n = glm::cross(cloud[b] - cloud[a], cloud[c] - cloud[a]);
+            if (glm::dot(n, cloud[inside] - cloud[a]) > 0.0f) std::swap(b, c);
+            addFace(a, b, c);
+        }
+
+        void addFace(uint32_t a, uint32_t b, uint32_t c) {
+            Face face;
+            face.v[0] = a; face.v[1] = b; face.v[2] = c;
+            glm::vec3 n = glm::cross(cloud[b] - cloud[a], cloud[c] - cloud[a]);
+            float length = glm::length(n);
+            face.normal = length > 0.0f ? n / length : glm::vec3(0.0f);
+            face.offset = glm::dot(face.normal, cloud[a]);
+            faces.push_back(std::move(face));
+        }
+
+        // Gives point i to the first face in [begin, end) it lies outside of; inside points are dropped
+        void assign(uint32_t i, size_t begin, size_t end) {
+            for (size_t f = begin; f < end; ++f) {
+                Face& face = faces[f];
+                float d = distance(face, cloud[i]);
+                if (d <= epsilon) continue;
+                face.outside.push_back(i);
+                if (d > face.farthestDistance) { face.farthestDistance = d; face.farthest = i; }
+                return;
+            }
+        }
+
+        const std::vector<glm::vec3>& cloud;
+        float epsilon;
+        std::vector<Face> faces;
+        size_t vertexCount = 0;
+    };
+};
@@ -0,0 +1,456 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cfloat>
+#include <glm/glm.hpp>
+
+#include "Frustum.hpp"
+
+// Dynamic bounding volume tree (after Box2D's b2DynamicTree, in 3D).
+// Every proxy is a leaf holding its tight box and a "fat" box enlarged by a margin and
+// by its recent motion. Moving a proxy only touches the tree when the tight box leaves
+// the fat one; then the leaf is reinserted (surface area heuristic) and its ancestors
+// are refitted and rebalanced with AVL-style rotations on the way up.
+//
+// Queries are const and keep their traversal stack on the caller's stack, so any number
+// of threads may query at once. Create/move/destroy need exclusive access.
+class DynamicAABBTree {
+public:
+    static constexpr int32_t NULL_NODE = -1;
+
+    struct RayHit {
+        uint32_t userData = 0;
+        int32_t proxy = NULL_NODE;
+        float distance = FLT_MAX;
+    };
+
+    // Margin added around every tight box, and how far ahead of its motion a fat box reaches
+    explicit DynamicAABBTree(float margin = 0.25f, float motionMultiplier = 4.0f)
+        : margin(margin), motionMultiplier(motionMultiplier) {}
+
+    int32_t createProxy(glm::vec3 min, glm::vec3 max, uint32_t userData) {
+        int32_t id = allocateNode();
+        Node& n = nodes[id];
+        n.tightMin = min;
+        n.tightMax = max;
+        n.min = min - glm::vec3(margin);
+        n.max = max + glm::vec3(margin);
+        n.userData = userData;
+        n.height = 0;
+        insertLeaf(id);
+        ++proxyCount;
+        return id;
+    }
+
+    void destroyProxy(int32_t proxy) {
+        removeLeaf(proxy);
+        freeNode(proxy);
+        --proxyCount;
+    }
+
+    // `displacement` is how far the proxy moved this step; returns true if the leaf was reinserted
+    bool moveProxy(int32_t proxy, glm::vec3 min, glm::vec3 max, glm::vec3 displacement = glm::vec3(0.0f)) {
+        Node& n = nodes[proxy];
+        n.tightMin = min;
+        n.tightMax = max;
+        if (contains(n.min, n.max, min, max)) return false;
+
+        removeLeaf(proxy);
+        glm::vec3 fatMin = min - glm::vec3(margin);
+        glm::vec3 fatMax = max + glm::vec3(margin);
+        glm::vec3 ahead = displacement * motionMultiplier;
+        fatMin += glm::min(ahead, glm::vec3(0.0f));
+        fatMax += glm::max(ahead, glm::vec3(0.0f));
+        nodes[proxy].min = fatMin;
+        nodes[proxy].max = fatMax;
+        insertLeaf(proxy);
+        return true;
+    }
+
+    uint32_t getUserData(int32_t proxy) const { return nodes[proxy].userData; }
+    size_t size() const { return proxyCount; }
+    int32_t height() const { return root == NULL_NODE ? 0 : nodes[root].height; }
+
+    // Calls visit(userData, proxy) for every proxy whose tight box overlaps [min, max].
+    // Returning false from visit stops the query.
+    template<typename F>
+    void queryAABB(glm::vec3 min, glm::vec3 max, F&& visit) const {
+        Stack stack;
+        stack.push(root);
+        while (!stack.empty()) {
+            int32_t id = stack.pop();
+            if (id == NULL_NODE) continue;
+            const Node& n = nodes[id];
+            if (!overlaps(n.min, n.max, min, max)) continue;
+            if (n.isLeaf()) {
+                if (overlaps(n.tightMin, n.tightMax, min, max) && !visit(n.userData, id)) return;
+                continue;
+            }
+            stack.push(n.child1);
+            stack.push(n.child2);
+        }
+    }
+
+    void queryAABB(glm::vec3 min, glm::vec3 max, std::vector<uint32_t>& out) const {
+        queryAABB(min, max, [&](uint32_t userData, int32_t) { out.push_back(userData); return true; });
+    }
+
+    // Proxies whose tight box is within `radius` of `center`
+    template<typename F>
+    void querySphere(glm::vec3 center, float radius, F&& visit) const {
+        const float radius2 = radius * radius;
+        Stack stack;
+        stack.push(root);
+        while (!stack.empty()) {
+            int32_t id = stack.pop();
+            if (id == NULL_NODE) continue;
+            const Node& n = nodes[id];
+            if (distance2(center, n.min, n.max) > radius2) continue;
+            if (n.isLeaf()) {
+                if (distance2(center, n.tightMin, n.tightMax) <= radius2 && !visit(n.userData, id)) return;
+                continue;
+            }
+            stack.push(n.child1);
+            stack.push(n.child2);
+        }
+    }
+
+    void querySphere(glm::vec3 center, float radius, std::vector<uint32_t>& out) const {
+        querySphere(center, radius, [&](uint32_t userData, int32_t) { out.push_back(userData); return true; });
+    }
+
+    // Proxies whose tight box is at least partly inside the frustum. Subtrees entirely
+    // inside a plane stop testing it, and subtrees inside all six are taken without tests.
+    template<typename F>
+    void queryFrustum(const Frustum& frustum, F&& visit) const {
+        constexpr uint32_t ALL_PLANES = (1u << 6) - 1;
+        Stack stack;
+        stack.push(root, ALL_PLANES);
+        while (!stack.empty()) {
+            uint32_t planes;
+            int32_t id = stack.pop(planes);
+            if (id == NULL_NODE) continue;
+            const Node& n = nodes[id];
+            const bool leaf = n.isLeaf();
+            const glm::vec3& min = leaf ? n.tightMin : n.min;
+            const glm::vec3& max = leaf ? n.tightMax : n.max;
+
+            bool outside = false;
+            for (int p = 0; p < 6 && !outside; ++p) {
+                if (!(planes & (1u << p))) continue;
+                const glm::vec4& plane = frustum.planes[p];
+                const glm::vec3 normal(plane);
+                // Corners furthest along and against the plane normal
+                const glm::vec3 ahead(normal.x >= 0.0f ? max.x : min.x, normal.y >= 0.0f ? max.y : min.y, normal.z >= 0.0f ? max.z : min.z);
+                const glm::vec3 behind(normal.x >= 0.0f ? min.x : max.x, normal.y >= 0.0f ? min.y : max.y, normal.z >= 0.0f ? min.z : max.z);
+                if (glm::dot(normal, ahead) + plane.w < 0.0f) outside = true;
+                else if (glm::dot(normal, behind) + plane.w >= 0.0f) planes &= ~(1u << p);
+            }
+            if (outside) continue;
+
+            if (leaf) {
+                if (!visit(n.userData, id)) return;
+                continue;
+            }
+            stack.push(n.child1, planes);
+            stack.push(n.child2, planes);
+        }
+    }
+
+    void queryFrustum(const Frustum& frustum, std::vector<uint32_t>& out) const {
+        queryFrustum(frustum, [&](uint32_t userData, int32_t) { out.push_back(userData); return true; });
+    }
+
+    // Ray against the tight boxes. visit(userData, proxy, distance) is called for each box
+    // the ray enters before maxDistance and returns the new maxDistance: return `distance`
+    // to keep only closer hits, the old maximum to see everything, or 0 to stop.
+    template<typename F>
+    void raycast(glm::vec3 origin, glm::vec3 direction, float maxDistance, F&& visit) const {
+        const glm::vec3 inverse = 1.0f / direction;
+        Stack stack;
+        stack.push(root);
+        while (!stack.empty()) {
+            int32_t id = stack.pop();
+            if (id == NULL_NODE) continue;
+            const Node& n = nodes[id];
+            float t;
+            if (!rayHitsBox(origin, inverse, maxDistance, n.min, n.max, t)) continue;
+            if (n.isLeaf()) {
+                if (!rayHitsBox(origin, inverse, maxDistance, n.tightMin, n.tightMax, t)) continue;
+                maxDistance = visit(n.userData, id, t);
+                if (maxDistance <= 0.0f) return;
+                continue;
+            }
+
+            // Nearer child on top, so the closest hit usually shrinks the ray early
+            float t1, t2;
+            const bool hit1 = rayHitsBox(origin, inverse, maxDistance, nodes[n.child1].min, nodes[n.child1].max, t1);
+            const bool hit2 = rayHitsBox(origin, inverse, maxDistance, nodes[n.child2].min, nodes[n.child2].max, t2);
+            if (hit1 && hit2) {
+                if (t1 <= t2) { stack.push(n.child2); stack.push(n.child1); }
+                else { stack.push(n.child1); stack.push(n.child2); }
+            }
+            else if (hit1) stack.push(n.child1);
+            else if (hit2) stack.push(n.child2);
+        }
+    }
+
+    // Closest box along the ray; proxy is NULL_NODE if nothing was hit
+    RayHit raycastClosest(glm::vec3 origin, glm::vec3 direction, float maxDistance) const {
+        RayHit best;
+        raycast(origin, direction, maxDistance, [&](uint32_t userData, int32_t proxy, float distance) {
+            if (distance < best.distance) best = RayHit{ userData, proxy, distance };
+            return distance;
+        });
+        return best;
+    }
+
+    // Every box along the ray, nearest first
+    void raycastAll(glm::vec3 origin, glm::vec3 direction, float maxDistance, std::vector<RayHit>& out) const {
+        const size_t first = out.size();
+        raycast(origin, direction, maxDistance, [&](uint32_t userData, int32_t proxy, float distance) {
+            out.push_back(RayHit{ userData, proxy, distance });
+            return maxDistance;
+        });
+        std::sort(out.begin() + first, out.end(), [](const RayHit& a, const RayHit& b) { return a.distance < b.distance; });
+    }
+
+private:
+    struct Node {
+        glm::vec3 min, max;             // fat box (leaves) or union of the children
+        glm::vec3 tightMin, tightMax;   // leaves only
+        int32_t parent = NULL_NODE;     // next free node while on the free list
+        int32_t child1 = NULL_NODE;
+        int32_t child2 = NULL_NODE;
+        int32_t height = -1;            // leaf = 0, free = -1
+        uint32_t userData = 0;
+
+        bool isLeaf() const { return child1 == NULL_NODE; }
+    };
+
+    // Traversal stack that lives on the caller's stack and only allocates for very deep trees
+    struct Stack {
+        static constexpr int INLINE = 128;
+        int32_t ids[INLINE];
+        uint32_t masks[INLINE];
+        std::vector<std::pair<int32_t, uint32_t>> overflow;
+        int count = 0;
+
+        bool empty() const { return count == 0 && overflow.empty(); }
+        void push(int32_t id, uint32_t mask = 0) {
+            if (count < INLINE) { ids[count] = id; masks[count] = mask; ++count; }
+            else overflow.emplace_back(id, mask);
+        }
+        int32_t pop() { uint32_t mask; return pop(mask); }
+        int32_t pop(uint32_t& mask) {
+            if (!overflow.empty()) {
+                auto [id, m] = overflow.back();
+                overflow.pop_back();
+                mask = m;
+                return id;
+            }
+            --count;
+            mask = masks[count];
+            return ids[count];
+        }
+    };
+
+    static bool overlaps(const glm::vec3& aMin, const glm::vec3& aMax, const glm::vec3& bMin, const glm::vec3& bMax) {
+        return aMin.x <= bMax.x && aMax.x >= bMin.x &&
+            aMin.y <= bMax.y && aMax.y >= bMin.y &&
+            aMin.z <= bMax.z && aMax.z >= bMin.z;
+    }
+
+    static bool contains(const glm::vec3& outerMin, const glm::vec3& outerMax, const glm::vec3& min, const glm::vec3& max) {
+        return outerMin.x <= min.x && outerMin.y <= min.y && outerMin.z <= min.z &&
+            max.x <= outerMax.x && max.y <= outerMax.y && max.z <= outerMax.z;
+    }
+
+    // Squared distance from a point to a box, 0 inside
+    static float distance2(const glm::vec3& p, const glm::vec3& min, const glm::vec3& max) {
+        glm::vec3 d = glm::max(glm::max(min - p, p - max), glm::vec3(0.0f));
+        return glm::dot(d, d);
+    }
+
+    // Slab test; `t` is the entry distance (0 if the origin is inside)
+    static bool rayHitsBox(const glm::vec3& origin, const glm::vec3& inverse, float maxDistance,
+        const glm::vec3& min, const glm::vec3& max, float& t) {
+        glm::vec3 t0 = (min - origin) * inverse;
+        glm::vec3 t1 = (max - origin) * inverse;
+        glm::vec3 tNear = glm::min(t0, t1);
+        glm::vec3 tFar = glm::max(t0, t1);
+        float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+        float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, maxDistance));
+        t = enter;
+        return enter <= exit;
+    }
+
+    static float area(const glm::vec3& min, const glm::vec3& max) {
+        glm::vec3 e = max - min;
+        return 2.0f * (e.x * e.y + e.y * e.z + e.z * e.x);
+    }
+
+    int32_t allocateNode() {
+        if (freeList == NULL_NODE) {
+            nodes.emplace_back();
+            return static_cast<int32_t>(nodes.size() - 1);
+        }
+        int32_t id = freeList;
+        freeList = nodes[id].parent;
+        nodes[id] = Node{};
+        return id;
+    }
+
+    void freeNode(int32_t id) {
+        nodes[id].parent = freeList;
+        nodes[id].height = -1;
+        freeList = id;
+    }
+
+    void insertLeaf(int32_t leaf) {
+        if (root == NULL_NODE) {
+            root = leaf;
+            nodes[root].parent = NULL_NODE;
+            return;
+        }
+
+        // Walk down to the sibling that grows the total surface area the least
+        const glm::vec3 leafMin = nodes[leaf].min;
+        const glm::vec3 leafMax = nodes[leaf].max;
+        int32_t index = root;
+        while (!nodes[index].isLeaf()) {
+            const Node& n = nodes[index];
+            const float nodeArea = area(n.min, n.max);
+            const float combinedArea = area(glm::min(n.min, leafMin), glm::max(n.max, leafMax));
+
+            // Cost of a new parent here, and the minimum cost of pushing the leaf further down
+            const float cost = 2.0f * combinedArea;
+            const float inheritance = 2.0f * (combinedArea - nodeArea);
+
+            auto descendCost = [&](int32_t child) {
+                const Node& c = nodes[child];
+                float grown = area(glm::min(c.min, leafMin), glm::max(c.max, leafMax));
+                return c.isLeaf() ? grown + inheritance : grown - area(c.min, c.max) + inheritance;
+            };
+            const float cost1 = descendCost(n.child1);
+            const float cost2 = descendCost(n.child2);
+
+            if (cost < cost1 && cost < cost2) break;
+            index = cost1 < cost2 ? n.child1 : n.child2;
+        }
+
+        const int32_t sibling = index;
+        const int32_t oldParent = nodes[sibling].parent;
+        const int32_t newParent = allocateNode();
+        Node& p = nodes[newParent];
+        p.parent = oldParent;
+        p.min = glm::min(leafMin, nodes[sibling].min);
+        p.max = glm::max(leafMax, nodes[sibling].max);
+        p.height = nodes[sibling].height + 1;
+        p.child1 = sibling;
+        p.child2 = leaf;
+        nodes[sibling].parent = newParent;
+        nodes[leaf].parent = newParent;
+
+        if (oldParent == NULL_NODE) root = newParent;
+        else if (nodes[oldParent].child1 == sibling) nodes[oldParent].child1 = newParent;
+        else nodes[oldParent].child2 = newParent;
+
+        refitFrom(nodes[leaf].parent);
+    }
+
+    void removeLeaf(int32_t leaf) {
+        if (leaf == root) {
+            root = NULL_NODE;
+            return;
+        }
+
+        const int32_t parent = nodes[leaf].parent;
+        const int32_t grandParent = nodes[parent].parent;
+        const int32_t sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+
+        if (grandParent == NULL_NODE) {
+            root = sibling;
+            nodes[sibling].parent = NULL_NODE;
+            freeNode(parent);
+            return;
+        }
+
+        // The sibling takes the parent's place
+        if (nodes[grandParent].child1 == parent) nodes[grandParent].child1 = sibling;
+        else nodes[grandParent].child2 = sibling;
+        nodes[sibling].parent = grandParent;
+        freeNode(parent);
+        refitFrom(grandParent);
+    }
+
+    // Rebalances and refits every ancestor from `index` up to the root
+    void refitFrom(int32_t index) {
+        while (index != NULL_NODE) {
+            index = balance(index);
+            Node& n = nodes[index];
+            const Node& c1 = nodes[n.child1];
+            const Node& c2 = nodes[n.child2];
+            n.height = 1 + std::max(c1.height, c2.height);
+            n.min = glm::min(c1.min, c2.min);
+            n.max = glm::max(c1.max, c2.max);
+            index = n.parent;
+        }
+    }
+
+    // If one child of A is more than one level taller, rotates it up. Returns the subtree root.
+    int32_t balance(int32_t iA) {
+        Node& A = nodes[iA];
+        if (A.isLeaf() || A.height < 2) return iA;
+
+        const int32_t iB = A.child1;
+        const int32_t iC = A.child2;
+        const int32_t diff = nodes[iC].height - nodes[iB].height;
+        if (diff > 1) return rotateUp(iA, iC, iB);
+        if (diff < -1) return rotateUp(iA, iB, iC);
+        return iA;
+    }
+
+    // Moves the tall child `iUp` into A's place; A keeps `iStay` and the shorter grandchild
+    int32_t rotateUp(int32_t iA, int32_t iUp, int32_t iStay) {
+        Node& A = nodes[iA];
+        Node& U = nodes[iUp];
+        const int32_t iF = U.child1;
+        const int32_t iG = U.child2;
+
+        U.child1 = iA;
+        U.parent = A.parent;
+        A.parent = iUp;
+        if (U.parent == NULL_NODE) root = iUp;
+        else if (nodes[U.parent].child1 == iA) nodes[U.parent].child1 = iUp;
+        else nodes[U.parent].child2 = iUp;
+
+        // The taller grandchild stays with U, the other goes to A
+        const bool keepF = nodes[iF].height > nodes[iG].height;
+        const int32_t iKeep = keepF ? iF : iG;
+        const int32_t iMove = keepF ? iG : iF;
+        U.child2 = iKeep;
+        if (A.child1 == iUp) A.child1 = iMove;
+        else A.child2 = iMove;
+        nodes[iMove].parent = iA;
+
+        const Node& S = nodes[iStay];
+        A.min = glm::min(S.min, nodes[iMove].min);
+        A.max = glm::max(S.max, nodes[iMove].max);
+        A.height = 1 + std::max(S.height, nodes[iMove].height);
+        U.min = glm::min(A.min, nodes[iKeep].min);
+        U.max = glm::max(A.max, nodes[iKeep].max);
+        U.height = 1 + std::max(A.height, nodes[iKeep].height);
+        return iUp;
+    }
+
+    float margin;
+    float motionMultiplier;
+    std::vector<Node> nodes;
+    int32_t root = NULL_NODE;
+    int32_t freeList = NULL_NODE;
+    size_t proxyCount = 0;
+};
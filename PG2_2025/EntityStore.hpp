@@ -0,0 +1,511 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <string_view>
+#include <unordered_map>
+#include <stdexcept>
+#include <glm/glm.hpp>
+
+#include "Entity.hpp"
+#include "HeightField.hpp"
+#include "CommandBuffer.hpp"
+#include "JobSystem.hpp"
+#include "NameTable.hpp"
+#include "Snapshot.hpp"
+
+// Structure-of-arrays entity storage.
+// Components live in dense, parallel arrays indexed by [0, size()); destroying an entity
+// swap-removes it so the arrays stay packed. Handles go through a slot table with a
+// generation counter, so stale handles are detected instead of aliasing a new entity.
+// Freed slots and behavior lists are recycled, so spawning and despawning in steady
+// state does not allocate.
+class EntityStore {
+public:
+    using Behavior = Entity::Behavior;
+
+    // === Dense components ===
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec3> velocities;
+    std::vector<glm::vec3> accelerations;
+    std::vector<Orientation> orientations;
+    std::vector<PhysicsBody> bodies;
+    std::vector<Activity> activity;
+    std::vector<Model*> models;
+    std::vector<std::vector<Behavior>> behaviors;
+    std::vector<EntityHandle> handles;   // dense index -> owning handle
+
+    // State at the start of the last simulation step, for render interpolation
+    std::vector<glm::vec3> previousPositions;
+    std::vector<float> previousYaws;
+
+    size_t size() const { return positions.size(); }
+    bool empty() const { return positions.empty(); }
+
+    void reserve(size_t n) {
+        positions.reserve(n);
+        velocities.reserve(n);
+        accelerations.reserve(n);
+        orientations.reserve(n);
+        bodies.reserve(n);
+        activity.reserve(n);
+        models.reserve(n);
+        behaviors.reserve(n);
+        handles.reserve(n);
+        previousPositions.reserve(n);
+        previousYaws.reserve(n);
+        slots.reserve(n);
+    }
+
+    EntityHandle create(glm::vec3 startPosition, Model* model = nullptr) {
+        uint32_t slot;
+        if (!freeSlots.empty()) {
+            slot = freeSlots.back();
+            freeSlots.pop_back();
+        }
+        else {
+            slot = static_cast<uint32_t>(slots.size());
+            slots.push_back(Slot{});
+        }
+
+        Slot& s = slots[slot];
+        s.dense = static_cast<uint32_t>(size());
+        EntityHandle handle{ slot, s.generation };
+
+        positions.push_back(startPosition);
+        velocities.push_back(glm::vec3(0.0f));
+        accelerations.push_back(glm::vec3(0.0f));
+        orientations.push_back(Orientation{});
+        bodies.push_back(PhysicsBody{});
+        activity.push_back(Activity{});
+        models.push_back(model);
+        if (!spareBehaviors.empty()) {
+            behaviors.push_back(std::move(spareBehaviors.back()));
+            spareBehaviors.pop_back();
+        }
+        else {
+            behaviors.emplace_back();
+        }
+        handles.push_back(handle);
+        previousPositions.push_back(startPosition);
+        previousYaws.push_back(orientations.back().yaw);
+
+        view(s.dense).updateOrientation();
+        return handle;
+    }
+
+    void destroy(EntityHandle handle) {
+        if (!alive(handle)) return;
+
+        uint32_t i = slots[handle.index].dense;
+        uint32_t last = static_cast<uint32_t>(size() - 1);
+        if (i != last) {
+            positions[i] = positions[last];
+            velocities[i] = velocities[last];
+            accelerations[i] = accelerations[last];
+            orientations[i] = orientations[last];
+            bodies[i] = bodies[last];
+            activity[i] = activity[last];
+            models[i] = models[last];
+            behaviors[i].swap(behaviors[last]);
+            handles[i] = handles[last];
+            previousPositions[i] = previousPositions[last];
+            previousYaws[i] = previousYaws[last];
+            slots[handles[i].index].dense = i;
+        }
+        positions.pop_back();
+        velocities.pop_back();
+        accelerations.pop_back();
+        orientations.pop_back();
+        bodies.pop_back();
+        activity.pop_back();
+        models.pop_back();
+        behaviors[last].clear(); // keep the capacity for the next create()
+        spareBehaviors.push_back(std::move(behaviors[last]));
+        behaviors.pop_back();
+        handles.pop_back();
+        previousPositions.pop_back();
+        previousYaws.pop_back();
+
+        Slot& s = slots[handle.index];
+        if (s.name != NameTable::NONE) {
+            if (named[s.name] == handle) named[s.name] = EntityHandle{};
+            s.name = NameTable::NONE;
+        }
+        s.dense = INVALID;
+        if (++s.generation == 0) s.generation = 1;
+        freeSlots.push_back(handle.index);
+    }
+
+    bool alive(EntityHandle handle) const {
+        return handle.index < slots.size()
+            && slots[handle.index].generation == handle.generation
+            && slots[handle.index].dense != INVALID;
+    }
+
+    // Dense index of a live entity, INVALID otherwise
+    uint32_t indexOf(EntityHandle handle) const {
+        return alive(handle) ? slots[handle.index].dense : INVALID;
+    }
+
+    Entity view(uint32_t i) {
+        return Entity(handles[i], positions[i], velocities[i], accelerations[i], orientations[i], bodies[i], models[i], behaviors[i]);
+    }
+
+    Entity get(EntityHandle handle) {
+        return view(indexOf(handle));
+    }
+
+    // Forces the entity to be simulated again next step (see UpdateScheduler)
+    void wake(EntityHandle handle) {
+        uint32_t i = indexOf(handle);
+        if (i == INVALID) return;
+        activity[i].sleeping = false;
+        activity[i].restTime = 0.0f;
+    }
+
+    // Debug names. Interned once; find() is a table lookup plus a handle check.
+    // Naming a second entity with the same name rebinds the name to it.
+    void setName(EntityHandle handle, std::string_view name) {
+        if (!alive(handle)) return;
+        Slot& s = slots[handle.index];
+        if (s.name != NameTable::NONE && named[s.name] == handle) named[s.name] = EntityHandle{};
+
+        NameId id = names.intern(name);
+        if (named.size() <= id) named.resize(id + 1);
+        EntityHandle& previous = named[id];
+        if (alive(previous) && previous != handle) slots[previous.index].name = NameTable::NONE;
+        previous = handle;
+        s.name = id;
+    }
+
+    std::string_view nameOf(EntityHandle handle) const {
+        return alive(handle) ? names.str(slots[handle.index].name) : std::string_view();
+    }
+
+    // Null handle if no live entity has this name
+    EntityHandle find(std::string_view name) const {
+        NameId id = names.find(name);
+        if (id == NameTable::NONE || id >= named.size() || !alive(named[id])) return EntityHandle{};
+        return named[id];
+    }
+
+    void clear() {
+        for (EntityHandle h : std::vector<EntityHandle>(handles)) destroy(h);
+    }
+
+    // Snapshot transforms before a fixed simulation step
+    void beginStep() {
+        previousPositions = positions;
+        for (size_t i = 0; i < size(); ++i) previousYaws[i] = orientations[i].yaw;
+    }
+
+    // Transform between the previous and the current step, alpha in [0, 1]
+    glm::vec3 renderPosition(uint32_t i, float alpha) const {
+        return glm::mix(previousPositions[i], positions[i], alpha);
+    }
+
+    float renderYaw(uint32_t i, float alpha) const {
+        float d = std::remainder(orientations[i].yaw - previousYaws[i], 360.0f); // shortest way round
+        return previousYaws[i] + d * alpha;
+    }
+
+    // === Snapshots ===
+    // Components, slot table and names. Models are stored as indices into `modelTable`
+    // (0 = none). Closure behaviors cannot be serialized: restored entities have none.
+    void save(SnapshotWriter& w, const std::vector<Model*>& modelTable) const {
+        std::unordered_map<const Model*, uint32_t> modelIds;
+        for (size_t m = 0; m < modelTable.size(); ++m) modelIds[modelTable[m]] = static_cast<uint32_t>(m + 1);
+        std::vector<uint32_t> modelRefs(size(), 0);
+        const Model* last = nullptr;
+        uint32_t lastId = 0;
+        for (size_t i = 0; i < size(); ++i) {
+            if (!models[i]) continue;
+            if (models[i] != last) {
+                auto it = modelIds.find(models[i]);
+                if (it == modelIds.end()) throw std::runtime_error("Snapshot: entity model is not in the model table");
+                last = models[i];
+                lastId = it->second;
+            }
+            modelRefs[i] = lastId;
+        }
+
+        const size_t perEntity = sizeof(glm::vec3) * 4 + sizeof(Orientation) + sizeof(PhysicsBody) + sizeof(Activity)
+            + sizeof(EntityHandle) + sizeof(float) + sizeof(uint32_t) + sizeof(Slot);
+        w.buffer.reserve(w.buffer.size() + perEntity * slots.size() + 1024);
+
+        w.beginSection(Snapshot::fourcc("ENTS"));
+        w.writeArray(positions);
+        w.writeArray(velocities);
+        w.writeArray(accelerations);
+        w.writeArray(orientations);
+        w.writeArray(bodies);
+        w.writeArray(activity);
+        w.writeArray(handles);
+        w.writeArray(previousPositions);
+        w.writeArray(previousYaws);
+        w.writeArray(modelRefs);
+        w.writeArray(slots);
+        w.writeArray(freeSlots);
+        w.write(static_cast<uint32_t>(names.size()));
+        for (NameId id = 0; id < names.size(); ++id) w.writeString(names.str(id));
+        w.writeArray(named);
+        w.endSection();
+    }
+
+private:
+    struct Slot {
+        uint32_t dense = INVALID;
+        uint32_t generation = 1;
+        NameId name = NameTable::NONE;
+    };
+
+public:
+    // A decoded, checked ENTS section, not yet part of the store
+    struct Loaded {
+        std::vector<glm::vec3> positions, velocities, accelerations, previousPositions;
+        std::vector<Orientation> orientations;
+        std::vector<PhysicsBody> bodies;
+        std::vector<Activity> activity;
+        std::vector<Model*> models;
+        std::vector<EntityHandle> handles;
+        std::vector<float> previousYaws;
+        std::vector<Slot> slots;
+        std::vector<uint32_t> freeSlots;
+        NameTable names;
+        std::vector<EntityHandle> named;
+
+        bool contains(EntityHandle h) const {
+            return h.index < slots.size() && slots[h.index].generation == h.generation && slots[h.index].dense != INVALID;
+        }
+    };
+
+    // Reads and validates; throws on a truncated or inconsistent section and leaves
+    // the store untouched
+    static Loaded decode(SnapshotReader& r, const std::vector<Model*>& modelTable) {
+        if (!r.openSection(Snapshot::fourcc("ENTS"))) throw std::runtime_error("Snapshot has no entities");
+        Loaded l;
+        r.readArray(l.positions);
+        r.readArray(l.velocities);
+        r.readArray(l.accelerations);
+        r.readArray(l.orientations);
+        r.readArray(l.bodies);
+        r.readArray(l.activity);
+        r.readArray(l.handles);
+        r.readArray(l.previousPositions);
+        r.readArray(l.previousYaws);
+        std::vector<uint32_t> modelRefs;
+        r.readArray(modelRefs);
+        r.readArray(l.slots);
+        r.readArray(l.freeSlots);
+        uint32_t nameCount = r.read<uint32_t>();
+        for (uint32_t n = 0; n < nameCount; ++n) l.names.intern(r.readString());
+        r.readArray(l.named);
+
+        const size_t n = l.positions.size();
+        if (l.velocities.size() != n || l.accelerations.size() != n || l.orientations.size() != n || l.bodies.size() != n
+            || l.activity.size() != n || l.handles.size() != n || l.previousPositions.size() != n || l.previousYaws.size() != n
+            || modelRefs.size() != n) {
+            throw std::runtime_error("Snapshot: entity arrays differ in size");
+        }
+
+        l.models.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            if (modelRefs[i] > modelTable.size()) throw std::runtime_error("Snapshot: unknown model index");
+            l.models[i] = modelRefs[i] ? modelTable[modelRefs[i] - 1] : nullptr;
+        }
+
+        // Every live entity owns its slot, every other slot is free exactly once
+        for (size_t i = 0; i < n; ++i) {
+            const EntityHandle h = l.handles[i];
+            if (h.index >= l.slots.size() || l.slots[h.index].dense != i || l.slots[h.index].generation != h.generation) {
+                throw std::runtime_error("Snapshot: entity handles do not match the slot table");
+            }
+        }
+        std::vector<uint8_t> isFree(l.slots.size(), 0);
+        for (uint32_t f : l.freeSlots) {
+            if (f >= l.slots.size() || l.slots[f].dense != INVALID || isFree[f]) throw std::runtime_error("Snapshot: bad free slot list");
+            isFree[f] = 1;
+        }
+        if (n + l.freeSlots.size() != l.slots.size()) throw std::runtime_error("Snapshot: slot table does not add up");
+        for (const Slot& slot : l.slots) {
+            if (slot.generation == 0) throw std::runtime_error("Snapshot: bad slot generation");
+            if (slot.name != NameTable::NONE && (slot.name >= nameCount || slot.name >= l.named.size())) {
+                throw std::runtime_error("Snapshot: bad entity name");
+            }
+        }
+        if (l.named.size() > nameCount) throw std::runtime_error("Snapshot: bad name table");
+        return l;
+    }
+
+    // Replaces every entity with the decoded ones (closure behaviors are dropped)
+    void apply(Loaded&& l) {
+        positions = std::move(l.positions);
+        velocities = std::move(l.velocities);
+        accelerations = std::move(l.accelerations);
+        orientations = std::move(l.orientations);
+        bodies = std::move(l.bodies);
+        activity = std::move(l.activity);
+        models = std::move(l.models);
+        handles = std::move(l.handles);
+        previousPositions = std::move(l.previousPositions);
+        previousYaws = std::move(l.previousYaws);
+        slots = std::move(l.slots);
+        freeSlots = std::move(l.freeSlots);
+        names = std::move(l.names);
+        named = std::move(l.named);
+        for (auto& list : behaviors) list.clear();
+        behaviors.resize(size());
+    }
+
+    void load(SnapshotReader& r, const std::vector<Model*>& modelTable) {
+        apply(decode(r, modelTable));
+    }
+
+    // Entities per update chunk. Fixed so chunk boundaries (and with them the order
+    // deferred commands are applied in) never depend on the thread count.
+    static constexpr size_t UPDATE_CHUNK = 256;
+
+    // Gravity, behaviors, integration and ground contact for every entity.
+    // With a JobSystem the entities are updated in parallel chunks; deferred commands
+    // recorded by behaviors are applied afterwards in chunk order.
+    void integrate(float deltaTime, const HeightField& ground, JobSystem* jobs = nullptr) {
+        const size_t n = size();
+        size_t chunks = (n + UPDATE_CHUNK - 1) / UPDATE_CHUNK;
+        if (chunkCommands.size() < chunks) chunkCommands.resize(chunks);
+
+        auto updateChunk = [&](size_t begin, size_t end, size_t chunk) {
+            integrateRange(begin, end, deltaTime, ground, chunkCommands[chunk]);
+        };
+        if (jobs) {
+            jobs->parallelFor(n, UPDATE_CHUNK, updateChunk);
+        }
+        else {
+            for (size_t c = 0; c < chunks; ++c) {
+                updateChunk(c * UPDATE_CHUNK, std::min(n, (c + 1) * UPDATE_CHUNK), c);
+            }
+        }
+
+        for (size_t c = 0; c < chunks; ++c) {
+            if (!chunkCommands[c].empty()) chunkCommands[c].apply(*this);
+        }
+    }
+
+    // Scheduled update: integrates only the listed dense indices, each with its own
+    // time step (see UpdateScheduler). Same chunking and command ordering as above.
+    void integrate(const std::vector<uint32_t>& indices, const std::vector<float>& stepTimes,
+        const HeightField& ground, JobSystem* jobs = nullptr) {
+        const size_t n = indices.size();
+        size_t chunks = (n + UPDATE_CHUNK - 1) / UPDATE_CHUNK;
+        if (chunkCommands.size() < chunks) chunkCommands.resize(chunks);
+
+        auto updateChunk = [&](size_t begin, size_t end, size_t chunk) {
+            for (size_t k = begin; k < end; ++k) {
+                uint32_t i = indices[k];
+                integrateOne(i, stepTimes[i], ground, chunkCommands[chunk]);
+            }
+        };
+        if (jobs) {
+            jobs->parallelFor(n, UPDATE_CHUNK, updateChunk);
+        }
+        else {
+            for (size_t c = 0; c < chunks; ++c) {
+                updateChunk(c * UPDATE_CHUNK, std::min(n, (c + 1) * UPDATE_CHUNK), c);
+            }
+        }
+
+        for (size_t c = 0; c < chunks; ++c) {
+            if (!chunkCommands[c].empty()) chunkCommands[c].apply(*this);
+        }
+    }
+
+    void integrateRange(size_t begin, size_t end, float deltaTime, const HeightField& ground, CommandBuffer& commands) {
+        for (size_t i = begin; i < end; ++i) {
+            integrateOne(i, deltaTime, ground, commands);
+        }
+    }
+
+    void integrateOne(size_t i, float deltaTime, const HeightField& ground, CommandBuffer& commands) {
+        PhysicsBody& body = bodies[i];
+
+        // Apply gravity if not grounded
+        if (!body.isGrounded) {
+            accelerations[i].y += body.gravity;
+        }
+
+        if (!behaviors[i].empty()) {
+            Entity self = view(static_cast<uint32_t>(i));
+            self.commands = &commands;
+            for (auto& b : behaviors[i]) {
+                b(self, deltaTime);
+            }
+        }
+
+        glm::vec3& velocity = velocities[i];
+        glm::vec3& position = positions[i];
+
+        // Integrate acceleration into velocity
+        velocity += accelerations[i] * deltaTime;
+
+        // Apply drag only to horizontal movement
+        float dragFactor = std::pow(body.drag, deltaTime);
+        velocity.x *= dragFactor;
+        velocity.z *= dragFactor;
+
+        // Update position
+        position += velocity * deltaTime;
+
+        // Check for ground collision
+        float groundHeight = ground.getHeight(position);
+        if (position.y <= groundHeight) {
+            position.y = groundHeight;
+            velocity.y = 0;
+            body.isGrounded = true;
+        }
+        else {
+            body.isGrounded = false;
+        }
+
+        // Reset acceleration (forces apply for one frame)
+        accelerations[i] = glm::vec3(0.0f);
+    }
+
+    static constexpr uint32_t INVALID = UINT32_MAX;
+
+private:
+    std::vector<Slot> slots;
+    std::vector<uint32_t> freeSlots;
+    std::vector<std::vector<Behavior>> spareBehaviors;
+    NameTable names;
+    std::vector<EntityHandle> named;   // NameId -> entity currently holding the name
+    std::vector<CommandBuffer> chunkCommands;
+};
+
+inline void CommandBuffer::apply(EntityStore& store) {
+    for (Command& c : commands) {
+        switch (c.type) {
+        case Type::Spawn: {
+            EntityHandle h = store.create(c.vec, c.model);
+            store.behaviors[store.indexOf(h)] = std::move(c.behaviors);
+            break;
+        }
+        case Type::Destroy:
+            store.destroy(c.target);
+            break;
+        case Type::ApplyForce:
+            if (store.alive(c.target)) store.accelerations[store.indexOf(c.target)] += c.vec;
+            break;
+        case Type::AddVelocity:
+            if (store.alive(c.target)) store.velocities[store.indexOf(c.target)] += c.vec;
+            break;
+        case Type::AddBehavior:
+            if (store.alive(c.target)) {
+                auto& list = store.behaviors[store.indexOf(c.target)];
+                for (auto& b : c.behaviors) list.push_back(std::move(b));
+            }
+            break;
+        }
+    }
+    commands.clear();
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PG2_SSE2 1
+#endif
+
+// Batched math helpers for the SoA systems.
+namespace FastMath {
+
+    // Quadrant reduction + minimax polynomials on [-pi/4, pi/4], ~1e-7 abs error.
+    // The SIMD and scalar paths use the same polynomial so results do not depend on
+    // where an element lands in the batch.
+    constexpr float TWO_OVER_PI = 0.636619772367581343f;
+    constexpr float PIO2_HI = 1.5707963705062866f;
+    constexpr float PIO2_LO = -4.37113900018624283e-8f;
+    constexpr float S1 = -1.6666654611e-1f, S2 = 8.3321608736e-3f, S3 = -1.9515295891e-4f;
+    constexpr float C1 = -0.5f, C2 = 4.166664568298827e-2f, C3 = -1.388731625493765e-3f, C4 = 2.443315711809948e-5f;
+
+    inline void sinCos(float x, float& s, float& c) {
+        float q = std::nearbyint(x * TWO_OVER_PI);
+        int32_t qi = static_cast<int32_t>(q);
+        float r = (x - q * PIO2_HI) - q * PIO2_LO;
+        float r2 = r * r;
+        float sp = r + r * r2 * (S1 + r2 * (S2 + r2 * S3));
+        float cp = 1.0f + r2 * (C1 + r2 * (C2 + r2 * (C3 + r2 * C4)));
+        if (qi & 1) { float t = sp; sp = cp; cp = t; }
+        s = (qi & 2) ? -sp : sp;
+        c = ((qi + 1) & 2) ? -cp : cp;
+    }
+
+    // out_sin[i], out_cos[i] = sin(x[i]), cos(x[i]) for i in [0, n)
+    inline void sinCos(const float* x, float* outSin, float* outCos, size_t n) {
+        size_t i = 0;
+#ifdef PG2_SSE2
+        const __m128 twoOverPi = _mm_set1_ps(TWO_OVER_PI);
+        const __m128 pio2Hi = _mm_set1_ps(PIO2_HI);
+        const __m128 pio2Lo = _mm_set1_ps(PIO2_LO);
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128i iOne = _mm_set1_epi32(1);
+        const __m128i iTwo = _mm_set1_epi32(2);
+
+        for (; i + 4 <= n; i += 4) {
+            __m128 v = _mm_loadu_ps(x + i);
+            __m128i qi = _mm_cvtps_epi32(_mm_mul_ps(v, twoOverPi)); // round to nearest
+            __m128 q = _mm_cvtepi32_ps(qi);
+            __m128 r = _mm_sub_ps(_mm_sub_ps(v, _mm_mul_ps(q, pio2Hi)), _mm_mul_ps(q, pio2Lo));
+            __m128 r2 = _mm_mul_ps(r, r);
+
+            __m128 sp = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(S3), r2), _mm_set1_ps(S2));
+            sp = _mm_add_ps(_mm_mul_ps(sp, r2), _mm_set1_ps(S1));
+            sp = _mm_add_ps(r, _mm_mul_ps(_mm_mul_ps(r, r2), sp));
+
+            __m128 cp = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(C4), r2), _mm_set1_ps(C3));
+            cp = _mm_add_ps(_mm_mul_ps(cp, r2), _mm_set1_ps(C2));
+            cp = _mm_add_ps(_mm_mul_ps(cp, r2), _mm_set1_ps(C1));
+            cp = _mm_add_ps(_mm_mul_ps(cp, r2), one);
+
+            __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(qi, iOne), iOne));
+            __m128 s = _mm_or_ps(_mm_and_ps(swap, cp), _mm_andnot_ps(swap, sp));
+            __m128 c = _mm_or_ps(_mm_and_ps(swap, sp), _mm_andnot_ps(swap, cp));
+
+            __m128 sinSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(qi, iTwo), 30));
+            __m128 cosSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(qi, iOne), iTwo), 30));
+
+            _mm_storeu_ps(outSin + i, _mm_xor_ps(s, sinSign));
+            _mm_storeu_ps(outCos + i, _mm_xor_ps(c, cosSign));
+        }
+#endif
+        for (; i < n; ++i) {
+            sinCos(x[i], outSin[i], outCos[i]);
+        }
+    }
+
+    // out[i] = squared distance from (px, py, pz) to (x[i], y[i], z[i]) for i in [0, n).
+    // Same operation order in both paths, so the results are identical.
+    inline void distanceSquared(const float* x, const float* y, const float* z, float px, float py, float pz, float* out, size_t n) {
+        size_t i = 0;
+#ifdef PG2_SSE2
+        const __m128 qx = _mm_set1_ps(px), qy = _mm_set1_ps(py), qz = _mm_set1_ps(pz);
+        for (; i + 4 <= n; i += 4) {
+            __m128 dx = _mm_sub_ps(_mm_loadu_ps(x + i), qx);
+            __m128 dy = _mm_sub_ps(_mm_loadu_ps(y + i), qy);
+            __m128 dz = _mm_sub_ps(_mm_loadu_ps(z + i), qz);
+            _mm_storeu_ps(out + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz)));
+        }
+#endif
+        for (; i < n; ++i) {
+            float dx = x[i] - px, dy = y[i] - py, dz = z[i] - pz;
+            float dx2 = dx * dx, dy2 = dy * dy, dz2 = dz * dz;
+            out[i] = (dx2 + dy2) + dz2;
+        }
+    }
+
+    // Wraps an angle to [0, 2*pi) so accumulated angles keep full float precision
+    inline float wrapAngle(float a) {
+        constexpr float TWO_PI = 6.28318530717958648f;
+        return a - TWO_PI * std::floor(a / TWO_PI);
+    }
+}
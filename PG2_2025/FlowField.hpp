@@ -0,0 +1,79 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cfloat>
+#include <algorithm>
+#include <glm/glm.hpp>
+
+#include "NavGrid.hpp"
+
+// Directions towards one goal for every cell of a NavGrid.
+// Built with Dijkstra from the goal (the integration field), then each cell points at
+// its cheapest neighbour. Any number of agents heading for the same goal just look up
+// their cell, so one field replaces one path search per agent.
+class FlowField {
+public:
+    using Cell = NavGrid::Cell;
+
+    void build(const NavGrid& navGrid, Cell goalCell) {
+        grid = &navGrid;
+        goal = goalCell;
+        const size_t n = grid->size();
+        costs.assign(n, FLT_MAX);
+        next.assign(n, NavGrid::NONE);
+        if (goal == NavGrid::NONE || !grid->walkable(goal)) return;
+
+        auto greater = [](const std::pair<float, Cell>& a, const std::pair<float, Cell>& b) {
+            return a.first != b.first ? a.first > b.first : a.second > b.second;
+        };
+        std::vector<std::pair<float, Cell>> open;
+        costs[goal] = 0.0f;
+        open.emplace_back(0.0f, goal);
+        while (!open.empty()) {
+            std::pop_heap(open.begin(), open.end(), greater);
+            const auto [cost, c] = open.back();
+            open.pop_back();
+            if (cost > costs[c]) continue;
+            grid->forEachNeighbour(c, [&](Cell m) {
+                const float g = cost + grid->moveCost(c, m);
+                if (g >= costs[m]) return;
+                costs[m] = g;
+                next[m] = c;    // moves are symmetric: m reaches the goal through c
+                open.emplace_back(g, m);
+                std::push_heap(open.begin(), open.end(), greater);
+            });
+        }
+    }
+
+    Cell goalCell() const { return goal; }
+    bool reachable(Cell c) const { return c < costs.size() && costs[c] != FLT_MAX; }
+
+    // Cost to the goal from the cell nearest to p, FLT_MAX if the goal is out of reach
+    float cost(const glm::vec3& p) const { return grid ? costs[grid->cellAt(p)] : FLT_MAX; }
+
+    // Horizontal unit direction to walk from p, zero at the goal or where the goal is
+    // out of reach. Agents between cells head for the next cell's centre, which keeps
+    // them on the field's route around blocked cells. Agents pushed onto a blocked cell
+    // head back for the nearest walkable one.
+    glm::vec3 direction(const glm::vec3& p) const {
+        if (!grid) return glm::vec3(0.0f);
+        const Cell c = grid->cellAt(p);
+        Cell target = c == goal ? goal : next[c];
+        if (target == NavGrid::NONE && !grid->walkable(c)) {
+            target = grid->nearestWalkable(c);
+            if (!reachable(target)) target = NavGrid::NONE;
+        }
+        if (target == NavGrid::NONE) return glm::vec3(0.0f);
+        glm::vec3 d = grid->position(target) - p;
+        d.y = 0.0f;
+        const float length = glm::length(d);
+        return length > 1e-4f ? d / length : glm::vec3(0.0f);
+    }
+
+private:
+    const NavGrid* grid = nullptr;
+    Cell goal = NavGrid::NONE;
+    std::vector<float> costs;       // integration field
+    std::vector<Cell> next;         // by cell: neighbour one step closer to the goal
+};
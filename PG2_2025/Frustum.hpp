@@ -75,3 +75,19 @@ inline bool isInsideFrustum(const Frustum& frustum, float radius, const glm::vec
 
     return true; // Intersects or inside all planes
 }
+
+inline bool isBoxInsideFrustum(const Frustum& frustum, const glm::vec3& boxMin, const glm::vec3& boxMax) {
+    for (const auto& plane : frustum.planes) {
+        // Corner furthest along the plane normal
+        glm::vec3 p(
+            plane.x >= 0.0f ? boxMax.x : boxMin.x,
+            plane.y >= 0.0f ? boxMax.y : boxMin.y,
+            plane.z >= 0.0f ? boxMax.z : boxMin.z
+        );
+        if (glm::dot(glm::vec3(plane), p) + plane.w < 0.0f) {
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,224 @@
+#pragma once
+
+#include <array>
+#include <algorithm>
+#include <cmath>
+#include <cfloat>
+#include <glm/glm.hpp>
+
+// GJK overlap test and EPA penetration depth for convex shapes.
+// Shapes are given as one support function of their Minkowski difference A - B:
+//
+//     auto support = [&](const glm::vec3& d) { return supportA(d) - supportB(-d); };
+//
+// A and B overlap exactly when that difference contains the origin.
+namespace Gjk {
+
+    struct Simplex {
+        std::array<glm::vec3, 4> points;   // points[0] is the newest
+        int size = 0;
+
+        void push(const glm::vec3& p) {
+            for (int i = std::min(size, 3); i > 0; --i) points[i] = points[i - 1];
+            points[0] = p;
+            size = std::min(size + 1, 4);
+        }
+        void set(std::initializer_list<glm::vec3> list) {
+            size = 0;
+            for (const glm::vec3& p : list) points[size++] = p;
+        }
+    };
+
+    namespace detail {
+        inline bool sameDirection(const glm::vec3& a, const glm::vec3& b) { return glm::dot(a, b) > 0.0f; }
+
+        inline bool line(Simplex& s, glm::vec3& d) {
+            const glm::vec3 a = s.points[0], b = s.points[1];
+            const glm::vec3 ab = b - a, ao = -a;
+            if (sameDirection(ab, ao)) d = glm::cross(glm::cross(ab, ao), ab);
+            else { s.set({ a }); d = ao; }
+            return glm::dot(d, d) < 1e-12f;    // origin on the segment
+        }
+
+        inline bool triangle(Simplex& s, glm::vec3& d) {
+            const glm::vec3 a = s.points[0], b = s.points[1], c = s.points[2];
+            const glm::vec3 ab = b - a, ac = c - a, ao = -a;
+            const glm::vec3 abc = glm::cross(ab, ac);
+
+            if (sameDirection(glm::cross(abc, ac), ao)) {
+                if (sameDirection(ac, ao)) { s.set({ a, c }); d = glm::cross(glm::cross(ac, ao), ac); return glm::dot(d, d) < 1e-12f; }
+                s.set({ a, b });
+                return line(s, d);
+            }
+            if (sameDirection(glm::cross(ab, abc), ao)) {
+                s.set({ a, b });
+                return line(s, d);
+            }
+            const float side = glm::dot(abc, ao);
+            if (side > 0.0f) d = abc;
+            else { s.set({ a, c, b }); d = -abc; }
+            return false;
+        }
+
+        inline bool tetrahedron(Simplex& s, glm::vec3& d) {
+            const glm::vec3 a = s.points[0], b = s.points[1], c = s.points[2], e = s.points[3];
+            const glm::vec3 ab = b - a, ac = c - a, ae = e - a, ao = -a;
+            if (sameDirection(glm::cross(ab, ac), ao)) { s.set({ a, b, c }); return triangle(s, d); }
+            if (sameDirection(glm::cross(ac, ae), ao)) { s.set({ a, c, e }); return triangle(s, d); }
+            if (sameDirection(glm::cross(ae, ab), ao)) { s.set({ a, e, b }); return triangle(s, d); }
+            return true;
+        }
+
+        // Reduces the simplex to the feature nearest the origin and points d at the origin.
+        // Returns true once the simplex encloses (or touches) the origin.
+        inline bool nextSimplex(Simplex& s, glm::vec3& d) {
+            switch (s.size) {
+            case 2: return line(s, d);
+            case 3: return triangle(s, d);
+            case 4: return tetrahedron(s, d);
+            }
+            return false;
+        }
+    }
+
+    // True if the shapes overlap; `simplex` then encloses the origin for EPA.
+    // `direction` is the first search direction and receives the last one, so passing
+    // the value from the previous step (a separating axis, for shapes still apart)
+    // usually settles the query with one support call.
+    template<typename Support>
+    bool intersect(const Support& support, glm::vec3& direction, Simplex& simplex, int maxIterations = 32) {
+        glm::vec3 d = glm::dot(direction, direction) > 1e-12f ? direction : glm::vec3(1.0f, 0.0f, 0.0f);
+        simplex.size = 0;
+        simplex.push(support(d));
+        d = -simplex.points[0];
+
+        for (int it = 0; it < maxIterations; ++it) {
+            if (glm::dot(d, d) < 1e-12f) { direction = -simplex.points[0]; return true; }   // origin on a vertex
+            const glm::vec3 a = support(d);
+            if (glm::dot(a, d) < 0.0f) {
+                direction = d;      // separating axis
+                return false;
+            }
+            simplex.push(a);
+            if (detail::nextSimplex(simplex, d)) {
+                direction = d;
+                return true;
+            }
+        }
+        direction = d;
+        return false;
+    }
+
+    namespace detail {
+        // GJK stops early when the origin lies on a segment or triangle of the simplex
+        // (axis-aligned shapes at the same height do that). EPA needs a tetrahedron, so
+        // grow the simplex by support points off its line / plane.
+        template<typename Support>
+        bool completeSimplex(const Support& support, Simplex& s) {
+            if (s.size == 2) {
+                const glm::vec3 ab = s.points[1] - s.points[0];
+                const glm::vec3 axis = std::abs(ab.x) < std::abs(ab.y)
+                    ? (std::abs(ab.x) < std::abs(ab.z) ? glm::vec3(1, 0, 0) : glm::vec3(0, 0, 1))
+                    : (std::abs(ab.y) < std::abs(ab.z) ? glm::vec3(0, 1, 0) : glm::vec3(0, 0, 1));
+                const glm::vec3 side = glm::cross(ab, axis);
+                for (const glm::vec3& d : { side, -side, glm::cross(ab, side), -glm::cross(ab, side) }) {
+                    const glm::vec3 p = support(d);
+                    if (glm::length(glm::cross(p - s.points[0], ab)) > 1e-6f * glm::dot(ab, ab)) { s.points[s.size++] = p; break; }
+                }
+                if (s.size < 3) return false;
+            }
+            if (s.size == 3) {
+                const glm::vec3 n = glm::cross(s.points[1] - s.points[0], s.points[2] - s.points[0]);
+                for (const glm::vec3& d : { n, -n }) {
+                    const glm::vec3 p = support(d);
+                    if (std::abs(glm::dot(p - s.points[0], n)) > 1e-6f * glm::dot(n, n)) { s.points[s.size++] = p; break; }
+                }
+            }
+            return s.size == 4;
+        }
+    }
+
+    // Penetration depth and normal from an enclosing simplex. `normal` points from A into B:
+    // moving A by -normal * depth (or B by +normal * depth) separates them.
+    // Returns false for a degenerate simplex (shapes just touching).
+    // The polytope lives in fixed buffers on the stack; if it would outgrow them, the
+    // closest face so far is returned.
+    template<typename Support>
+    bool penetration(const Support& support, Simplex simplex, glm::vec3& normal, float& depth,
+        int maxIterations = 48, float tolerance = 1e-4f) {
+        if (simplex.size < 2 || (simplex.size < 4 && !detail::completeSimplex(support, simplex))) return false;
+
+        constexpr int MAX_VERTICES = 64;
+        constexpr int MAX_FACES = 128;
+        constexpr int MAX_EDGES = 96;
+        struct Face {
+            int a, b, c;
+            glm::vec3 n;
+            float distance;
+        };
+        glm::vec3 vertices[MAX_VERTICES];
+        Face faces[MAX_FACES];
+        int edges[MAX_EDGES][2];
+        int vertexCount = 4, faceCount = 0, edgeCount = 0;
+        for (int i = 0; i < 4; ++i) vertices[i] = simplex.points[i];
+        // Stays inside the polytope as it grows; the origin may sit on its surface
+        const glm::vec3 inside = (vertices[0] + vertices[1] + vertices[2] + vertices[3]) * 0.25f;
+
+        // Outward faces
+        auto addFace = [&](int a, int b, int c) {
+            glm::vec3 n = glm::cross(vertices[b] - vertices[a], vertices[c] - vertices[a]);
+            float length = glm::length(n);
+            if (length < 1e-12f || faceCount == MAX_FACES) return;
+            n /= length;
+            if (glm::dot(n, vertices[a] - inside) < 0.0f) { n = -n; std::swap(b, c); }
+            faces[faceCount++] = Face{ a, b, c, n, std::max(glm::dot(n, vertices[a]), 0.0f) };
+        };
+        addFace(0, 1, 2);
+        addFace(0, 3, 1);
+        addFace(0, 2, 3);
+        addFace(1, 3, 2);
+        if (faceCount < 4) return false;
+
+        for (int it = 0;; ++it) {
+            int closest = 0;
+            for (int f = 1; f < faceCount; ++f)
+                if (faces[f].distance < faces[closest].distance) closest = f;
+            const Face face = faces[closest];
+            normal = face.n;
+            depth = face.distance;
+
+            const glm::vec3 p = support(face.n);
+            const float reach = glm::dot(p, face.n);
+            if (reach - face.distance < tolerance * std::max(1.0f, reach) || it == maxIterations - 1
+                || vertexCount == MAX_VERTICES) return true;
+
+            // Remove every face that sees p, keeping the edges around the hole
+            const int pi = vertexCount;
+            vertices[vertexCount++] = p;
+            edgeCount = 0;
+            for (int f = 0; f < faceCount;) {
+                const Face& fc = faces[f];
+                if (glm::dot(fc.n, p - vertices[fc.a]) <= 0.0f) { ++f; continue; }
+                const int loop[4] = { fc.a, fc.b, fc.c, fc.a };
+                for (int e = 0; e < 3; ++e) {
+                    int shared = -1;
+                    for (int k = 0; k < edgeCount; ++k)
+                        if (edges[k][0] == loop[e + 1] && edges[k][1] == loop[e]) { shared = k; break; }
+                    if (shared >= 0) {      // between two removed faces
+                        --edgeCount;
+                        edges[shared][0] = edges[edgeCount][0];
+                        edges[shared][1] = edges[edgeCount][1];
+                    }
+                    else if (edgeCount < MAX_EDGES) {
+                        edges[edgeCount][0] = loop[e];
+                        edges[edgeCount][1] = loop[e + 1];
+                        ++edgeCount;
+                    }
+                }
+                faces[f] = faces[--faceCount];
+            }
+            for (int e = 0; e < edgeCount; ++e) addFace(edges[e][0], edges[e][1], pi);
+            if (faceCount == 0) return false;
+        }
+    }
+}
@@ -0,0 +1,195 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "ShaderProgram.hpp"
+#include "Particles.hpp"
+
+// Matches Particle in assets/shaders/particles_*.comp
+struct GpuParticle {
+    glm::vec4 positionLife;     // xyz = position, w = seconds left
+    glm::vec4 velocity;
+};
+
+// Matches Request in assets/shaders/particles_emit.comp
+struct GpuEmitRequest {
+    glm::vec4 origin;
+    glm::uvec4 range;           // x = first new particle of the request, y = count
+};
+
+// Matches State in the compute shaders: the draw command the GPU writes, followed by the
+// dispatch command for the next update
+struct GpuParticleState {
+    GLuint drawCount = 0;       // DrawArraysIndirectCommand
+    GLuint instanceCount = 1;
+    GLuint first = 0;
+    GLuint baseInstance = 0;
+    GLuint groupsX = 0;         // DispatchIndirectCommand
+    GLuint groupsY = 1;
+    GLuint groupsZ = 1;
+    GLuint alive = 0;           // particles in the source buffer
+};
+
+// Particles::Backend::Gpu: sparks simulated by compute shaders in two shader storage
+// buffers used in turn. Each update() integrates the source buffer and appends the
+// survivors to the target (an atomic counter in the state buffer), then appends the
+// queued emit requests; the counter is the vertex count of an indirect draw. The CPU
+// never reads particles back, and uploads only the emit requests.
+// Needs OpenGL 4.3 (compute shaders, storage buffers, indirect dispatch) and direct
+// state access (ARB_direct_state_access, core in 4.5) for the buffers.
+class GpuParticles {
+public:
+    static constexpr GLuint CAPACITY = 1u << 20;
+    static constexpr GLuint GROUP_SIZE = 256;       // local_size_x of the compute shaders
+    static constexpr size_t MAX_REQUESTS = 4096;    // per emit dispatch
+
+    GpuParticles() = default;
+    GpuParticles(const GpuParticles&) = delete;
+    GpuParticles& operator=(const GpuParticles&) = delete;
+
+    ~GpuParticles() {
+        if (stateBuffer != 0) glDeleteBuffers(1, &stateBuffer);
+        if (requestBuffer != 0) glDeleteBuffers(1, &requestBuffer);
+        if (particleBuffers[0] != 0) glDeleteBuffers(2, particleBuffers);
+        if (vao != 0) glDeleteVertexArrays(1, &vao);
+        counters.clear();
+        simulate.clear();
+        emit.clear();
+        drawShader.clear();
+    }
+
+    bool ready() const { return stateBuffer != 0; }
+
+    // Compiles the shaders and allocates the buffers; false where compute is unsupported
+    bool init() {
+        if (ready()) return true;
+        if (!GLEW_VERSION_4_3 || !GLEW_ARB_direct_state_access) {
+            std::cerr << "GPU particles need OpenGL 4.3 and direct state access" << std::endl;
+            return false;
+        }
+        counters = ShaderProgram("assets/shaders/particles_counters.comp");
+        simulate = ShaderProgram("assets/shaders/particles_update.comp");
+        emit = ShaderProgram("assets/shaders/particles_emit.comp");
+        drawShader = ShaderProgram("assets/shaders/particles_gpu.vert", "assets/shaders/particles_gpu.frag");
+
+        glCreateBuffers(2, particleBuffers);
+        for (GLuint b : particleBuffers) glNamedBufferData(b, CAPACITY * sizeof(GpuParticle), nullptr, GL_DYNAMIC_COPY);
+        glCreateBuffers(1, &stateBuffer);
+        const GpuParticleState empty;
+        glNamedBufferData(stateBuffer, sizeof(GpuParticleState), &empty, GL_DYNAMIC_COPY);
+        glCreateBuffers(1, &requestBuffer);
+        glNamedBufferData(requestBuffer, MAX_REQUESTS * sizeof(GpuEmitRequest), nullptr, GL_STREAM_DRAW);
+        glCreateVertexArrays(1, &vao);  // vertices come from the storage buffer
+        std::cout << "Note: GPU particles: " << CAPACITY << " max" << std::endl;
+        return true;
+    }
+
+    void clear() {
+        if (!ready()) return;
+        const GpuParticleState empty;
+        glNamedBufferSubData(stateBuffer, 0, sizeof(GpuParticleState), &empty);
+    }
+
+    // Once per rendered frame: applies the time and spawns the simulation queued in
+    // Particles since the last call
+    void update() {
+        if (!ready()) return;
+        const float dt = Particles::gpuTime;
+        Particles::gpuTime = 0.0f;
+        if (dt <= 0.0f && Particles::emitQueue.empty()) return;
+
+        const GLuint source = particleBuffers[current], target = particleBuffers[current ^ 1];
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, stateBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, source);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, target);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, requestBuffer);
+        glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, stateBuffer);
+
+        runCounters(0);
+
+        simulate.activate();
+        simulate.setUniform("uDt", dt);
+        glDispatchComputeIndirect(offsetof(GpuParticleState, groupsX));
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+        emitQueued();
+        runCounters(1);
+
+        glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, 0);
+        glUseProgram(0);
+        current ^= 1;
+    }
+
+    void draw(const glm::mat4& projection, const glm::mat4& view) {
+        if (!ready()) return;
+        drawShader.activate();
+        drawShader.setUniform("uMVP", projection * view);
+        drawShader.setUniform("color", glm::vec4(1, 0.7f, 0.2f, 1)); // orange sparks
+
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, particleBuffers[current]);
+        glBindVertexArray(vao);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, stateBuffer);
+        glPointSize(5.0f);
+        glDrawArraysIndirect(GL_POINTS, nullptr);   // the command is at the start of the state
+
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        glBindVertexArray(0);
+    }
+
+private:
+    ShaderProgram counters;
+    ShaderProgram simulate;
+    ShaderProgram emit;
+    ShaderProgram drawShader;
+    GLuint particleBuffers[2] = { 0, 0 };
+    GLuint stateBuffer = 0;
+    GLuint requestBuffer = 0;
+    GLuint vao = 0;
+    GLuint current = 0;         // buffer holding the particles to draw
+    uint32_t seed = 0;
+    std::vector<GpuEmitRequest> requests;
+
+    // 0: turns the last count into this update's dispatch; 1: clamps the new count
+    void runCounters(int mode) {
+        counters.activate();
+        counters.setUniform("uMode", mode);
+        counters.setUniform("uCapacity", static_cast<int>(CAPACITY));
+        counters.setUniform("uGroupSize", static_cast<int>(GROUP_SIZE));
+        glDispatchCompute(1, 1, 1);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+    }
+
+    // Requests beyond what the buffer can hold are dropped, like full CPU spawns
+    void emitQueued() {
+        std::vector<Particles::EmitRequest>& queue = Particles::emitQueue;
+        size_t next = 0;
+        while (next < queue.size()) {
+            requests.clear();
+            GLuint total = 0;
+            for (; next < queue.size() && requests.size() < MAX_REQUESTS && total < CAPACITY; ++next) {
+                const GLuint count = std::min(queue[next].count, CAPACITY - total);
+                if (count == 0) continue;
+                requests.push_back(GpuEmitRequest{ glm::vec4(queue[next].origin, 1.0f), glm::uvec4(total, count, 0, 0) });
+                total += count;
+            }
+            if (total == 0) break;
+
+            glNamedBufferSubData(requestBuffer, 0, requests.size() * sizeof(GpuEmitRequest), requests.data());
+            emit.activate();
+            emit.setUniform("uRequests", static_cast<int>(requests.size()));
+            emit.setUniform("uTotal", static_cast<int>(total));
+            emit.setUniform("uSeed", static_cast<int>(++seed));
+            emit.setUniform("uCapacity", static_cast<int>(CAPACITY));
+            glDispatchCompute((total + GROUP_SIZE - 1) / GROUP_SIZE, 1, 1);
+            glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+            if (total == CAPACITY) break;
+        }
+        queue.clear();
+    }
+};
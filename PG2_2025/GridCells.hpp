@@ -0,0 +1,21 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+// Cell coordinates and bucket hashing shared by the uniform grids (SpatialHash,
+// NeighbourGrid), so both map positions to cells the same way.
+namespace GridCells {
+
+    // Keeps cell coordinates well inside int range for positions far from the origin
+    constexpr float MAX_CELL = 1 << 20;
+
+    inline int32_t cellOf(float v, float inverseCellSize) {
+        return static_cast<int32_t>(std::floor(std::clamp(v * inverseCellSize, -MAX_CELL, MAX_CELL)));
+    }
+
+    inline uint32_t hashCell(int32_t x, int32_t y, int32_t z) {
+        return (static_cast<uint32_t>(x) * 73856093u) ^ (static_cast<uint32_t>(y) * 19349663u) ^ (static_cast<uint32_t>(z) * 83492791u);
+    }
+}
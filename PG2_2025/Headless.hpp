@@ -0,0 +1,146 @@
+#pragma once
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <thread>
+#include <random>
+#include <string>
+#include <cstdlib>
+#include <opencv2/opencv.hpp>
+#include <glm/glm.hpp>
+
+#include "World.hpp"
+#include "Model.hpp"
+#include "mapgen.hpp"
+#include "ScriptedBehaviors.hpp"
+
+struct HeadlessSettings {
+    size_t entities = 2000;
+    uint64_t steps = 3600;          // 0 = run until killed
+    bool realtime = false;          // false: as fast as possible, true: one step per World::STEP
+    unsigned int threads = std::thread::hardware_concurrency();
+    unsigned int seed = 1;
+    std::string heightmap = "assets/heights.png";
+    float heightScale = 50.0f;
+    double reportSeconds = 1.0;
+};
+
+// Simulation without a window or GL context: terrain heights, entities, behaviors,
+// scripts, collisions and particles. Run with:
+//   PG2_2025.exe --headless [--entities N] [--steps N] [--threads N] [--seed N] [--realtime]
+namespace Headless {
+
+    using Clock = std::chrono::steady_clock;
+
+    inline HeadlessSettings parseArgs(int argc, char* argv[]) {
+        HeadlessSettings settings;
+        for (int i = 2; i < argc; ++i) {
+            std::string arg = argv[i];
+            bool hasValue = i + 1 < argc;
+            if (arg == "--entities" && hasValue) settings.entities = std::strtoull(argv[++i], nullptr, 10);
+            else if (arg == "--steps" && hasValue) settings.steps = std::strtoull(argv[++i], nullptr, 10);
+            else if (arg == "--threads" && hasValue) settings.threads = std::atoi(argv[++i]);
+            else if (arg == "--seed" && hasValue) settings.seed = std::atoi(argv[++i]);
+            else if (arg == "--heightmap" && hasValue) settings.heightmap = argv[++i];
+            else if (arg == "--realtime") settings.realtime = true;
+            else std::cerr << "Unknown headless option: " << arg << std::endl;
+        }
+        return settings;
+    }
+
+    // Same kind of scene as App::init_assets, scaled to `count` entities
+    inline void populate(World& world, const HeadlessSettings& settings, std::vector<Model*>& models) {
+        std::mt19937 rng(settings.seed);
+        glm::vec2 lo = world.terrain.minXZ(), hi = world.terrain.maxXZ();
+        std::uniform_real_distribution<float> x(lo.x, hi.x), z(lo.y, hi.y), unit(0.0f, 1.0f);
+
+        world.entities.reserve(settings.entities);
+        for (size_t i = 0; i < settings.entities; ++i) {
+            glm::vec3 p(x(rng), 0.0f, z(rng));
+            p.y = world.terrain.getHeight(p) + 5.0f;
+            EntityHandle h = world.entities.create(p, models[i % models.size()]);
+
+            switch (i % 4) {
+            case 0:
+                world.behaviorSystems.walkInCircle.add(h, p, 10.0f + 40.0f * unit(rng), 1.0f + unit(rng));
+                world.behaviorSystems.periodicJump.add(h, 7.0f, 2.0f + unit(rng) * 2.0f);
+                break;
+            case 1:
+                world.scripts.start(h, ScriptedBehaviors::PeriodicJump(8.0f, 2.0f + unit(rng) * 3.0f));
+                break;
+            case 2:
+                world.scripts.start(h, ScriptedBehaviors::Patrol({ p, p + glm::vec3(30.0f, 0.0f, 0.0f), p + glm::vec3(0.0f, 0.0f, 30.0f) }));
+                break;
+            default:
+                break; // idle, falls asleep once landed
+            }
+        }
+    }
+
+    inline int run(const HeadlessSettings& settings) {
+        cv::Mat hmap = cv::imread(settings.heightmap, cv::IMREAD_GRAYSCALE);
+        if (hmap.empty()) {
+            throw std::runtime_error("ERR: Height map empty? File: " + settings.heightmap);
+        }
+
+        World world(settings.threads);
+        world.terrain = MapGen::GenHeightField(hmap, 5, settings.heightScale);
+        world.buildNavigation();
+
+        // Geometry and bounds only, collisions need nothing else
+        std::vector<Model*> models = {
+            new Model("assets/obj/teapot_tri_vnt.obj"),
+            new Model("assets/obj/fish.obj"),
+        };
+        populate(world, settings, models);
+
+        std::cout << "Headless: " << world.entities.size() << " entities, " << settings.threads << " threads, "
+            << (settings.realtime ? "real time" : "max speed") << std::endl;
+
+        const float dt = World::STEP;
+        const auto stepDuration = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(dt));
+        auto start = Clock::now();
+        auto reportStart = start;
+        auto nextStep = start;
+        uint64_t entitySteps = 0, reportEntitySteps = 0, reportSteps = 0;
+
+        for (uint64_t step = 0; settings.steps == 0 || step < settings.steps; ++step) {
+            world.entities.beginStep();
+            world.step(dt, glm::vec3(0.0f));
+
+            // Entities that actually ran this step (awake and due)
+            uint64_t ticked = world.scheduler.getStats().ticked;
+            entitySteps += ticked;
+            reportEntitySteps += ticked;
+            ++reportSteps;
+
+            auto now = Clock::now();
+            double sinceReport = std::chrono::duration<double>(now - reportStart).count();
+            if (sinceReport >= settings.reportSeconds) {
+                const UpdateSchedulerStats& stats = world.scheduler.getStats();
+                std::cout << "  step " << step + 1 << ": " << std::fixed << std::setprecision(0)
+                    << reportSteps / sinceReport << " steps/s, "
+                    << reportEntitySteps / sinceReport << " entity-steps/s, "
+                    << stats.awake << " awake, " << stats.sleeping << " sleeping, "
+                    << world.scripts.running() << " scripts" << std::endl;
+                reportStart = now;
+                reportEntitySteps = 0;
+                reportSteps = 0;
+            }
+
+            if (settings.realtime) {
+                nextStep += stepDuration;
+                std::this_thread::sleep_until(nextStep);
+            }
+        }
+
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        std::cout << "Headless finished: " << settings.steps << " steps in " << std::setprecision(2) << seconds << " s, "
+            << std::setprecision(0) << settings.steps / seconds << " steps/s, "
+            << entitySteps / seconds << " entity-steps/s" << std::endl;
+
+        for (Model* m : models) delete m;
+        return EXIT_SUCCESS;
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <glm/glm.hpp>
+
+// CPU-side copy of the terrain grid. Heights are stored at the same sample points
+// MapGen::GenHeightMap uses for mesh vertices, and getHeight() interpolates over the
+// same two triangles per quad, so queries match the rendered surface exactly.
+struct HeightField {
+    int cols = 0;           // grid points along X
+    int rows = 0;           // grid points along Z
+    float step = 1.0f;      // world distance between grid points
+    float xOffset = 0.0f;   // world x = i * step - xOffset
+    float zOffset = 0.0f;   // world z = j * step - zOffset
+    std::vector<float> heights;
+
+    bool empty() const { return heights.empty(); }
+
+    float at(int i, int j) const {
+        i = std::clamp(i, 0, cols - 1);
+        j = std::clamp(j, 0, rows - 1);
+        return heights[static_cast<size_t>(j) * cols + i];
+    }
+
+    glm::vec3 gridToWorld(int i, int j) const {
+        return glm::vec3(i * step - xOffset, at(i, j), j * step - zOffset);
+    }
+
+    float getHeight(float x, float z) const {
+        if (empty()) return 0.0f;
+
+        float gx = std::clamp((x + xOffset) / step, 0.0f, static_cast<float>(cols - 1));
+        float gz = std::clamp((z + zOffset) / step, 0.0f, static_cast<float>(rows - 1));
+        int i = std::min(static_cast<int>(gx), cols - 2);
+        int j = std::min(static_cast<int>(gz), rows - 2);
+        float fx = gx - i;
+        float fz = gz - j;
+
+        float h0 = at(i, j);
+        float h1 = at(i + 1, j);
+        float h2 = at(i + 1, j + 1);
+        float h3 = at(i, j + 1);
+
+        // Quads are split p0-p1-p2 / p0-p2-p3 (see MapGen::GenHeightMap)
+        if (fx >= fz)
+            return h0 + fx * (h1 - h0) + fz * (h2 - h1);
+        return h0 + fz * (h3 - h0) + fx * (h2 - h3);
+    }
+
+    float getHeight(const glm::vec3& position) const {
+        return getHeight(position.x, position.z);
+    }
+
+    glm::vec3 getNormal(float x, float z) const {
+        float e = step;
+        float hl = getHeight(x - e, z);
+        float hr = getHeight(x + e, z);
+        float hd = getHeight(x, z - e);
+        float hu = getHeight(x, z + e);
+        return glm::normalize(glm::vec3(hl - hr, 2.0f * e, hd - hu));
+    }
+
+    // Slope as the angle from vertical, in degrees
+    float getSlope(float x, float z) const {
+        return glm::degrees(std::acos(std::clamp(getNormal(x, z).y, -1.0f, 1.0f)));
+    }
+
+    glm::vec2 minXZ() const { return glm::vec2(-xOffset, -zOffset); }
+    glm::vec2 maxXZ() const { return glm::vec2((cols - 1) * step - xOffset, (rows - 1) * step - zOffset); }
+};
@@ -0,0 +1,291 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <unordered_map>
+#include <glm/glm.hpp>
+
+#include "NavGrid.hpp"
+#include "JobSystem.hpp"
+
+// Hierarchical A* (HPA*) over a NavGrid.
+// The grid is cut into square clusters. Where two neighbouring clusters share an open
+// stretch of border, portals are placed (one in the middle of a short stretch, one at
+// each end of a long one); each portal is a pair of abstract nodes, one cell on either
+// side. Nodes of the same cluster are linked by the cost of the best path between them
+// inside the cluster, precomputed at build time.
+//
+// A query links start and goal to the nodes of their clusters, runs A* over that small
+// graph, then refines each abstract edge with grid A* inside one cluster. Paths are
+// within a few percent of optimal and cost a fraction of a full-grid search.
+// Queries only read the graph, so any number can run at once, each with its own Scratch.
+class HierarchicalPathfinder {
+public:
+    using Cell = NavGrid::Cell;
+
+    struct Scratch {
+        NavGrid::Scratch grid;
+        std::vector<float> g;
+        std::vector<uint32_t> parent;
+        std::vector<uint32_t> visited;
+        std::vector<uint32_t> closed;
+        std::vector<std::pair<float, uint32_t>> open;
+        std::vector<std::pair<uint32_t, float>> startLinks, goalLinks;
+        std::vector<uint32_t> abstractPath;
+        std::vector<Cell> segment;
+        uint32_t search = 0;
+    };
+
+    struct Stats {
+        size_t clusters = 0;
+        size_t nodes = 0;
+        size_t edges = 0;
+    };
+
+    void build(const NavGrid& navGrid, int size = 16, JobSystem* jobs = nullptr) {
+        grid = &navGrid;
+        clusterSize = std::max(4, size);
+        clustersX = (grid->width() + clusterSize - 1) / clusterSize;
+        clustersY = (grid->height() + clusterSize - 1) / clusterSize;
+        nodeCells.clear();
+        clusterNodes.assign(static_cast<size_t>(clustersX) * clustersY, {});
+        nodeOfCell.clear();
+
+        // Portals and the edges across them
+        std::vector<Edge> edges;
+        auto addPortal = [&](Cell a, Cell b) {
+            const uint32_t na = nodeAt(a), nb = nodeAt(b);
+            const float cost = grid->moveCost(a, b);
+            edges.push_back(Edge{ na, nb, cost });
+            edges.push_back(Edge{ nb, na, cost });
+        };
+        for (int cy = 0; cy < clustersY; ++cy) {
+            for (int cx = 0; cx < clustersX; ++cx) {
+                const NavGrid::Window w = window(cx, cy);
+                if (cx + 1 < clustersX) {
+                    scanBorder(w.minJ, w.maxJ, [&](int j) { return grid->cell(w.maxI, j); },
+                        [&](int j) { return grid->cell(w.maxI + 1, j); }, addPortal);
+                }
+                if (cy + 1 < clustersY) {
+                    scanBorder(w.minI, w.maxI, [&](int i) { return grid->cell(i, w.maxJ); },
+                        [&](int i) { return grid->cell(i, w.maxJ + 1); }, addPortal);
+                }
+            }
+        }
+
+        // Edges inside each cluster: grid A* between every pair of its nodes
+        const size_t clusters = clusterNodes.size();
+        std::vector<std::vector<Edge>> inner(clusters);
+        std::vector<NavGrid::Scratch> scratch(jobs ? jobs->threadCount() : 1);
+        auto linkClusters = [&](size_t begin, size_t end, size_t) {
+            NavGrid::Scratch& s = scratch[jobs ? jobs->currentThread() : 0];
+            for (size_t k = begin; k < end; ++k) {
+                const std::vector<uint32_t>& nodes = clusterNodes[k];
+                const NavGrid::Window w = window(static_cast<int>(k % clustersX), static_cast<int>(k / clustersX));
+                for (size_t a = 0; a < nodes.size(); ++a) {
+                    for (size_t b = a + 1; b < nodes.size(); ++b) {
+                        const float cost = grid->findPath(nodeCells[nodes[a]], nodeCells[nodes[b]], w, s);
+                        if (cost < 0.0f) continue;
+                        inner[k].push_back(Edge{ nodes[a], nodes[b], cost });
+                        inner[k].push_back(Edge{ nodes[b], nodes[a], cost });
+                    }
+                }
+            }
+        };
+        if (jobs) jobs->parallelFor(clusters, 4, linkClusters);
+        else linkClusters(0, clusters, 0);
+        for (const std::vector<Edge>& e : inner) edges.insert(edges.end(), e.begin(), e.end());
+
+        // Adjacency in one array, grouped by source node
+        const size_t nodes = nodeCells.size();
+        edgeStart.assign(nodes + 1, 0);
+        for (const Edge& e : edges) ++edgeStart[e.from + 1];
+        for (size_t n = 0; n < nodes; ++n) edgeStart[n + 1] += edgeStart[n];
+        edgeTargets.resize(edges.size());
+        edgeCosts.resize(edges.size());
+        std::vector<uint32_t> fill(edgeStart.begin(), edgeStart.end() - 1);
+        for (const Edge& e : edges) {
+            edgeTargets[fill[e.from]] = e.to;
+            edgeCosts[fill[e.from]++] = e.cost;
+        }
+
+        stats.clusters = clusters;
+        stats.nodes = nodes;
+        stats.edges = edges.size();
+    }
+
+    bool empty() const { return grid == nullptr; }
+    const Stats& getStats() const { return stats; }
+
+    // Path between two world positions as cells, smoothed (see NavGrid::smooth). Start
+    // and goal snap to the nearest walkable cell. False if there is no path.
+    bool findPath(const glm::vec3& from, const glm::vec3& to, Scratch& s, std::vector<Cell>& path) const {
+        path.clear();
+        if (!grid) return false;
+        const Cell start = grid->nearestWalkable(grid->cellAt(from));
+        const Cell goal = grid->nearestWalkable(grid->cellAt(to));
+        if (start == NavGrid::NONE || goal == NavGrid::NONE) return false;
+
+        const uint32_t startCluster = clusterOf(start), goalCluster = clusterOf(goal);
+        if (startCluster == goalCluster && grid->findPath(start, goal, clusterWindow(startCluster), s.grid, &path) >= 0.0f) {
+            grid->smooth(path);
+            return true;
+        }
+
+        // Temporary links from the start and to the goal
+        link(start, startCluster, s, s.startLinks);
+        link(goal, goalCluster, s, s.goalLinks);
+        if (s.startLinks.empty() || s.goalLinks.empty()) return false;
+        if (!searchAbstract(goal, s)) return false;
+
+        // Refine: start -> nodes... -> goal, one cluster-bounded search per abstract edge
+        path.push_back(start);
+        Cell previous = start;
+        auto append = [&](Cell next) {
+            if (next == previous) return true;
+            if (clusterOf(previous) != clusterOf(next)) {
+                path.push_back(next);       // across a portal: neighbouring cells
+            }
+            else {
+                if (grid->findPath(previous, next, clusterWindow(clusterOf(next)), s.grid, &s.segment) < 0.0f) return false;
+                path.insert(path.end(), s.segment.begin() + 1, s.segment.end());
+            }
+            previous = next;
+            return true;
+        };
+        for (uint32_t node : s.abstractPath) {
+            if (!append(nodeCells[node])) return false;
+        }
+        if (!append(goal)) return false;
+        grid->smooth(path);
+        return true;
+    }
+
+private:
+    struct Edge {
+        uint32_t from, to;
+        float cost;
+    };
+
+    NavGrid::Window window(int cx, int cy) const {
+        return NavGrid::Window{ cx * clusterSize, cy * clusterSize,
+            std::min(grid->width(), (cx + 1) * clusterSize) - 1, std::min(grid->height(), (cy + 1) * clusterSize) - 1 };
+    }
+    NavGrid::Window clusterWindow(uint32_t cluster) const {
+        return window(static_cast<int>(cluster % clustersX), static_cast<int>(cluster / clustersX));
+    }
+    uint32_t clusterOf(Cell c) const {
+        return static_cast<uint32_t>((grid->row(c) / clusterSize) * clustersX + grid->column(c) / clusterSize);
+    }
+
+    uint32_t nodeAt(Cell c) {
+        auto [it, added] = nodeOfCell.try_emplace(c, static_cast<uint32_t>(nodeCells.size()));
+        if (added) {
+            nodeCells.push_back(c);
+            clusterNodes[clusterOf(c)].push_back(it->second);
+        }
+        return it->second;
+    }
+
+    // Open stretches along one border (cells a(t) | b(t) for t in [first, last])
+    template<typename SideA, typename SideB, typename AddPortal>
+    void scanBorder(int first, int last, SideA a, SideB b, AddPortal& addPortal) {
+        int runStart = -1;
+        for (int t = first; t <= last + 1; ++t) {
+            const bool open = t <= last && grid->walkable(a(t)) && grid->walkable(b(t));
+            if (open && runStart < 0) runStart = t;
+            if (open || runStart < 0) continue;
+            const int runEnd = t - 1;
+            if (runEnd - runStart + 1 >= LONG_ENTRANCE) {
+                addPortal(a(runStart), b(runStart));
+                addPortal(a(runEnd), b(runEnd));
+            }
+            else {
+                const int middle = (runStart + runEnd) / 2;
+                addPortal(a(middle), b(middle));
+            }
+            runStart = -1;
+        }
+    }
+
+    // Costs from a cell to the nodes of its cluster
+    void link(Cell c, uint32_t cluster, Scratch& s, std::vector<std::pair<uint32_t, float>>& links) const {
+        links.clear();
+        const NavGrid::Window w = clusterWindow(cluster);
+        for (uint32_t node : clusterNodes[cluster]) {
+            const float cost = grid->findPath(c, nodeCells[node], w, s.grid);
+            if (cost >= 0.0f) links.emplace_back(node, cost);
+        }
+    }
+
+    // A* over the abstract graph from the start links to the goal links; fills
+    // s.abstractPath with the nodes in between
+    bool searchAbstract(Cell goal, Scratch& s) const {
+        const size_t nodes = nodeCells.size();
+        if (s.g.size() != nodes) {
+            s.g.assign(nodes, 0.0f);
+            s.parent.assign(nodes, UINT32_MAX);
+            s.visited.assign(nodes, 0);
+            s.closed.assign(nodes, 0);
+            s.search = 0;
+        }
+        const uint32_t search = ++s.search;
+        auto greater = [](const std::pair<float, uint32_t>& a, const std::pair<float, uint32_t>& b) {
+            return a.first != b.first ? a.first > b.first : a.second > b.second;
+        };
+        s.open.clear();
+        for (auto [node, cost] : s.startLinks) {
+            s.visited[node] = search;
+            s.g[node] = cost;
+            s.parent[node] = UINT32_MAX;
+            s.open.emplace_back(cost + grid->estimate(nodeCells[node], goal), node);
+        }
+        std::make_heap(s.open.begin(), s.open.end(), greater);
+
+        float best = -1.0f;
+        uint32_t bestNode = UINT32_MAX;
+        while (!s.open.empty()) {
+            std::pop_heap(s.open.begin(), s.open.end(), greater);
+            const auto [f, n] = s.open.back();
+            s.open.pop_back();
+            if (s.closed[n] == search) continue;
+            if (best >= 0.0f && f >= best) break;
+            s.closed[n] = search;
+
+            for (auto [node, cost] : s.goalLinks) {
+                if (node == n && (best < 0.0f || s.g[n] + cost < best)) { best = s.g[n] + cost; bestNode = n; }
+            }
+            for (uint32_t e = edgeStart[n]; e < edgeStart[n + 1]; ++e) {
+                const uint32_t m = edgeTargets[e];
+                if (s.closed[m] == search) continue;
+                const float g = s.g[n] + edgeCosts[e];
+                if (s.visited[m] == search && g >= s.g[m]) continue;
+                s.visited[m] = search;
+                s.g[m] = g;
+                s.parent[m] = n;
+                s.open.emplace_back(g + grid->estimate(nodeCells[m], goal), m);
+                std::push_heap(s.open.begin(), s.open.end(), greater);
+            }
+        }
+        if (bestNode == UINT32_MAX) return false;
+        s.abstractPath.clear();
+        for (uint32_t n = bestNode; n != UINT32_MAX; n = s.parent[n]) s.abstractPath.push_back(n);
+        std::reverse(s.abstractPath.begin(), s.abstractPath.end());
+        return true;
+    }
+
+    static constexpr int LONG_ENTRANCE = 6;     // stretches this long get a portal at each end
+
+    const NavGrid* grid = nullptr;
+    int clusterSize = 16;
+    int clustersX = 0;
+    int clustersY = 0;
+    std::vector<Cell> nodeCells;                        // by node
+    std::vector<std::vector<uint32_t>> clusterNodes;    // by cluster
+    std::unordered_map<Cell, uint32_t> nodeOfCell;
+    std::vector<uint32_t> edgeStart;                    // by node, into edgeTargets / edgeCosts
+    std::vector<uint32_t> edgeTargets;
+    std::vector<float> edgeCosts;
+    Stats stats;
+};
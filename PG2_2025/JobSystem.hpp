@@ -0,0 +1,190 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <algorithm>
+
+// Work-stealing thread pool.
+// Every worker owns a deque: it pops its own work from the back and, when empty,
+// steals from the front of the other deques. The thread calling parallelFor() takes
+// part as worker 0, so a pool of N threads starts N - 1 extra threads. Threads from
+// outside the pool take turns submitting, so at most one of them is worker 0 at a time.
+class JobSystem {
+public:
+    using RangeFn = std::function<void(size_t begin, size_t end, size_t chunk)>;
+
+    explicit JobSystem(unsigned int threads = std::thread::hardware_concurrency()) {
+        threads = std::max(1u, threads);
+        queues.reserve(threads);
+        for (unsigned int i = 0; i < threads; ++i) {
+            queues.push_back(std::make_unique<Queue>());
+        }
+        for (unsigned int i = 1; i < threads; ++i) {
+            workers.emplace_back([this, i]() { workerLoop(i); });
+        }
+    }
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    ~JobSystem() {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            quit = true;
+        }
+        wake.notify_all();
+        for (auto& w : workers) w.join();
+    }
+
+    unsigned int threadCount() const { return static_cast<unsigned int>(queues.size()); }
+
+    // Index of the calling thread inside this pool, below threadCount(): the worker's own
+    // index, 0 for the submitting thread. For per-thread buffers inside a parallelFor().
+    unsigned int currentThread() const { return owner == this ? threadIndex : 0; }
+
+    // Splits [0, count) into fixed-size chunks and blocks until all of them ran.
+    // Chunk boundaries depend only on count and chunkSize, never on the thread count,
+    // so per-chunk results can be merged deterministically.
+    void parallelFor(size_t count, size_t chunkSize, const RangeFn& fn) {
+        if (count == 0) return;
+        if (owner == this) {    // one of our workers, or nested inside a submission
+            dispatch(count, chunkSize, fn);
+            return;
+        }
+        std::lock_guard<std::mutex> lock(submitMutex);
+        struct Enter {
+            const JobSystem* pool;
+            unsigned int index;
+            Enter(const JobSystem* self) : pool(owner), index(threadIndex) { owner = self; threadIndex = 0; }
+            ~Enter() { owner = pool; threadIndex = index; }
+        } enter(this);
+        dispatch(count, chunkSize, fn);
+    }
+
+private:
+    void dispatch(size_t count, size_t chunkSize, const RangeFn& fn) {
+        chunkSize = std::max<size_t>(1, chunkSize);
+        size_t chunks = (count + chunkSize - 1) / chunkSize;
+
+        if (chunks == 1 || queues.size() == 1) {
+            for (size_t c = 0; c < chunks; ++c) {
+                fn(c * chunkSize, std::min(count, (c + 1) * chunkSize), c);
+            }
+            return;
+        }
+
+        Batch batch{ &fn, count, chunkSize, {} };
+        batch.remaining = chunks;
+
+        // Deal contiguous runs of chunks to each queue, thieves balance the rest
+        size_t perQueue = (chunks + queues.size() - 1) / queues.size();
+        for (size_t q = 0; q < queues.size(); ++q) {
+            size_t first = q * perQueue;
+            size_t last = std::min(chunks, first + perQueue);
+            if (first >= last) break;
+            std::lock_guard<std::mutex> lock(queues[q]->mutex);
+            for (size_t c = first; c < last; ++c) {
+                queues[q]->tasks.push_back(Task{ &batch, c });
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            ++generation;
+        }
+        wake.notify_all();
+
+        // Help until the whole batch is done
+        const unsigned int self = threadIndex;
+        while (batch.remaining.load(std::memory_order_acquire) > 0) {
+            Task task;
+            if (pop(self, task) || steal(self, task)) {
+                run(task);
+            }
+            else {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    struct Batch {
+        const RangeFn* fn;
+        size_t count;
+        size_t chunkSize;
+        std::atomic<size_t> remaining;
+    };
+
+    struct Task {
+        Batch* batch = nullptr;
+        size_t chunk = 0;
+    };
+
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    std::mutex submitMutex;
+    uint64_t generation = 0;
+    bool quit = false;
+
+    // The pool the calling thread works for right now and its index in it
+    static inline thread_local const JobSystem* owner = nullptr;
+    static inline thread_local unsigned int threadIndex = 0;
+
+    static void run(const Task& task) {
+        Batch& b = *task.batch;
+        size_t begin = task.chunk * b.chunkSize;
+        size_t end = std::min(b.count, begin + b.chunkSize);
+        (*b.fn)(begin, end, task.chunk);
+        b.remaining.fetch_sub(1, std::memory_order_acq_rel);
+    }
+
+    bool pop(unsigned int q, Task& out) {
+        std::lock_guard<std::mutex> lock(queues[q]->mutex);
+        if (queues[q]->tasks.empty()) return false;
+        out = queues[q]->tasks.back();
+        queues[q]->tasks.pop_back();
+        return true;
+    }
+
+    bool steal(unsigned int self, Task& out) {
+        for (size_t k = 1; k < queues.size(); ++k) {
+            Queue& victim = *queues[(self + k) % queues.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                out = victim.tasks.front();
+                victim.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void workerLoop(unsigned int index) {
+        owner = this;
+        threadIndex = index;
+        uint64_t seen = 0;
+        while (true) {
+            Task task;
+            if (pop(index, task) || steal(index, task)) {
+                run(task);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            wake.wait(lock, [&]() { return quit || generation != seen; });
+            if (quit) return;
+            seen = generation;
+        }
+    }
+};
@@ -95,12 +95,33 @@ public:
         cacheUniformLocations();
     }
 
+    // Geometry only, no GL objects (headless simulation). draw() is a no-op.
+    Mesh(GLenum primitive_type,
+        std::vector<Vertex> const& vertices,
+        std::vector<GLuint> const& indices,
+        glm::vec3 const& origin, glm::vec3 const& orientation)
+        : primitive_type(primitive_type),
+        vertices(vertices),
+        indices(indices),
+        origin(origin),
+        orientation(orientation) {
+    }
+
 
     void draw(const glm::mat4& projection, const glm::mat4& view,
         const std::vector<LightSource*> lights,
         const glm::vec3& offset = glm::vec3(0.0f),
         const glm::vec3& rotation = glm::vec3(0.0f),
         const float alpha = 1.0f) {
+        glm::quat q = glm::quat(glm::radians(rotation));
+        glm::mat4 model = glm::translate(glm::mat4(1.0f), origin + offset) * glm::mat4_cast(q);
+        draw(projection, view, lights, model, alpha);
+    }
+
+    // Draw with a ready model matrix (e.g. from a TransformHierarchy)
+    void draw(const glm::mat4& projection, const glm::mat4& view,
+        const std::vector<LightSource*>& lights,
+        const glm::mat4& model, const float alpha = 1.0f) {
         if (VAO == 0) {
             std::cerr << "VAO not initialized!\n";
             return;
@@ -114,9 +135,6 @@ public:
         }
 
         // === TRANSFORMS ===
-        glm::quat q = glm::quat(glm::radians(rotation));
-        glm::mat4 rotationMatrix = glm::mat4_cast(q);
-        glm::mat4 model = glm::translate(glm::mat4(1.0f), origin + offset) * rotationMatrix;
         glm::mat4 mvp = projection * view * model;
 
         // === UNIFORMS ===
@@ -133,7 +151,7 @@ public:
         glUniform1f(uniforms.shininess, 32.0f);
 
         // Pass camera position (reverse-transform from view matrix)
-        glm::vec3 cameraPosition = glm::vec3(glm::inverse(view)[3]);
+        glm::vec3 cameraPosition = eyePosition(view);
         glUniform3fv(uniforms.viewPos, 1, glm::value_ptr(cameraPosition));
 
         // Texture binding
@@ -148,6 +166,47 @@ public:
         glBindVertexArray(0);
     }
 
+    // Instanced draw; per-instance transforms are read by the shader from the SSBO bound
+    // at binding 0, indexed by gl_BaseInstance + gl_InstanceID
+    void drawInstanced(const glm::mat4& projection, const glm::mat4& view,
+        const std::vector<LightSource*>& lights,
+        GLsizei instanceCount, GLuint baseInstance) {
+        if (VAO == 0 || instanceCount <= 0) return;
+
+        shader.activate();
+
+        glm::mat4 model = glm::translate(glm::mat4(1.0f), origin);
+        glm::mat4 viewProjection = projection * view;
+        glUniformMatrix4fv(uniforms.uMVP, 1, GL_FALSE, glm::value_ptr(viewProjection));
+        glUniformMatrix4fv(uniforms.uModel, 1, GL_FALSE, glm::value_ptr(model));
+        glUniform1f(uniforms.alpha, 1.0f);
+
+        applyLights(lights);
+
+        glUniform3f(uniforms.ambientColor, 0.2f, 0.2f, 0.2f);
+        glUniform3f(uniforms.diffuseColor, 0.8f, 0.8f, 0.8f);
+        glUniform3f(uniforms.specularColor, 1.0f, 1.0f, 1.0f);
+        glUniform1f(uniforms.shininess, 32.0f);
+
+        glm::vec3 cameraPosition = eyePosition(view);
+        glUniform3fv(uniforms.viewPos, 1, glm::value_ptr(cameraPosition));
+
+        if (texture_id > 0) {
+            glBindTextureUnit(0, texture_id);
+            glUniform1i(uniforms.tex0, 0);
+        }
+
+        glBindVertexArray(VAO);
+        glDrawElementsInstancedBaseInstance(primitive_type, static_cast<GLsizei>(indices.size()), GL_UNSIGNED_INT,
+            nullptr, instanceCount, baseInstance);
+        glBindVertexArray(0);
+    }
+
+    // Eye position of a rigid view matrix (rotation + translation), without a full inverse
+    static glm::vec3 eyePosition(const glm::mat4& view) {
+        return -glm::transpose(glm::mat3(view)) * glm::vec3(view[3]);
+    }
+
 	void applyLights(const std::vector<LightSource*>& lights) {
         // Lights
         int dirIndex = 0, spotIndex = 0, pointIndex = 0;
@@ -177,6 +236,17 @@ public:
         glUniform1i(uniforms.numPointLights, pointIndex);
 	}
 
+    // Re-upload CPU-side vertex data (same size as at construction)
+    void uploadVertices() {
+        if (VBO == 0) return;
+        glNamedBufferSubData(VBO, 0, vertices.size() * sizeof(Vertex), vertices.data());
+    }
+
+    void setShader(ShaderProgram& newShader) {
+        shader = newShader;
+        cacheUniformLocations();
+    }
+
     std::vector<Vertex> uniqueVertices;
     void getUniques() {
         for (const auto& v : vertices) {
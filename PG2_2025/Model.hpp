@@ -14,6 +14,8 @@
 #include "ShaderProgram.hpp"
 #include "OBJloader.hpp"
 #include "LightSource.hpp"
+#include "ConvexHull.hpp"
+#include "TriangleBVH.hpp"
 
 class Model {
 public:
@@ -30,13 +32,39 @@ public:
     glm::vec3 boundingBoxMax;
     float boundingSphereRadius;
 
+    // Collision shape in mesh space: place it at entity position + origin, rotated like the mesh.
+    // Models without one collide as their axis-aligned bounding box.
+    static constexpr size_t HULL_VERTICES = 32;
+    ConvexHull hull;
+
+    // Triangle BVH in mesh space (same placement as the hull) for exact ray queries.
+    // Built on a worker thread while loading continues, or read from "<model>.bvh".
+    // Null for models without a mesh; waits for the build if it is still running.
+    const TriangleBVH* triangleBVH() const {
+        return bvh.valid() ? bvh.get().get() : nullptr;
+    }
+
+    // For stand-ins without a mesh file (benchmarks)
+    void setTriangleBVH(std::shared_ptr<const TriangleBVH> tree) {
+        std::promise<std::shared_ptr<const TriangleBVH>> ready;
+        ready.set_value(std::move(tree));
+        bvh = ready.get_future().share();
+    }
 
     // Constructor
     Model(const std::filesystem::path& filename, ShaderProgram& shader)
         : shader(shader) {
-        loadModel(filename);
+        loadModel(filename, true);
     }
 
+    // Geometry and bounds only, no GL context needed (headless simulation)
+    explicit Model(const std::filesystem::path& filename) {
+        loadModel(filename, false);
+    }
+
+    // No mesh; set boundingBoxMin/Max by hand (collision-only stand-ins, benchmarks)
+    Model() = default;
+
     // Delete Copy Constructor & Assignment
     Model(const Model&) = delete;
     Model& operator=(const Model&) = delete;
@@ -47,7 +75,9 @@ public:
         name(std::move(other.name)),
         origin(other.origin),
         orientation(other.orientation),
-        shader(other.shader) { // No std::move() for references!
+        shader(other.shader),
+        hull(std::move(other.hull)),
+        bvh(std::move(other.bvh)) { // No std::move() for references!
     }
 
     // chybl inicializtor
@@ -60,6 +90,8 @@ public:
             origin = other.origin;
             orientation = other.orientation;
             shader = std::move(other.shader);
+            hull = std::move(other.hull);
+            bvh = std::move(other.bvh);
         }
         return *this;
     }
@@ -85,10 +117,47 @@ public:
         }
     }
 
+    // Draw with a ready matrix that places the model's pivot (entities put it at
+    // position + origin, turned by their yaw; see App::syncEntityTransforms)
+    void draw(const glm::mat4& projection, const glm::mat4& view, const std::vector<LightSource*>& lights,
+        const glm::mat4& pivot) {
+        std::lock_guard<std::mutex> lock(load_mutex);
+
+        glUseProgram(shader.getID());
+
+        if (texture_id != 0) {
+            glBindTextureUnit(0, texture_id);
+            glUniform1i(glGetUniformLocation(shader.getID(), "tex0"), 0);
+        }
+
+        const glm::mat4 model = orientation == glm::vec3(0.0f) ? pivot : pivot * glm::mat4_cast(glm::quat(glm::radians(orientation)));
+        for (auto& mesh : meshes) {
+            mesh.draw(projection, view, lights, model, alpha);
+        }
+    }
+
+    void drawInstanced(const glm::mat4& projection, const glm::mat4& view, const std::vector<LightSource*>& lights,
+        GLsizei instanceCount, GLuint baseInstance) {
+        std::lock_guard<std::mutex> lock(load_mutex);
+
+        glUseProgram(shader.getID());
+
+        if (texture_id != 0) {
+            glBindTextureUnit(0, texture_id);
+            glUniform1i(glGetUniformLocation(shader.getID(), "tex0"), 0);
+        }
+
+        for (auto& mesh : meshes) {
+            mesh.drawInstanced(projection, view, lights, instanceCount, baseInstance);
+        }
+    }
+
 private:
-    void loadModel(const std::filesystem::path& path) {
+    std::shared_future<std::shared_ptr<const TriangleBVH>> bvh;
+
+    void loadModel(const std::filesystem::path& path, bool gpu) {
         // Check if the shader is valid before using it
-        if (!glIsProgram(shader.getID())) {
+        if (gpu && !glIsProgram(shader.getID())) {
             std::cerr << "Error: Shader program is invalid in loadModel!\n";
             return;
         }
@@ -142,6 +211,13 @@ private:
 
         boundingBoxMin = minBB;
         boundingBoxMax = maxBB;
+        hull = ConvexHull::build(vertices, HULL_VERTICES);
+        std::cout << "   Collision hull: " << hull.points.size() << " vertices" << std::endl;
+        std::filesystem::path cachePath = path;
+        cachePath += ".bvh";
+        bvh = std::async(std::launch::async, [positions = vertices, triangles = indices, cachePath]() {
+            return TriangleBVH::loadOrBuild(positions, triangles, cachePath);
+        }).share();
         std::cout << "Y offset: " << minBB.y << std::endl;
 
         // Compute origin shift so the model "stands" on the ground and is centered horizontally
@@ -159,6 +235,11 @@ private:
             return;
         }
 
-        meshes.emplace_back(GL_TRIANGLES, shader, vertexData, indices, origin, orientation);
+        if (gpu) {
+            meshes.emplace_back(GL_TRIANGLES, shader, vertexData, indices, origin, orientation);
+        }
+        else {
+            meshes.emplace_back(GL_TRIANGLES, vertexData, indices, origin, orientation);
+        }
     }
 };
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <cstdint>
+
+using NameId = uint32_t;
+
+// Interned strings. Each distinct string is stored once and identified by a small
+// integer, so names can be kept and compared without hashing a std::string each time.
+// Ids are dense (0, 1, 2, ...) and never reused.
+class NameTable {
+public:
+    static constexpr NameId NONE = UINT32_MAX;
+
+    NameId intern(std::string_view name) {
+        auto it = ids.find(name);
+        if (it != ids.end()) return it->second;
+
+        NameId id = static_cast<NameId>(strings.size());
+        strings.emplace_back(name);        // deque: existing strings never move
+        ids.emplace(strings.back(), id);
+        return id;
+    }
+
+    // NONE if the name was never interned
+    NameId find(std::string_view name) const {
+        auto it = ids.find(name);
+        return it != ids.end() ? it->second : NONE;
+    }
+
+    std::string_view str(NameId id) const {
+        return id < strings.size() ? std::string_view(strings[id]) : std::string_view();
+    }
+
+    size_t size() const { return strings.size(); }
+
+private:
+    std::deque<std::string> strings;
+    std::unordered_map<std::string_view, NameId> ids;
+};
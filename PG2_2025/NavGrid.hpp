@@ -0,0 +1,233 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <glm/glm.hpp>
+
+#include "HeightField.hpp"
+
+struct NavGridSettings {
+    float maxSlope = 35.0f;         // degrees from horizontal; steeper ground is blocked
+    float slopePenalty = 2.0f;      // extra cost per unit length on ground at maxSlope
+};
+
+// Walkable grid on the terrain samples (one cell per HeightField grid point).
+// Cells are blocked where the ground is too steep; walkable cells cost more the steeper
+// they are. Moves go to the 8 neighbours, diagonals only if both side cells are open
+// (no corner cutting). Edge costs are symmetric, so costs can be cached both ways.
+class NavGrid {
+public:
+    using Cell = uint32_t;
+    static constexpr Cell NONE = UINT32_MAX;
+
+    // Grid A* state, reusable between searches (one per thread). Entries are reset
+    // lazily by a search counter, so a search only touches the cells it visits.
+    struct Scratch {
+        std::vector<float> g;
+        std::vector<Cell> parent;
+        std::vector<uint32_t> visited;  // search counter when g was set
+        std::vector<uint32_t> closed;
+        std::vector<std::pair<float, Cell>> open;
+        uint32_t search = 0;
+    };
+
+    // Inclusive cell rectangle a search may use
+    struct Window {
+        int minI = 0, minJ = 0, maxI = 0, maxJ = 0;
+        bool contains(int i, int j) const { return i >= minI && i <= maxI && j >= minJ && j <= maxJ; }
+    };
+
+    void build(const HeightField& field, const NavGridSettings& navSettings = {}) {
+        settings = navSettings;
+        cols = field.cols;
+        rows = field.rows;
+        step = field.step;
+        xOffset = field.xOffset;
+        zOffset = field.zOffset;
+        heights = field.heights;
+        costs.assign(size(), 0.0f);
+        for (int j = 0; j < rows; ++j) {
+            for (int i = 0; i < cols; ++i) {
+                // Central differences over the neighbouring samples
+                const float dx = (field.at(i + 1, j) - field.at(i - 1, j)) / ((std::min(i + 1, cols - 1) - std::max(i - 1, 0)) * step);
+                const float dz = (field.at(i, j + 1) - field.at(i, j - 1)) / ((std::min(j + 1, rows - 1) - std::max(j - 1, 0)) * step);
+                const float slope = glm::degrees(std::atan(std::sqrt(dx * dx + dz * dz)));
+                costs[cell(i, j)] = slope > settings.maxSlope ? 0.0f : 1.0f + settings.slopePenalty * slope / settings.maxSlope;
+            }
+        }
+    }
+
+    bool empty() const { return costs.empty(); }
+    size_t size() const { return static_cast<size_t>(cols) * rows; }
+    int width() const { return cols; }
+    int height() const { return rows; }
+
+    Cell cell(int i, int j) const { return static_cast<Cell>(j) * cols + i; }
+    int column(Cell c) const { return static_cast<int>(c % cols); }
+    int row(Cell c) const { return static_cast<int>(c / cols); }
+
+    bool walkable(int i, int j) const { return i >= 0 && j >= 0 && i < cols && j < rows && costs[cell(i, j)] > 0.0f; }
+    bool walkable(Cell c) const { return costs[c] > 0.0f; }
+
+    // Nearest cell to a world position (clamped to the grid)
+    Cell cellAt(const glm::vec3& p) const {
+        const int i = std::clamp(static_cast<int>(std::lround((p.x + xOffset) / step)), 0, cols - 1);
+        const int j = std::clamp(static_cast<int>(std::lround((p.z + zOffset) / step)), 0, rows - 1);
+        return cell(i, j);
+    }
+
+    glm::vec3 position(Cell c) const {
+        return glm::vec3(column(c) * step - xOffset, heights[c], row(c) * step - zOffset);
+    }
+
+    // Closest walkable cell within `radius` cells (rings outward), NONE if there is none
+    Cell nearestWalkable(Cell c, int radius = 4) const {
+        if (walkable(c)) return c;
+        const int ci = column(c), cj = row(c);
+        for (int r = 1; r <= radius; ++r) {
+            Cell best = NONE;
+            int bestDistance = INT32_MAX;
+            for (int j = cj - r; j <= cj + r; ++j) {
+                for (int i = ci - r; i <= ci + r; ++i) {
+                    if (std::max(std::abs(i - ci), std::abs(j - cj)) != r || !walkable(i, j)) continue;
+                    const int d = (i - ci) * (i - ci) + (j - cj) * (j - cj);
+                    if (d < bestDistance) { bestDistance = d; best = cell(i, j); }
+                }
+            }
+            if (best != NONE) return best;
+        }
+        return NONE;
+    }
+
+    // Cost of the move between two neighbouring cells
+    float moveCost(Cell a, Cell b) const {
+        const bool diagonal = column(a) != column(b) && row(a) != row(b);
+        return (diagonal ? DIAGONAL : 1.0f) * 0.5f * (costs[a] + costs[b]);
+    }
+
+    // Lower bound of the cost between two cells (every walkable cell costs at least 1)
+    float estimate(Cell a, Cell b) const {
+        const int di = std::abs(column(a) - column(b)), dj = std::abs(row(a) - row(b));
+        return static_cast<float>(std::max(di, dj)) + (DIAGONAL - 1.0f) * static_cast<float>(std::min(di, dj));
+    }
+
+    // Calls fn(neighbour) for every cell reachable in one move from c
+    template<typename Fn>
+    void forEachNeighbour(Cell c, Fn&& fn) const {
+        const int i = column(c), j = row(c);
+        const bool left = walkable(i - 1, j), right = walkable(i + 1, j);
+        const bool down = walkable(i, j - 1), up = walkable(i, j + 1);
+        if (left) fn(cell(i - 1, j));
+        if (right) fn(cell(i + 1, j));
+        if (down) fn(cell(i, j - 1));
+        if (up) fn(cell(i, j + 1));
+        if (left && down && walkable(i - 1, j - 1)) fn(cell(i - 1, j - 1));
+        if (right && down && walkable(i + 1, j - 1)) fn(cell(i + 1, j - 1));
+        if (left && up && walkable(i - 1, j + 1)) fn(cell(i - 1, j + 1));
+        if (right && up && walkable(i + 1, j + 1)) fn(cell(i + 1, j + 1));
+    }
+
+    Window whole() const { return Window{ 0, 0, cols - 1, rows - 1 }; }
+
+    // A* between two walkable cells inside `window`. Returns the path cost, or a negative
+    // value if the goal cannot be reached there. `path` (optional) receives the cells
+    // from start to goal.
+    float findPath(Cell start, Cell goal, const Window& window, Scratch& s, std::vector<Cell>* path = nullptr) const {
+        if (!walkable(start) || !walkable(goal)) return -1.0f;
+        if (s.g.size() != size()) {
+            s.g.assign(size(), 0.0f);
+            s.parent.assign(size(), NONE);
+            s.visited.assign(size(), 0);
+            s.closed.assign(size(), 0);
+            s.search = 0;
+        }
+        const uint32_t search = ++s.search;
+        auto greater = [](const std::pair<float, Cell>& a, const std::pair<float, Cell>& b) {
+            return a.first != b.first ? a.first > b.first : a.second > b.second;
+        };
+        s.open.clear();
+        s.g[start] = 0.0f;
+        s.parent[start] = NONE;
+        s.visited[start] = search;
+        s.open.emplace_back(estimate(start, goal), start);
+
+        while (!s.open.empty()) {
+            std::pop_heap(s.open.begin(), s.open.end(), greater);
+            const Cell c = s.open.back().second;
+            s.open.pop_back();
+            if (s.closed[c] == search) continue;
+            s.closed[c] = search;
+            if (c == goal) {
+                if (path) {
+                    path->clear();
+                    for (Cell p = goal; p != NONE; p = s.parent[p]) path->push_back(p);
+                    std::reverse(path->begin(), path->end());
+                }
+                return s.g[goal];
+            }
+            forEachNeighbour(c, [&](Cell n) {
+                if (!window.contains(column(n), row(n)) || s.closed[n] == search) return;
+                const float g = s.g[c] + moveCost(c, n);
+                if (s.visited[n] == search && g >= s.g[n]) return;
+                s.visited[n] = search;
+                s.g[n] = g;
+                s.parent[n] = c;
+                s.open.emplace_back(g + estimate(n, goal), n);
+                std::push_heap(s.open.begin(), s.open.end(), greater);
+            });
+        }
+        return -1.0f;
+    }
+
+    // True if the straight line between two cell centres only crosses walkable cells
+    // (and never squeezes diagonally between two blocked ones)
+    bool lineOfSight(Cell a, Cell b) const {
+        int i = column(a), j = row(a);
+        const int ti = column(b), tj = row(b);
+        const int di = std::abs(ti - i), dj = std::abs(tj - j);
+        const int si = ti > i ? 1 : -1, sj = tj > j ? 1 : -1;
+        int error = di - dj;
+        while (i != ti || j != tj) {
+            const int e2 = 2 * error;
+            const bool stepI = e2 > -dj, stepJ = e2 < di;
+            if (stepI && stepJ && (!walkable(i + si, j) || !walkable(i, j + sj))) return false;
+            if (stepI) { error -= dj; i += si; }
+            if (stepJ) { error += di; j += sj; }
+            if (!walkable(i, j)) return false;
+        }
+        return true;
+    }
+
+    // Drops cells a straight walk can skip (looking at most `lookahead` cells ahead)
+    void smooth(std::vector<Cell>& path, size_t lookahead = 32) const {
+        if (path.size() < 3) return;
+        std::vector<Cell> out{ path.front() };
+        size_t anchor = 0;
+        while (anchor + 1 < path.size()) {
+            size_t next = anchor + 1;
+            const size_t last = std::min(path.size() - 1, anchor + lookahead);
+            for (size_t k = last; k > anchor + 1; --k) {
+                if (lineOfSight(path[anchor], path[k])) { next = k; break; }
+            }
+            out.push_back(path[next]);
+            anchor = next;
+        }
+        path.swap(out);
+    }
+
+    float cellSize() const { return step; }
+
+private:
+    static constexpr float DIAGONAL = 1.41421356f;
+
+    NavGridSettings settings;
+    int cols = 0;
+    int rows = 0;
+    float step = 1.0f;
+    float xOffset = 0.0f;
+    float zOffset = 0.0f;
+    std::vector<float> heights;
+    std::vector<float> costs;       // 0 = blocked
+};
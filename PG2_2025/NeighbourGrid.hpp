@@ -0,0 +1,133 @@
+#pragma once
+
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+#include "FastMath.hpp"
+#include "GridCells.hpp"
+
+// Points binned into a hashed uniform grid, rebuilt from scratch every step, for
+// nearest-neighbour queries within a fixed radius (the cell size).
+//
+//     grid.build(positions, count, radius);
+//     grid.nearest(p, self, k, scratch, out);
+//
+// Points are counting-sorted by bucket and their coordinates copied in that order, so a
+// query scans each of the 27 (9 if planar) surrounding cells as one contiguous run and
+// computes distances 4 at a time (FastMath::distanceSquared).
+// Build is serial and queries only read, so any number of threads can query at once;
+// results depend only on the input order.
+class NeighbourGrid {
+public:
+    static constexpr size_t MAX_NEIGHBOURS = 32;
+
+    // Per-thread query state
+    struct Scratch {
+        std::vector<float> distances;
+        std::array<uint32_t, 27> buckets{};
+    };
+
+    struct Neighbour {
+        uint32_t point;     // index in the order given to build()
+        float distance2;
+    };
+
+    // `planar`: ignore heights when binning and measuring (crowds on the ground)
+    void build(const glm::vec3* positions, size_t count, float radius, bool planar = false) {
+        cellSize = std::max(radius, 1e-3f);
+        inverseCellSize = 1.0f / cellSize;
+        flat = planar;
+
+        size_t tableSize = 1;
+        while (tableSize < count * 2) tableSize <<= 1;
+        mask = static_cast<uint32_t>(tableSize - 1);
+
+        keys.resize(count);
+        bucketStart.assign(tableSize + 1, 0);
+        for (size_t k = 0; k < count; ++k) {
+            const glm::vec3& p = positions[k];
+            keys[k] = GridCells::hashCell(cellOf(p.x), flat ? 0 : cellOf(p.y), cellOf(p.z)) & mask;
+            ++bucketStart[keys[k] + 1];
+        }
+        for (size_t b = 0; b < tableSize; ++b) bucketStart[b + 1] += bucketStart[b];
+
+        cursor.assign(bucketStart.begin(), bucketStart.end() - 1);
+        ids.resize(count);
+        xs.resize(count);
+        ys.resize(count);
+        zs.resize(count);
+        for (uint32_t k = 0; k < count; ++k) {
+            const uint32_t slot = cursor[keys[k]]++;
+            ids[slot] = k;
+            xs[slot] = positions[k].x;
+            ys[slot] = flat ? 0.0f : positions[k].y;
+            zs[slot] = positions[k].z;
+        }
+    }
+
+    size_t size() const { return ids.size(); }
+
+    // Up to `k` (<= MAX_NEIGHBOURS) nearest points within the radius of `p`, closest
+    // first, skipping point `self`. Returns the number found.
+    size_t nearest(const glm::vec3& p, uint32_t self, size_t k, Scratch& s, Neighbour* out) const {
+        k = std::min(k, MAX_NEIGHBOURS);
+        if (k == 0 || ids.empty()) return 0;
+        const float py = flat ? 0.0f : p.y;
+        const float radius2 = cellSize * cellSize;
+        const int32_t cx = cellOf(p.x), cy = flat ? 0 : cellOf(p.y), cz = cellOf(p.z);
+        const int32_t spanY = flat ? 0 : 1;
+
+        // Neighbouring cells can share a bucket; scan each bucket once
+        size_t bucketCount = 0;
+        for (int32_t dz = -1; dz <= 1; ++dz) {
+            for (int32_t dy = -spanY; dy <= spanY; ++dy) {
+                for (int32_t dx = -1; dx <= 1; ++dx) {
+                    const uint32_t b = GridCells::hashCell(cx + dx, cy + dy, cz + dz) & mask;
+                    if (std::find(s.buckets.begin(), s.buckets.begin() + bucketCount, b) == s.buckets.begin() + bucketCount) s.buckets[bucketCount++] = b;
+                }
+            }
+        }
+
+        size_t found = 0;
+        for (size_t n = 0; n < bucketCount; ++n) {
+            const uint32_t begin = bucketStart[s.buckets[n]], end = bucketStart[s.buckets[n] + 1];
+            if (begin == end) continue;
+            s.distances.resize(end - begin);
+            FastMath::distanceSquared(xs.data() + begin, ys.data() + begin, zs.data() + begin, p.x, py, p.z, s.distances.data(), end - begin);
+            for (uint32_t slot = begin; slot < end; ++slot) {
+                const float d2 = s.distances[slot - begin];
+                if (d2 > radius2 || ids[slot] == self) continue;
+                if (found == k && d2 >= out[k - 1].distance2) continue;
+
+                // Insertion into the sorted list; ties keep the point found first
+                size_t at = found < k ? found++ : k - 1;
+                while (at > 0 && out[at - 1].distance2 > d2) {
+                    out[at] = out[at - 1];
+                    --at;
+                }
+                out[at] = Neighbour{ ids[slot], d2 };
+            }
+        }
+        return found;
+    }
+
+private:
+    int32_t cellOf(float v) const { return GridCells::cellOf(v, inverseCellSize); }
+
+    float cellSize = 1.0f;
+    float inverseCellSize = 1.0f;
+    bool flat = false;
+    uint32_t mask = 0;
+
+    std::vector<uint32_t> keys;         // bucket by point
+    std::vector<uint32_t> bucketStart;  // first sorted slot of each bucket, plus the end
+    std::vector<uint32_t> cursor;
+
+    // By sorted slot
+    std::vector<uint32_t> ids;
+    std::vector<float> xs, ys, zs;
+};
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "ShaderProgram.hpp"
+#include "StreamBuffer.hpp"
+#include "JobSystem.hpp"
+#include "RadixSort.hpp"
+#include "Particles.hpp"
+
+// Per-instance attributes of assets/shaders/billboard.vert
+struct BillboardInstance {
+    glm::vec3 position;
+    float size;                 // world units, full width
+    uint32_t colour;            // RGBA8
+    float life;                 // seconds left
+};
+
+enum class BillboardBlend : uint8_t {
+    Additive,                   // any order: sparks, glows
+    Alpha,                      // sorted back to front: smoke, dust
+};
+
+struct BillboardSettings {
+    BillboardBlend blend = BillboardBlend::Additive;
+    float size = 0.3f;
+    glm::vec4 colour{ 1.0f, 0.7f, 0.2f, 1.0f };
+    float fadeTime = 0.5f;      // seconds of life over which a particle fades out
+    GLuint sprite = 0;          // texture, 0 for a soft round dot
+};
+
+// Camera-facing quads for the CPU particles: one instance per particle, written into the
+// frame's stream, expanded to a quad in the vertex shader (4 vertices per instance, no
+// index or corner buffers). Alpha blending draws them back to front, ordered by a radix
+// sort on view depth (parallel on the job system); additive blending skips the sort.
+class ParticleBillboards {
+public:
+    BillboardSettings settings;
+
+    ParticleBillboards() = default;
+    ParticleBillboards(const ParticleBillboards&) = delete;
+    ParticleBillboards& operator=(const ParticleBillboards&) = delete;
+
+    ~ParticleBillboards() {
+        if (vao != 0) glDeleteVertexArrays(1, &vao);
+        shader.clear();
+    }
+
+    void init() {
+        shader = ShaderProgram("assets/shaders/billboard.vert", "assets/shaders/billboard.frag");
+        glCreateVertexArrays(1, &vao);
+        const GLuint offsets[] = { offsetof(BillboardInstance, position), offsetof(BillboardInstance, size),
+            offsetof(BillboardInstance, colour), offsetof(BillboardInstance, life) };
+        for (GLuint a = 0; a < 4; ++a) {
+            glEnableVertexArrayAttrib(vao, a);
+            glVertexArrayAttribBinding(vao, a, 0);
+        }
+        glVertexArrayAttribFormat(vao, 0, 3, GL_FLOAT, GL_FALSE, offsets[0]);
+        glVertexArrayAttribFormat(vao, 1, 1, GL_FLOAT, GL_FALSE, offsets[1]);
+        glVertexArrayAttribFormat(vao, 2, 4, GL_UNSIGNED_BYTE, GL_TRUE, offsets[2]);
+        glVertexArrayAttribFormat(vao, 3, 1, GL_FLOAT, GL_FALSE, offsets[3]);
+        glVertexArrayBindingDivisor(vao, 0, 1);
+    }
+
+    bool ready() const { return vao != 0; }
+
+    void draw(const glm::mat4& projection, const glm::mat4& view, StreamBuffer& stream, JobSystem* jobs = nullptr) {
+        const Particles::Store& s = Particles::pool;
+        const size_t n = s.count;
+        if (!ready() || n == 0) return;
+
+        GLint first = 0;
+        BillboardInstance* out = stream.allocate<BillboardInstance>(n, first);
+        if (!out) return;
+
+        const glm::vec4 c = glm::clamp(settings.colour, 0.0f, 1.0f) * 255.0f + 0.5f;
+        const uint32_t colour = uint32_t(c.r) | (uint32_t(c.g) << 8) | (uint32_t(c.b) << 16) | (uint32_t(c.a) << 24);
+        const float size = settings.size;
+        auto write = [&](size_t k, uint32_t i) {
+            out[k] = BillboardInstance{ glm::vec3(s.px[i], s.py[i], s.pz[i]), size, colour, s.life[i] };
+        };
+
+        if (settings.blend == BillboardBlend::Alpha) {
+            // View-space z is negative in front of the camera: ascending z is back to front
+            keys.resize(n);
+            order.resize(n);
+            auto depth = [&](size_t begin, size_t end, size_t) {
+                for (size_t i = begin; i < end; ++i) {
+                    keys[i] = RadixSorter::floatKey(view[0][2] * s.px[i] + view[1][2] * s.py[i] + view[2][2] * s.pz[i] + view[3][2]);
+                    order[i] = static_cast<uint32_t>(i);
+                }
+            };
+            if (jobs) jobs->parallelFor(n, RadixSorter::CHUNK, depth);
+            else depth(0, n, 0);
+            sorter.sort(keys, order, jobs);
+
+            auto fill = [&](size_t begin, size_t end, size_t) { for (size_t k = begin; k < end; ++k) write(k, order[k]); };
+            if (jobs) jobs->parallelFor(n, RadixSorter::CHUNK, fill);
+            else fill(0, n, 0);
+        }
+        else {
+            auto fill = [&](size_t begin, size_t end, size_t) { for (size_t k = begin; k < end; ++k) write(k, static_cast<uint32_t>(k)); };
+            if (jobs) jobs->parallelFor(n, RadixSorter::CHUNK, fill);
+            else fill(0, n, 0);
+        }
+
+        shader.activate();
+        shader.setUniform("uViewProjection", projection * view);
+        shader.setUniform("uCameraRight", glm::vec3(view[0][0], view[1][0], view[2][0]));
+        shader.setUniform("uCameraUp", glm::vec3(view[0][1], view[1][1], view[2][1]));
+        shader.setUniform("uFadeTime", std::max(settings.fadeTime, 1e-3f));
+        shader.setUniform("uTextured", settings.sprite != 0 ? 1 : 0);
+        shader.setUniform("uSprite", 0);
+        if (settings.sprite != 0) glBindTextureUnit(0, settings.sprite);
+
+        // Tested against the scene's depth but not written, so overlapping quads all blend
+        glDepthMask(GL_FALSE);
+        if (settings.blend == BillboardBlend::Additive) glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+
+        glVertexArrayVertexBuffer(vao, 0, stream.id(), 0, sizeof(BillboardInstance));
+        glBindVertexArray(vao);
+        glDrawArraysInstancedBaseInstance(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(n), static_cast<GLuint>(first));
+        glBindVertexArray(0);
+
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glDepthMask(GL_TRUE);
+        shader.deactivate();
+    }
+
+private:
+    ShaderProgram shader;
+    GLuint vao = 0;
+    RadixSorter sorter;
+    std::vector<uint32_t> keys;     // by particle: view depth
+    std::vector<uint32_t> order;    // particles back to front
+};
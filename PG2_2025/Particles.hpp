@@ -1,85 +1,203 @@
 #pragma once
-#pragma once
 
 #include <glm/glm.hpp>
-#include <glm/gtc/random.hpp>
 #include <vector>
-#include "app.hpp"
-
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+#include "Snapshot.hpp"
+#include "JobSystem.hpp"
+#include "FastMath.hpp"
+
+// Sparks. Structure of arrays with the live particles packed at the front:
+// [0, count) are alive, a dying particle is replaced by the last one. update()
+// integrates only the live range (4 particles per SSE instruction) and spawn() appends,
+// so both cost what is alive or spawned, not the capacity.
 namespace Particles {
 
-    struct Particle {
-        glm::vec3 position;
-        glm::vec3 velocity;
-        float life = 1.0f;
-        bool active = false;
+    constexpr size_t MAX_PARTICLES = size_t(1) << 22;   // ~4M; arrays grow up to this on demand
+
+    struct Store {
+        std::vector<float> px, py, pz;
+        std::vector<float> vx, vy, vz;
+        std::vector<float> life;        // seconds left
+        size_t count = 0;
+
+        size_t capacity() const { return life.size(); }
+
+        void grow(size_t needed) {
+            size_t size = std::max<size_t>(1024, capacity());
+            while (size < needed) size *= 2;
+            size = std::min(size, MAX_PARTICLES);
+            for (std::vector<float>* a : { &px, &py, &pz, &vx, &vy, &vz, &life }) a->resize(size);
+        }
+
+        void clear() { count = 0; }
     };
 
-    constexpr int MAX_PARTICLES = 10000;
-    inline std::vector<Particle> pool(MAX_PARTICLES);
+    inline Store pool;
 
-    // Call this each frame
-    inline void update(float dt) {
-        for (auto& p : pool) {
-            if (!p.active) continue;
+    // Where sparks live. With Gpu, spawn() and update() only record what happened; the
+    // renderer hands that to GpuParticles, which owns the particles in GPU buffers.
+    enum class Backend : uint8_t { Cpu, Gpu };
+    inline Backend backend = Backend::Cpu;
 
-            p.position += p.velocity * dt;
-            p.life -= dt;
+    struct EmitRequest {
+        glm::vec3 origin;
+        uint32_t count;
+    };
 
-            if (p.life <= 0.0f) {
-                p.active = false;
-            }
-        }
+    inline std::vector<EmitRequest> emitQueue;  // Gpu: spawns not yet emitted
+    inline float gpuTime = 0.0f;                // Gpu: simulated time not yet applied
+
+    // Cpu <-> Gpu; the particles alive on the old side are dropped
+    inline void setBackend(Backend b) {
+        backend = b;
+        pool.clear();
+        emitQueue.clear();
+        gpuTime = 0.0f;
     }
 
-    // Call this to spawn sparks at a position
-    inline void spawn(const glm::vec3& origin, int count = 10) {
-        int spawned = 0;
-        for (auto& p : pool) {
-            if (!p.active) {
-                p.position = origin;
-                p.velocity = glm::sphericalRand(5.0f); // random 3D direction
-                p.life = 0.5f + static_cast<float>(rand()) / RAND_MAX; // 0.5s1.5s
-                p.active = true;
-                if (++spawned >= count) break;
-            }
+    // xorshift32, one per thread: spawning never shares state (or a lock) with rand()
+    struct Random {
+        uint32_t state = 0x9e3779b9u;
+
+        uint32_t next() {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            return state;
         }
-    }
 
-    // Call this in your render loop
-    inline void drawParticles(const glm::mat4& projection, const glm::mat4& view, ShaderProgram& shader) {
-        std::vector<glm::vec3> points;
-        for (const auto& p : pool) {
-            if (p.active) {
-                points.push_back(p.position);
-            }
+        // [0, 1)
+        float unit() { return static_cast<float>(next() >> 8) * (1.0f / 16777216.0f); }
+    };
+
+    inline thread_local Random threadRandom;
+
+    constexpr size_t UPDATE_CHUNK = 16384;
+
+    // Integration of [begin, end); no particle is added or removed here
+    inline void integrate(Store& s, size_t begin, size_t end, float dt) {
+        size_t i = begin;
+#ifdef PG2_SSE2
+        const __m128 step = _mm_set1_ps(dt);
+        for (; i + 4 <= end; i += 4) {
+            _mm_storeu_ps(&s.px[i], _mm_add_ps(_mm_loadu_ps(&s.px[i]), _mm_mul_ps(_mm_loadu_ps(&s.vx[i]), step)));
+            _mm_storeu_ps(&s.py[i], _mm_add_ps(_mm_loadu_ps(&s.py[i]), _mm_mul_ps(_mm_loadu_ps(&s.vy[i]), step)));
+            _mm_storeu_ps(&s.pz[i], _mm_add_ps(_mm_loadu_ps(&s.pz[i]), _mm_mul_ps(_mm_loadu_ps(&s.vz[i]), step)));
+            _mm_storeu_ps(&s.life[i], _mm_sub_ps(_mm_loadu_ps(&s.life[i]), step));
+        }
+#endif
+        for (; i < end; ++i) {
+            s.px[i] += s.vx[i] * dt;
+            s.py[i] += s.vy[i] * dt;
+            s.pz[i] += s.vz[i] * dt;
+            s.life[i] -= dt;
         }
+    }
 
-        if (points.empty()) return;
+    // Call this each frame. Large pools are integrated in parallel chunks; the dead are
+    // removed afterwards in one pass, so the result does not depend on the thread count.
+    inline void update(float dt, JobSystem* jobs = nullptr) {
+        if (backend == Backend::Gpu) {
+            gpuTime += dt;
+            return;
+        }
+        Store& s = pool;
+        if (jobs && s.count > UPDATE_CHUNK) {
+            jobs->parallelFor(s.count, UPDATE_CHUNK, [&](size_t begin, size_t end, size_t) { integrate(s, begin, end, dt); });
+        }
+        else {
+            integrate(s, 0, s.count, dt);
+        }
 
-        GLuint VAO = 0, VBO = 0;
-        glGenVertexArrays(1, &VAO);
-        glGenBuffers(1, &VBO);
+        for (size_t i = 0; i < s.count;) {
+            if (s.life[i] > 0.0f) { ++i; continue; }
+            const size_t last = --s.count;
+            s.px[i] = s.px[last]; s.py[i] = s.py[last]; s.pz[i] = s.pz[last];
+            s.vx[i] = s.vx[last]; s.vy[i] = s.vy[last]; s.vz[i] = s.vz[last];
+            s.life[i] = s.life[last];
+        }
+    }
 
-        glBindVertexArray(VAO);
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        glBufferData(GL_ARRAY_BUFFER, points.size() * sizeof(glm::vec3), points.data(), GL_STATIC_DRAW);
+    // Call this to spawn sparks at a position (dropped once the pool is full)
+    inline void spawn(const glm::vec3& origin, int count = 10) {
+        if (backend == Backend::Gpu) {
+            if (count > 0) emitQueue.push_back(EmitRequest{ origin, static_cast<uint32_t>(count) });
+            return;
+        }
+        Store& s = pool;
+        const size_t n = std::min(static_cast<size_t>(std::max(count, 0)), MAX_PARTICLES - s.count);
+        if (s.count + n > s.capacity()) s.grow(s.count + n);
+        Random& rng = threadRandom;
+        for (size_t i = s.count; i < s.count + n; ++i) {
+            // Uniform direction: height uniform in [-1, 1], angle around the vertical
+            const float z = 2.0f * rng.unit() - 1.0f;
+            const float r = std::sqrt(std::max(0.0f, 1.0f - z * z));
+            float sinA, cosA;
+            FastMath::sinCos(6.28318531f * rng.unit(), sinA, cosA);
+            s.px[i] = origin.x; s.py[i] = origin.y; s.pz[i] = origin.z;
+            s.vx[i] = 5.0f * r * cosA; s.vy[i] = 5.0f * r * sinA; s.vz[i] = 5.0f * z;
+            s.life[i] = 0.5f + rng.unit(); // 0.5s-1.5s
+        }
+        s.count += n;
+    }
 
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), nullptr);
+    // Cpu only: the GPU count is never read back
+    inline size_t activeCount() { return pool.count; }
 
-        shader.activate();
-        glm::mat4 model = glm::mat4(1.0f); // no rotation/translation
-        glm::mat4 mvp = projection * view * model;
+    inline void save(SnapshotWriter& w) {
+        const Store& s = pool;
+        w.beginSection(Snapshot::fourcc("PRTS"));
+        w.write(static_cast<uint64_t>(s.count));
+        for (const std::vector<float>* a : { &s.px, &s.py, &s.pz, &s.vx, &s.vy, &s.vz, &s.life }) {
+            w.writeBytes(a->data(), s.count * sizeof(float));
+        }
+        w.endSection();
+    }
 
-        shader.setUniform("uMVP", mvp);
-        shader.setUniform("color", glm::vec4(1, 0.7f, 0.2f, 1)); // orange sparks
+    // Reads the saved sparks into `s`; false if the snapshot has none (or they live on
+    // the GPU, where they are not saved and are kept as they are)
+    inline bool load(SnapshotReader& r, Store& s) {
+        if (backend == Backend::Gpu) return false;
+        if (r.openSection(Snapshot::fourcc("PRTS"))) {
+            const uint64_t count = r.read<uint64_t>();
+            if (count > MAX_PARTICLES) throw std::runtime_error("Snapshot: too many particles");
+            s.count = 0;
+            if (count > s.capacity()) s.grow(static_cast<size_t>(count));
+            for (std::vector<float>* a : { &s.px, &s.py, &s.pz, &s.vx, &s.vy, &s.vz, &s.life }) {
+                r.readBytes(a->data(), static_cast<size_t>(count) * sizeof(float));
+            }
+            s.count = static_cast<size_t>(count);
+            return true;
+        }
 
-        glPointSize(5.0f); // optional
-        glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(points.size()));
+        // Snapshots from before the SoA store: fixed pool of structs with an active flag
+        struct LegacyParticle {
+            glm::vec3 position;
+            glm::vec3 velocity;
+            float life;
+            bool active;
+        };
+        if (!r.openSection(Snapshot::fourcc("PART"))) return false;
+        std::vector<LegacyParticle> legacy;
+        r.readArray(legacy);
+        s.count = 0;
+        for (const LegacyParticle& p : legacy) {
+            if (!p.active) continue;
+            if (s.count == s.capacity()) s.grow(s.count + 1);
+            const size_t i = s.count++;
+            s.px[i] = p.position.x; s.py[i] = p.position.y; s.pz[i] = p.position.z;
+            s.vx[i] = p.velocity.x; s.vy[i] = p.velocity.y; s.vz[i] = p.velocity.z;
+            s.life[i] = p.life;
+        }
+        return true;
+    }
 
-        glBindVertexArray(0);
-        glDeleteBuffers(1, &VBO);
-        glDeleteVertexArrays(1, &VAO);
+    inline void load(SnapshotReader& r) {
+        Store s;
+        if (load(r, s)) pool = std::move(s);
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,240 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <cstdint>
+#include <algorithm>
+#include <unordered_map>
+#include <glm/glm.hpp>
+
+#include "HeightField.hpp"
+#include "NavGrid.hpp"
+#include "HierarchicalPathfinder.hpp"
+#include "FlowField.hpp"
+#include "JobSystem.hpp"
+
+struct PathServiceSettings {
+    NavGridSettings grid;
+    int clusterSize = 16;
+    size_t pathsPerStep = 16;           // searches run per update(); the rest wait
+    size_t flowFieldsPerStep = 1;
+    size_t flowFieldRequests = 16;      // waiting requests for one goal that earn it a flow field
+    size_t cachedFlowFields = 8;
+};
+
+struct PathServiceStats {
+    size_t pending = 0;         // still waiting after the last update
+    size_t paths = 0;           // searched in the last update
+    size_t failed = 0;
+    size_t flowFields = 0;      // built in the last update
+    size_t flowFieldHits = 0;   // requests answered from a cached field
+};
+
+using PathTicket = uint64_t;    // 0: no request
+
+enum class PathStatus : uint8_t { Pending, Ready, Failed, Unknown };
+
+// Either waypoints from start to goal, or a flow field to follow (shared by every agent
+// heading for that goal cell)
+struct PathResult {
+    PathStatus status = PathStatus::Unknown;
+    std::vector<glm::vec3> waypoints;
+    std::shared_ptr<const FlowField> field;
+};
+
+// Path requests from behaviors, answered in later steps.
+// request() only queues; update() (once per simulation step) serves a bounded batch on
+// the job system, so thousands of agents asking at once spread over a few steps instead
+// of stalling one. Goals many waiting requests share get one flow field instead of a
+// search each; fields are cached for later requests to the same goal cell.
+// Requests are served in order and each result depends only on its request, so the
+// outcome does not depend on the thread count.
+class PathService {
+public:
+    PathServiceSettings settings;
+
+    void build(const HeightField& terrain, JobSystem* jobs = nullptr) {
+        pending.clear();
+        done.clear();
+        fields.clear();
+        ++builds;
+        grid.build(terrain, settings.grid);
+        pathfinder.build(grid, settings.clusterSize, jobs);
+    }
+
+    bool ready() const { return !grid.empty(); }
+    uint64_t generation() const { return builds; }     // changes with every build()
+    const NavGrid& navGrid() const { return grid; }
+    const HierarchicalPathfinder& hierarchy() const { return pathfinder; }
+    const PathServiceStats& getStats() const { return stats; }
+
+    PathTicket request(const glm::vec3& from, const glm::vec3& to) {
+        const PathTicket ticket = ++lastTicket;
+        if (!ready()) {
+            done[ticket].status = PathStatus::Failed;
+            return ticket;
+        }
+        const NavGrid::Cell goal = grid.nearestWalkable(grid.cellAt(to));
+        if (std::shared_ptr<const FlowField> field = cachedField(goal)) {
+            PathResult& result = done[ticket];
+            result.status = field->reachable(grid.nearestWalkable(grid.cellAt(from))) ? PathStatus::Ready : PathStatus::Failed;
+            result.field = std::move(field);
+            ++stats.flowFieldHits;
+            return ticket;
+        }
+        pending.push_back(Request{ ticket, from, to, goal });
+        return ticket;
+    }
+
+    PathStatus status(PathTicket ticket) const {
+        if (done.count(ticket)) return done.at(ticket).status;
+        for (const Request& r : pending) if (r.ticket == ticket) return PathStatus::Pending;
+        return PathStatus::Unknown;
+    }
+
+    // Moves a finished result out; false while it is pending (or for unknown tickets)
+    bool take(PathTicket ticket, PathResult& out) {
+        auto it = done.find(ticket);
+        if (it == done.end()) return false;
+        out = std::move(it->second);
+        done.erase(it);
+        return true;
+    }
+
+    void cancel(PathTicket ticket) {
+        done.erase(ticket);
+        std::erase_if(pending, [&](const Request& r) { return r.ticket == ticket; });
+    }
+
+    void update(JobSystem* jobs = nullptr) {
+        ++step;
+        stats.paths = stats.failed = stats.flowFields = 0;
+        if (pending.empty()) {
+            stats.pending = 0;
+            return;
+        }
+
+        // Goals with enough waiting requests get a flow field (most requested first)
+        goalCounts.clear();
+        for (const Request& r : pending) ++goalCounts[r.goal];
+        fieldGoals.clear();
+        for (auto [goal, count] : goalCounts) {
+            if (count >= settings.flowFieldRequests && goal != NavGrid::NONE) fieldGoals.emplace_back(count, goal);
+        }
+        std::sort(fieldGoals.begin(), fieldGoals.end(), [](auto a, auto b) { return a.first != b.first ? a.first > b.first : a.second < b.second; });
+        fieldGoals.resize(std::min(fieldGoals.size(), settings.flowFieldsPerStep));
+
+        std::vector<std::shared_ptr<FlowField>> built(fieldGoals.size());
+        auto buildFields = [&](size_t begin, size_t end, size_t) {
+            for (size_t k = begin; k < end; ++k) {
+                built[k] = std::make_shared<FlowField>();
+                built[k]->build(grid, fieldGoals[k].second);
+            }
+        };
+        if (jobs) jobs->parallelFor(built.size(), 1, buildFields);
+        else buildFields(0, built.size(), 0);
+        for (const std::shared_ptr<FlowField>& field : built) addField(field);
+        stats.flowFields = built.size();
+
+        // Requests a field now answers leave the queue; then a batch of searches
+        batch.clear();
+        for (auto it = pending.begin(); it != pending.end();) {
+            if (std::shared_ptr<const FlowField> field = fieldGoals.empty() ? nullptr : cachedField(it->goal)) {
+                PathResult& result = done[it->ticket];
+                result.status = field->reachable(grid.nearestWalkable(grid.cellAt(it->from))) ? PathStatus::Ready : PathStatus::Failed;
+                result.field = std::move(field);
+                it = pending.erase(it);
+                continue;
+            }
+            if (batch.size() < settings.pathsPerStep) {
+                batch.push_back(std::move(*it));
+                it = pending.erase(it);
+                continue;
+            }
+            ++it;
+        }
+
+        results.resize(batch.size());
+        scratch.resize(jobs ? jobs->threadCount() : 1);
+        auto search = [&](size_t begin, size_t end, size_t) {
+            Worker& w = scratch[jobs ? jobs->currentThread() : 0];
+            for (size_t k = begin; k < end; ++k) {
+                PathResult& result = results[k];
+                result = PathResult{};
+                if (!pathfinder.findPath(batch[k].from, batch[k].to, w.search, w.cells)) {
+                    result.status = PathStatus::Failed;
+                    continue;
+                }
+                result.status = PathStatus::Ready;
+                result.waypoints.reserve(w.cells.size());
+                for (size_t c = 1; c < w.cells.size(); ++c) result.waypoints.push_back(grid.position(w.cells[c]));
+                if (result.waypoints.empty()) result.waypoints.push_back(grid.position(w.cells.front()));
+            }
+        };
+        if (jobs) jobs->parallelFor(batch.size(), PATH_CHUNK, search);
+        else search(0, batch.size(), 0);
+
+        for (size_t k = 0; k < batch.size(); ++k) {
+            stats.failed += results[k].status == PathStatus::Failed;
+            done[batch[k].ticket] = std::move(results[k]);
+        }
+        stats.paths = batch.size();
+        stats.pending = pending.size();
+    }
+
+private:
+    static constexpr size_t PATH_CHUNK = 8;
+
+    struct Request {
+        PathTicket ticket;
+        glm::vec3 from;
+        glm::vec3 to;
+        NavGrid::Cell goal;
+    };
+
+    struct Worker {
+        HierarchicalPathfinder::Scratch search;
+        std::vector<NavGrid::Cell> cells;
+    };
+
+    struct CachedField {
+        std::shared_ptr<const FlowField> field;
+        uint64_t lastUsed = 0;
+    };
+
+    std::shared_ptr<const FlowField> cachedField(NavGrid::Cell goal) {
+        for (CachedField& c : fields) {
+            if (c.field->goalCell() == goal) {
+                c.lastUsed = step;
+                return c.field;
+            }
+        }
+        return nullptr;
+    }
+
+    // Least recently used fields make room (agents still following one keep it alive)
+    void addField(std::shared_ptr<const FlowField> field) {
+        if (fields.size() >= std::max<size_t>(1, settings.cachedFlowFields)) {
+            auto oldest = std::min_element(fields.begin(), fields.end(), [](const CachedField& a, const CachedField& b) { return a.lastUsed < b.lastUsed; });
+            fields.erase(oldest);
+        }
+        fields.push_back(CachedField{ std::move(field), step });
+    }
+
+    NavGrid grid;
+    HierarchicalPathfinder pathfinder;
+    std::deque<Request> pending;
+    std::unordered_map<PathTicket, PathResult> done;
+    std::vector<CachedField> fields;
+    PathTicket lastTicket = 0;
+    uint64_t step = 0;
+    uint64_t builds = 0;
+
+    std::unordered_map<NavGrid::Cell, size_t> goalCounts;
+    std::vector<std::pair<size_t, NavGrid::Cell>> fieldGoals;
+    std::vector<Request> batch;
+    std::vector<PathResult> results;
+    std::vector<Worker> scratch;
+    PathServiceStats stats;
+};
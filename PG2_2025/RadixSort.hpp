@@ -0,0 +1,93 @@
+#pragma once
+
+#include <vector>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+#include "JobSystem.hpp"
+
+// Stable LSD radix sort of 32-bit keys carrying a 32-bit value each, 8 bits per pass.
+// Each pass histograms fixed chunks, turns the (digit, chunk) counts into offsets with
+// one serial prefix sum, then scatters the chunks; with a JobSystem the histograms and
+// scatters run in parallel. Chunk boundaries do not depend on the thread count, so
+// neither does the result. Passes where every key has the same digit are skipped.
+class RadixSorter {
+public:
+    static constexpr size_t CHUNK = 16384;
+
+    // Ascending by key; equal keys keep their order
+    void sort(std::vector<uint32_t>& keys, std::vector<uint32_t>& values, JobSystem* jobs = nullptr) {
+        const size_t n = std::min(keys.size(), values.size());
+        if (n < 2) return;
+        keyScratch.resize(n);
+        valueScratch.resize(n);
+        const size_t chunks = (n + CHUNK - 1) / CHUNK;
+        offsets.resize(chunks);
+
+        uint32_t* srcKeys = keys.data();
+        uint32_t* srcValues = values.data();
+        uint32_t* dstKeys = keyScratch.data();
+        uint32_t* dstValues = valueScratch.data();
+
+        for (uint32_t shift = 0; shift < 32; shift += RADIX_BITS) {
+            auto histogram = [&](size_t begin, size_t end, size_t chunk) {
+                Counts& c = offsets[chunk];
+                c.fill(0);
+                for (size_t i = begin; i < end; ++i) ++c[(srcKeys[i] >> shift) & RADIX_MASK];
+            };
+            if (jobs) jobs->parallelFor(n, CHUNK, histogram);
+            else for (size_t c = 0; c < chunks; ++c) histogram(c * CHUNK, std::min(n, (c + 1) * CHUNK), c);
+
+            // Digit-major prefix: every chunk's run of a digit follows the previous chunk's
+            bool skip = false;
+            uint32_t total = 0;
+            for (size_t d = 0; d <= RADIX_MASK; ++d) {
+                uint32_t digitCount = 0;
+                for (size_t c = 0; c < chunks; ++c) {
+                    const uint32_t count = offsets[c][d];
+                    offsets[c][d] = total;
+                    total += count;
+                    digitCount += count;
+                }
+                if (digitCount == n) skip = true;
+            }
+            if (skip) continue;
+
+            auto scatter = [&](size_t begin, size_t end, size_t chunk) {
+                Counts& next = offsets[chunk];
+                for (size_t i = begin; i < end; ++i) {
+                    const uint32_t slot = next[(srcKeys[i] >> shift) & RADIX_MASK]++;
+                    dstKeys[slot] = srcKeys[i];
+                    dstValues[slot] = srcValues[i];
+                }
+            };
+            if (jobs) jobs->parallelFor(n, CHUNK, scatter);
+            else for (size_t c = 0; c < chunks; ++c) scatter(c * CHUNK, std::min(n, (c + 1) * CHUNK), c);
+
+            std::swap(srcKeys, dstKeys);
+            std::swap(srcValues, dstValues);
+        }
+
+        if (srcKeys != keys.data()) {
+            std::memcpy(keys.data(), srcKeys, n * sizeof(uint32_t));
+            std::memcpy(values.data(), srcValues, n * sizeof(uint32_t));
+        }
+    }
+
+    // Order-preserving map of a float to an unsigned key (negative values first)
+    static uint32_t floatKey(float f) {
+        uint32_t u;
+        std::memcpy(&u, &f, sizeof u);
+        return (u & 0x80000000u) ? ~u : (u | 0x80000000u);
+    }
+
+private:
+    static constexpr uint32_t RADIX_BITS = 8;
+    static constexpr uint32_t RADIX_MASK = (1u << RADIX_BITS) - 1;
+    using Counts = std::array<uint32_t, RADIX_MASK + 1>;
+
+    std::vector<uint32_t> keyScratch, valueScratch;
+    std::vector<Counts> offsets;    // by chunk: count, then first slot, of each digit
+};
@@ -0,0 +1,219 @@
+#pragma once
+
+#include <vector>
+#include <future>
+#include <thread>
+#include <atomic>
+#include <random>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+
+#include "HeightField.hpp"
+#include "Model.hpp"
+#include "Frustum.hpp"
+#include "LightSource.hpp"
+
+// One scatter layer (grass, rocks, trees...). Placement is driven by terrain height and slope.
+struct ScatterRule {
+    Model* model = nullptr;
+    float density = 0.05f;       // instances per square world unit
+    float minHeight = 0.0f;
+    float maxHeight = 1e9f;
+    float maxSlope = 30.0f;      // degrees from vertical
+    float minScale = 0.8f;
+    float maxScale = 1.2f;
+    float fadeStart = 150.0f;    // full density up to here
+    float fadeEnd = 300.0f;      // no instances drawn beyond this
+};
+
+// Matches the std430 Instance struct in assets/shaders/scatter.vert
+struct ScatterInstance {
+    glm::vec4 positionYaw;       // xyz = world position, w = yaw (radians)
+    glm::vec4 scale;             // x = uniform scale
+};
+
+struct ScatterStats {
+    size_t instances = 0;
+    size_t drawCalls = 0;
+    size_t visibleChunks = 0;
+};
+
+class Scatter {
+public:
+    Scatter() = default;
+    Scatter(const Scatter&) = delete;
+    Scatter& operator=(const Scatter&) = delete;
+
+    ~Scatter() {
+        for (auto& w : workers) {
+            if (w.valid()) w.wait();
+        }
+        if (instanceBuffer != 0) glDeleteBuffers(1, &instanceBuffer);
+    }
+
+    // Starts generating instances on worker threads; upload() happens from draw() once done
+    void generate(const HeightField& terrain, const std::vector<ScatterRule>& scatterRules, float chunkSize = 64.0f) {
+        field = terrain;
+        rules = scatterRules;
+
+        glm::vec2 lo = field.minXZ();
+        glm::vec2 hi = field.maxXZ();
+        int chunksX = std::max(1, static_cast<int>(std::ceil((hi.x - lo.x) / chunkSize)));
+        int chunksZ = std::max(1, static_cast<int>(std::ceil((hi.y - lo.y) / chunkSize)));
+
+        chunks.clear();
+        chunks.resize(static_cast<size_t>(chunksX) * chunksZ);
+        for (int cz = 0; cz < chunksZ; ++cz) {
+            for (int cx = 0; cx < chunksX; ++cx) {
+                Chunk& c = chunks[static_cast<size_t>(cz) * chunksX + cx];
+                c.areaMin = lo + glm::vec2(cx, cz) * chunkSize;
+                c.areaMax = glm::min(c.areaMin + glm::vec2(chunkSize), hi);
+                c.seed = static_cast<uint32_t>(cz * 73856093 ^ cx * 19349663);
+                c.layers.resize(rules.size());
+            }
+        }
+
+        unsigned int threads = std::max(1u, std::thread::hardware_concurrency());
+        pending = static_cast<int>(threads);
+        for (unsigned int t = 0; t < threads; ++t) {
+            workers.push_back(std::async(std::launch::async, [this, t, threads]() {
+                for (size_t i = t; i < chunks.size(); i += threads) {
+                    generateChunk(chunks[i]);
+                }
+                --pending;
+            }));
+        }
+    }
+
+    bool ready() const { return !workers.empty() && pending == 0; }
+
+    void draw(const glm::mat4& projection, const glm::mat4& view, const Frustum& frustum,
+        const glm::vec3& cameraPos, const std::vector<LightSource*>& lights) {
+        stats = ScatterStats{};
+        if (!uploaded) {
+            if (!ready()) return;
+            upload();
+        }
+        if (instanceBuffer == 0) return;
+
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, instanceBuffer);
+
+        for (const Chunk& c : chunks) {
+            if (!isBoxInsideFrustum(frustum, c.boundsMin, c.boundsMax)) continue;
+            ++stats.visibleChunks;
+
+            // Distance to the chunk box, not its center, so large chunks do not pop
+            glm::vec3 closest = glm::clamp(cameraPos, c.boundsMin, c.boundsMax);
+            float dist = glm::distance(cameraPos, closest);
+
+            for (size_t r = 0; r < rules.size(); ++r) {
+                const Layer& layer = c.layers[r];
+                if (layer.count == 0 || rules[r].model == nullptr) continue;
+
+                // Instances are stored in random order, so a prefix is a uniform subset
+                float fade = 1.0f - glm::smoothstep(rules[r].fadeStart, rules[r].fadeEnd, dist);
+                GLsizei count = static_cast<GLsizei>(std::ceil(layer.count * fade));
+                if (count <= 0) continue;
+
+                rules[r].model->drawInstanced(projection, view, lights, count, layer.baseInstance);
+                stats.instances += count;
+                stats.drawCalls += rules[r].model->meshes.size();
+            }
+        }
+    }
+
+    const ScatterStats& getStats() const { return stats; }
+
+private:
+    struct Layer {
+        std::vector<ScatterInstance> instances; // freed after upload
+        GLuint baseInstance = 0;
+        GLsizei count = 0;
+    };
+
+    struct Chunk {
+        glm::vec2 areaMin{}, areaMax{};
+        glm::vec3 boundsMin{}, boundsMax{};
+        uint32_t seed = 0;
+        std::vector<Layer> layers;
+    };
+
+    HeightField field;
+    std::vector<ScatterRule> rules;
+    std::vector<Chunk> chunks;
+    std::vector<std::future<void>> workers;
+    std::atomic<int> pending{ 0 };
+    GLuint instanceBuffer = 0;
+    bool uploaded = false;
+    ScatterStats stats;
+
+    void generateChunk(Chunk& c) {
+        std::mt19937 rng(c.seed);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+        glm::vec3 lo(c.areaMin.x, 1e30f, c.areaMin.y);
+        glm::vec3 hi(c.areaMax.x, -1e30f, c.areaMax.y);
+
+        for (size_t r = 0; r < rules.size(); ++r) {
+            const ScatterRule& rule = rules[r];
+            std::vector<ScatterInstance>& out = c.layers[r].instances;
+            if (rule.density <= 0.0f) continue;
+
+            // Jittered grid: one candidate per cell keeps spacing even without clumping
+            float cell = 1.0f / std::sqrt(rule.density);
+            for (float z = c.areaMin.y; z < c.areaMax.y; z += cell) {
+                for (float x = c.areaMin.x; x < c.areaMax.x; x += cell) {
+                    float px = std::min(x + unit(rng) * cell, c.areaMax.x);
+                    float pz = std::min(z + unit(rng) * cell, c.areaMax.y);
+                    float yaw = unit(rng) * glm::two_pi<float>();
+                    float scale = glm::mix(rule.minScale, rule.maxScale, unit(rng));
+
+                    float h = field.getHeight(px, pz);
+                    if (h < rule.minHeight || h > rule.maxHeight) continue;
+                    if (field.getSlope(px, pz) > rule.maxSlope) continue;
+
+                    out.push_back({ glm::vec4(px, h, pz, yaw), glm::vec4(scale, 0.0f, 0.0f, 0.0f) });
+
+                    float top = rule.model ? rule.model->boundingBoxMax.y * scale : 0.0f;
+                    lo.y = std::min(lo.y, h);
+                    hi.y = std::max(hi.y, h + top);
+                }
+            }
+            std::shuffle(out.begin(), out.end(), rng);
+        }
+
+        if (lo.y > hi.y) lo.y = hi.y = 0.0f;
+        // Pad horizontally for instances hanging over the chunk border
+        c.boundsMin = lo - glm::vec3(2.0f, 0.0f, 2.0f);
+        c.boundsMax = hi + glm::vec3(2.0f, 0.0f, 2.0f);
+    }
+
+    void upload() {
+        std::vector<ScatterInstance> all;
+        size_t total = 0;
+        for (const Chunk& c : chunks)
+            for (const Layer& l : c.layers) total += l.instances.size();
+        all.reserve(total);
+
+        for (Chunk& c : chunks) {
+            for (Layer& l : c.layers) {
+                l.baseInstance = static_cast<GLuint>(all.size());
+                l.count = static_cast<GLsizei>(l.instances.size());
+                all.insert(all.end(), l.instances.begin(), l.instances.end());
+                std::vector<ScatterInstance>().swap(l.instances);
+            }
+        }
+
+        uploaded = true;
+        workers.clear();
+        if (all.empty()) return;
+
+        glCreateBuffers(1, &instanceBuffer);
+        glNamedBufferStorage(instanceBuffer, all.size() * sizeof(ScatterInstance), all.data(), 0);
+        std::cout << "Note: Scatter instances: " << all.size() << " in " << chunks.size() << " chunks" << std::endl;
+    }
+};
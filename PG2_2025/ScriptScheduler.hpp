@@ -0,0 +1,218 @@
+#pragma once
+
+#include <coroutine>
+#include <chrono>
+#include <exception>
+#include <iostream>
+#include <vector>
+#include <cstdint>
+#include <cmath>
+
+#include "EntityStore.hpp"
+#include "TimerWheel.hpp"
+
+// Coroutine behaviors. A script is a C++20 coroutine bound to one entity:
+//
+//     Scripts::Script hopAround() {
+//         for (;;) {
+//             co_await Scripts::wait(2.0s);
+//             Entity self = co_await Scripts::entity();
+//             self.jump(5.0f);
+//             co_await Scripts::untilGrounded();
+//         }
+//     }
+//     scripts.start(handle, hopAround());
+//
+// While suspended on wait() a script sits in a timer wheel and costs nothing per step.
+// Scripts run on the main thread inside Scheduler::update, before entity integration.
+// Entity views obtained with co_await entity() are only valid until the next co_await.
+namespace Scripts {
+
+    class Scheduler;
+
+    class Script {
+    public:
+        struct promise_type {
+            Scheduler* scheduler = nullptr;
+            EntityHandle self;
+            uint32_t task = 0;
+
+            Script get_return_object() { return Script(std::coroutine_handle<promise_type>::from_promise(*this)); }
+            std::suspend_always initial_suspend() noexcept { return {}; } // started by the scheduler
+            std::suspend_always final_suspend() noexcept { return {}; }
+            void return_void() {}
+            void unhandled_exception() { exception = std::current_exception(); }
+
+            std::exception_ptr exception;
+        };
+        using Handle = std::coroutine_handle<promise_type>;
+
+        Script(Script&& other) noexcept : handle(other.handle) { other.handle = nullptr; }
+        Script& operator=(Script&& other) noexcept {
+            if (this != &other) {
+                if (handle) handle.destroy();
+                handle = other.handle;
+                other.handle = nullptr;
+            }
+            return *this;
+        }
+        Script(const Script&) = delete;
+        Script& operator=(const Script&) = delete;
+        ~Script() { if (handle) handle.destroy(); }
+
+        // Hands the coroutine frame over to the scheduler
+        Handle release() { Handle h = handle; handle = nullptr; return h; }
+
+    private:
+        explicit Script(Handle h) : handle(h) {}
+        Handle handle;
+    };
+
+    class Scheduler {
+    public:
+        // One timer tick per simulation step by default
+        explicit Scheduler(float tickSeconds = 1.0f / 60.0f) : tickSeconds(tickSeconds) {}
+
+        Scheduler(const Scheduler&) = delete;
+        Scheduler& operator=(const Scheduler&) = delete;
+
+        ~Scheduler() {
+            for (Task& t : tasks) {
+                if (t.handle) t.handle.destroy();
+            }
+        }
+
+        // Runs `script` for entity `self`, first resumed on the next update()
+        void start(EntityHandle self, Script script) {
+            Script::Handle h = script.release();
+            uint32_t id;
+            if (!freeTasks.empty()) {
+                id = freeTasks.back();
+                freeTasks.pop_back();
+            }
+            else {
+                id = static_cast<uint32_t>(tasks.size());
+                tasks.emplace_back();
+            }
+            tasks[id].handle = h;
+            h.promise().scheduler = this;
+            h.promise().self = self;
+            h.promise().task = id;
+            ready.push_back(id);
+        }
+
+        // Advances the timer wheel by dt and resumes every script whose wait is over.
+        // Scripts of destroyed entities are dropped when they would next resume.
+        void update(EntityStore& entityStore, float dt) {
+            store = &entityStore;
+
+            elapsed += dt;
+            while (elapsed >= tickSeconds) {
+                elapsed -= tickSeconds;
+                wheel.tick(ready);
+            }
+
+            // Only scripts waiting on a condition are polled
+            for (size_t k = 0; k < groundWaiters.size();) {
+                uint32_t id = groundWaiters[k];
+                uint32_t i = entityStore.indexOf(tasks[id].handle.promise().self);
+                if (i == EntityStore::INVALID || entityStore.bodies[i].isGrounded) {
+                    ready.push_back(id);
+                    groundWaiters[k] = groundWaiters.back();
+                    groundWaiters.pop_back();
+                    continue;
+                }
+                ++k;
+            }
+
+            resuming.swap(ready);
+            for (uint32_t id : resuming) resume(id);
+            resuming.clear();
+
+            store = nullptr;
+        }
+
+        size_t running() const { return tasks.size() - freeTasks.size(); }
+        size_t sleeping() const { return wheel.size(); }
+        uint64_t now() const { return wheel.now(); }
+
+        // Used by the awaitables
+        void sleepFor(uint32_t task, float seconds) {
+            // Partial tick already elapsed counts towards the wait
+            uint64_t ticks = static_cast<uint64_t>(std::ceil((seconds + elapsed) / tickSeconds - 1e-4f));
+            wheel.schedule(wheel.now() + ticks, task);
+        }
+        void waitGrounded(uint32_t task) { groundWaiters.push_back(task); }
+        void nextStep(uint32_t task) { ready.push_back(task); }
+        EntityStore& entities() { return *store; }
+
+    private:
+        struct Task {
+            Script::Handle handle;
+        };
+
+        void resume(uint32_t id) {
+            Script::Handle h = tasks[id].handle;
+            if (store->alive(h.promise().self)) {
+                h.resume();
+                if (!h.done()) return;
+                if (h.promise().exception) {
+                    try { std::rethrow_exception(h.promise().exception); }
+                    catch (const std::exception& e) { std::cerr << "Script failed: " << e.what() << std::endl; }
+                    catch (...) { std::cerr << "Script failed" << std::endl; }
+                }
+            }
+            h.destroy();
+            tasks[id].handle = nullptr;
+            freeTasks.push_back(id);
+        }
+
+        float tickSeconds;
+        float elapsed = 0.0f;
+        TimerWheel wheel;
+        std::vector<Task> tasks;
+        std::vector<uint32_t> freeTasks;
+        std::vector<uint32_t> ready;        // resumed on the next update
+        std::vector<uint32_t> resuming;
+        std::vector<uint32_t> groundWaiters;
+        EntityStore* store = nullptr;
+    };
+
+    // === Awaitables ===
+
+    // Suspends for `seconds` of simulation time
+    struct wait {
+        float seconds;
+
+        explicit wait(float seconds) : seconds(seconds) {}
+        template<typename Rep, typename Period>
+        explicit wait(std::chrono::duration<Rep, Period> d) : seconds(std::chrono::duration<float>(d).count()) {}
+
+        bool await_ready() const noexcept { return seconds <= 0.0f; }
+        void await_suspend(Script::Handle h) const { h.promise().scheduler->sleepFor(h.promise().task, seconds); }
+        void await_resume() const noexcept {}
+    };
+
+    // Suspends until the entity touches the ground
+    struct untilGrounded {
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(Script::Handle h) const { h.promise().scheduler->waitGrounded(h.promise().task); }
+        void await_resume() const noexcept {}
+    };
+
+    // Suspends until the next simulation step, for scripts that steer every step
+    struct nextStep {
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(Script::Handle h) const { h.promise().scheduler->nextStep(h.promise().task); }
+        void await_resume() const noexcept {}
+    };
+
+    // Does not suspend; yields a view of the script's own entity
+    struct entity {
+        Script::promise_type* promise = nullptr;
+
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(Script::Handle h) noexcept { promise = &h.promise(); return false; }
+        Entity await_resume() const { return promise->scheduler->entities().get(promise->self); }
+    };
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <vector>
+#include <chrono>
+#include <glm/glm.hpp>
+
+#include "ScriptScheduler.hpp"
+
+// Coroutine versions of the timer-driven Behaviors. Start them with
+// Scripts::Scheduler::start(handle, ScriptedBehaviors::...).
+namespace ScriptedBehaviors {
+
+    using Scripts::Script;
+
+    // Jump on a timer; idle in the timer wheel between jumps
+    inline Script PeriodicJump(float strength = 5.0f, float interval = 2.0f) {
+        for (;;) {
+            co_await Scripts::wait(interval);
+            Entity self = co_await Scripts::entity();
+            self.jump(strength);
+            co_await Scripts::untilGrounded();
+        }
+    }
+
+    // Walk a loop of waypoints, idling `pause` seconds at each one and hopping on arrival
+    inline Script Patrol(std::vector<glm::vec3> waypoints, float pause = 3.0f, float arriveRadius = 2.0f, float hop = 4.0f) {
+        if (waypoints.empty()) co_return;
+        for (size_t next = 0;; next = (next + 1) % waypoints.size()) {
+            // Steer every step while walking
+            for (;;) {
+                Entity self = co_await Scripts::entity();
+                glm::vec3 toTarget = waypoints[next] - self.position;
+                toTarget.y = 0.0f;
+                if (glm::dot(toTarget, toTarget) <= arriveRadius * arriveRadius) break;
+                self.applyForce(glm::normalize(toTarget) * self.movementSpeed);
+                co_await Scripts::nextStep();
+            }
+
+            if (hop > 0.0f) {
+                Entity self = co_await Scripts::entity();
+                self.jump(hop);
+                co_await Scripts::untilGrounded();
+            }
+            co_await Scripts::wait(pause);
+        }
+    }
+}
@@ -21,6 +21,10 @@ ShaderProgram::ShaderProgram(const std::filesystem::path& VS_file, const std::fi
 	ID = link_shader(shader_ids);
 }
 
+ShaderProgram::ShaderProgram(const std::filesystem::path& CS_file) {
+	ID = link_shader({ compile_shader(CS_file, GL_COMPUTE_SHADER) });
+}
+
 void ShaderProgram::setUniform(const std::string& name, const float val) {
 	auto loc = glGetUniformLocation(ID, name.c_str());
 	if (loc == -1) {
@@ -11,6 +11,7 @@ public:
 	// you can add more constructors for pipeline with GS, TS etc.
 	ShaderProgram(void) = default; //does nothing
 	ShaderProgram(const std::filesystem::path & VS_file, const std::filesystem::path & FS_file); // TODO: implementation of load, compile, and link shader
+	explicit ShaderProgram(const std::filesystem::path & CS_file); // compute-only program
 
 	void activate(void) { glUseProgram(ID); };    // activate shader
 	void deactivate(void) { glUseProgram(0); };   // deactivate current shader program (i.e. activate shader no. 0)
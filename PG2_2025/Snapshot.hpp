@@ -0,0 +1,381 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <type_traits>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Versioned binary snapshots of the simulation state.
+//
+// Layout: header { magic, version, kind } followed by sections { id, size, bytes }.
+// Each system writes its own section (see the save()/load() methods on EntityStore,
+// BehaviorSystems, UpdateScheduler, Camera and Particles). Arrays of trivially copyable
+// components are stored as raw bytes, so saving and restoring are a few memcpy calls.
+// Readers look sections up by id and ignore unknown ones.
+//
+// Delta snapshots store, per section, only the fixed-size blocks that differ from a
+// base snapshot, and are turned back into a full snapshot with Snapshot::applyDelta().
+namespace Snapshot {
+
+    constexpr uint32_t fourcc(const char (&s)[5]) {
+        return uint32_t(uint8_t(s[0])) | uint32_t(uint8_t(s[1])) << 8 | uint32_t(uint8_t(s[2])) << 16 | uint32_t(uint8_t(s[3])) << 24;
+    }
+
+    constexpr uint32_t MAGIC = fourcc("PG2S");
+    constexpr uint16_t VERSION = 1;
+    constexpr uint32_t DELTA_BLOCK = 256;   // bytes compared per block in delta snapshots
+
+    enum class Kind : uint16_t { Full = 0, Delta = 1 };
+
+    struct Header {
+        uint32_t magic = MAGIC;
+        uint16_t version = VERSION;
+        Kind kind = Kind::Full;
+    };
+
+    struct SectionHeader {
+        uint32_t id;
+        uint32_t pad = 0;
+        uint64_t size;
+    };
+
+    // Identifies the base of a delta. FNV-style over 8-byte words in four independent
+    // lanes, so it runs at close to memory bandwidth.
+    inline uint64_t hash(const std::vector<uint8_t>& data) {
+        const uint64_t prime = 1099511628211ull;
+        uint64_t lane[4] = { 1469598103934665603ull ^ data.size(), 0x9e3779b97f4a7c15ull, 0xc2b2ae3d27d4eb4full, 0x165667b19e3779f9ull };
+        size_t i = 0;
+        for (; i + 32 <= data.size(); i += 32) {
+            for (int l = 0; l < 4; ++l) {
+                uint64_t w;
+                std::memcpy(&w, data.data() + i + l * 8, 8);
+                lane[l] = (lane[l] ^ w) * prime;
+                lane[l] ^= lane[l] >> 29;
+            }
+        }
+        uint64_t h = lane[0];
+        for (int l = 1; l < 4; ++l) h = (h ^ lane[l]) * prime;
+        for (; i < data.size(); ++i) { h ^= data[i]; h *= prime; }
+        return h;
+    }
+}
+
+class SnapshotWriter {
+public:
+    std::vector<uint8_t> buffer;
+
+    explicit SnapshotWriter(Snapshot::Kind kind = Snapshot::Kind::Full) {
+        reset(kind);
+    }
+
+    // Starts a new snapshot but keeps the buffer's memory. Reusing one writer avoids
+    // faulting in fresh pages on every save, which costs more than the copy itself.
+    void reset(Snapshot::Kind kind = Snapshot::Kind::Full) {
+        buffer.clear();
+        Snapshot::Header header;
+        header.kind = kind;
+        write(header);
+    }
+
+    void beginSection(uint32_t id) {
+        sectionStart = buffer.size();
+        write(Snapshot::SectionHeader{ id, 0, 0 });
+    }
+
+    void endSection() {
+        uint64_t size = buffer.size() - sectionStart - sizeof(Snapshot::SectionHeader);
+        std::memcpy(buffer.data() + sectionStart + offsetof(Snapshot::SectionHeader, size), &size, sizeof(size));
+    }
+
+    template<typename T>
+    void write(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>, "snapshot values must be trivially copyable");
+        writeBytes(&value, sizeof(T));
+    }
+
+    template<typename T>
+    void writeArray(const std::vector<T>& values) {
+        static_assert(std::is_trivially_copyable_v<T>, "snapshot arrays must be trivially copyable");
+        write(static_cast<uint64_t>(values.size()));
+        writeBytes(values.data(), values.size() * sizeof(T));
+    }
+
+    void writeString(std::string_view s) {
+        write(static_cast<uint32_t>(s.size()));
+        writeBytes(s.data(), s.size());
+    }
+
+    void writeBytes(const void* data, size_t size) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        buffer.insert(buffer.end(), bytes, bytes + size);
+    }
+
+    // Single write of the whole image, to a temporary file renamed over `path`, so a
+    // failed or interrupted save keeps the previous file intact
+    void saveToFile(const std::filesystem::path& path) const {
+        std::filesystem::path temporary = path;
+        temporary += ".tmp";
+        bool written;
+        {
+            std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+            written = file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size()) && file.flush();
+        }
+        std::error_code error;
+        if (written) std::filesystem::rename(temporary, path, error);
+        if (!written || error) {
+            std::filesystem::remove(temporary, error);
+            throw std::runtime_error("Cannot write snapshot: " + path.string());
+        }
+    }
+
+private:
+    size_t sectionStart = 0;
+};
+
+class SnapshotReader {
+public:
+    // Reads from `data` in place; it must outlive the reader
+    explicit SnapshotReader(const std::vector<uint8_t>& data) : bytes(data.data()), length(data.size()) {
+        checkHeader();
+    }
+
+    // Takes ownership (e.g. a file read into memory)
+    explicit SnapshotReader(std::vector<uint8_t>&& data) : owned(std::move(data)), bytes(owned.data()), length(owned.size()) {
+        checkHeader();
+    }
+
+    SnapshotReader(const SnapshotReader&) = delete;
+    SnapshotReader& operator=(const SnapshotReader&) = delete;
+    SnapshotReader(SnapshotReader&& other) noexcept
+        : owned(std::move(other.owned)), bytes(other.bytes), length(other.length), cursor(other.cursor), sectionEnd(other.sectionEnd) {
+    }
+
+    void checkHeader() const {
+        Snapshot::Header header = readAt<Snapshot::Header>(0);
+        if (header.magic != Snapshot::MAGIC) throw std::runtime_error("Not a snapshot");
+        if (header.version != Snapshot::VERSION) {
+            throw std::runtime_error("Unsupported snapshot version " + std::to_string(header.version));
+        }
+        if (header.kind != Snapshot::Kind::Full) throw std::runtime_error("Delta snapshot, apply it to its base first");
+    }
+
+    static SnapshotReader fromFile(const std::filesystem::path& path) {
+        return SnapshotReader(readFile(path));
+    }
+
+    static std::vector<uint8_t> readFile(const std::filesystem::path& path) {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file) throw std::runtime_error("Cannot open snapshot: " + path.string());
+        std::vector<uint8_t> contents(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        if (!file.read(reinterpret_cast<char*>(contents.data()), contents.size())) {
+            throw std::runtime_error("Cannot read snapshot: " + path.string());
+        }
+        return contents;
+    }
+
+    // Positions the reader at the start of section `id`; false if the snapshot has none
+    bool openSection(uint32_t id) {
+        size_t offset = sizeof(Snapshot::Header);
+        while (offset + sizeof(Snapshot::SectionHeader) <= length) {
+            Snapshot::SectionHeader section = readAt<Snapshot::SectionHeader>(offset);
+            offset += sizeof(Snapshot::SectionHeader);
+            if (section.id == id) {
+                cursor = offset;
+                sectionEnd = offset + section.size;
+                if (sectionEnd > length) throw std::runtime_error("Snapshot truncated");
+                return true;
+            }
+            offset += section.size;
+        }
+        return false;
+    }
+
+    template<typename T>
+    T read() {
+        static_assert(std::is_trivially_copyable_v<T>, "snapshot values must be trivially copyable");
+        T value;
+        readBytes(&value, sizeof(T));
+        return value;
+    }
+
+    template<typename T>
+    void readArray(std::vector<T>& values) {
+        static_assert(std::is_trivially_copyable_v<T>, "snapshot arrays must be trivially copyable");
+        uint64_t count = read<uint64_t>();
+        if (count > (sectionEnd - cursor) / sizeof(T)) throw std::runtime_error("Snapshot truncated");
+        values.resize(static_cast<size_t>(count));
+        readBytes(values.data(), values.size() * sizeof(T));
+    }
+
+    std::string readString() {
+        uint32_t size = read<uint32_t>();
+        if (size > sectionEnd - cursor) throw std::runtime_error("Snapshot truncated");
+        std::string s(reinterpret_cast<const char*>(bytes + cursor), size);
+        cursor += size;
+        return s;
+    }
+
+    void readBytes(void* out, size_t size) {
+        if (size > sectionEnd - cursor) throw std::runtime_error("Snapshot truncated");
+        if (size) std::memcpy(out, bytes + cursor, size);
+        cursor += size;
+    }
+
+private:
+    template<typename T>
+    T readAt(size_t offset) const {
+        if (offset + sizeof(T) > length) throw std::runtime_error("Snapshot truncated");
+        T value;
+        std::memcpy(&value, bytes + offset, sizeof(T));
+        return value;
+    }
+
+    std::vector<uint8_t> owned;
+    const uint8_t* bytes = nullptr;
+    size_t length = 0;
+    size_t cursor = 0;
+    size_t sectionEnd = 0;
+};
+
+namespace Snapshot {
+
+    // Per section of `current`: unchanged-size sections store only the blocks that differ
+    // from the same section in `base`, other sections are stored whole.
+    inline void makeDelta(const std::vector<uint8_t>& base, const std::vector<uint8_t>& current, SnapshotWriter& out) {
+        auto sections = [](const std::vector<uint8_t>& image) {
+            std::vector<std::pair<SectionHeader, size_t>> list; // header, data offset
+            size_t offset = sizeof(Header);
+            while (offset + sizeof(SectionHeader) <= image.size()) {
+                SectionHeader s;
+                std::memcpy(&s, image.data() + offset, sizeof(s));
+                offset += sizeof(SectionHeader);
+                list.push_back({ s, offset });
+                offset += s.size;
+            }
+            return list;
+        };
+        auto baseSections = sections(base);
+
+        out.reset(Kind::Delta);
+        out.write(hash(base));
+        out.write(static_cast<uint64_t>(current.size()));
+        for (const auto& [section, offset] : sections(current)) {
+            const uint8_t* cur = current.data() + offset;
+            const uint8_t* old = nullptr;
+            for (const auto& [b, bOffset] : baseSections) {
+                if (b.id == section.id && b.size == section.size) { old = base.data() + bOffset; break; }
+            }
+
+            out.beginSection(section.id);
+            out.write(static_cast<uint8_t>(old != nullptr));
+            if (!old) {
+                out.writeBytes(cur, section.size);
+            }
+            else {
+                uint64_t blocks = (section.size + DELTA_BLOCK - 1) / DELTA_BLOCK;
+                for (uint64_t b = 0; b < blocks; ++b) {
+                    size_t start = b * DELTA_BLOCK;
+                    size_t len = std::min<size_t>(DELTA_BLOCK, section.size - start);
+                    if (std::memcmp(cur + start, old + start, len) == 0) continue;
+                    out.write(static_cast<uint32_t>(b));
+                    out.writeBytes(cur + start, len);
+                }
+            }
+            out.endSection();
+        }
+    }
+
+    inline std::vector<uint8_t> makeDelta(const std::vector<uint8_t>& base, const std::vector<uint8_t>& current) {
+        SnapshotWriter out(Kind::Delta);
+        makeDelta(base, current, out);
+        return std::move(out.buffer);
+    }
+
+    // Rebuilds the full snapshot from its base and a delta made by makeDelta()
+    inline void applyDelta(const std::vector<uint8_t>& base, const std::vector<uint8_t>& delta, SnapshotWriter& out) {
+        auto readAt = [](const std::vector<uint8_t>& image, size_t offset, void* out, size_t size) {
+            if (offset + size > image.size()) throw std::runtime_error("Delta snapshot truncated");
+            std::memcpy(out, image.data() + offset, size);
+        };
+
+        Header header;
+        readAt(delta, 0, &header, sizeof(header));
+        if (header.magic != MAGIC || header.kind != Kind::Delta) throw std::runtime_error("Not a delta snapshot");
+        if (header.version != VERSION) throw std::runtime_error("Unsupported snapshot version " + std::to_string(header.version));
+
+        size_t offset = sizeof(Header);
+        uint64_t baseHash, fullSize;
+        readAt(delta, offset, &baseHash, sizeof(baseHash)); offset += sizeof(baseHash);
+        readAt(delta, offset, &fullSize, sizeof(fullSize)); offset += sizeof(fullSize);
+        if (baseHash != hash(base)) throw std::runtime_error("Delta snapshot does not match its base");
+
+        // Base sections by id, to copy unchanged blocks from
+        std::vector<std::pair<SectionHeader, size_t>> baseSections;
+        for (size_t b = sizeof(Header); b + sizeof(SectionHeader) <= base.size();) {
+            SectionHeader s;
+            readAt(base, b, &s, sizeof(s));
+            b += sizeof(SectionHeader);
+            if (s.size > base.size() - b) throw std::runtime_error("Snapshot truncated");
+            baseSections.push_back({ s, b });
+            b += s.size;
+        }
+
+        out.reset();
+        out.buffer.reserve(static_cast<size_t>(std::min<uint64_t>(fullSize, base.size() + delta.size()))); // a hint, not trusted
+        while (offset + sizeof(SectionHeader) <= delta.size()) {
+            SectionHeader s;
+            readAt(delta, offset, &s, sizeof(s));
+            offset += sizeof(SectionHeader);
+            if (s.size > delta.size() - offset) throw std::runtime_error("Delta snapshot truncated");
+            const size_t end = offset + s.size;
+            // Reads within the section only: a bad size must not pull in the next one
+            auto readSection = [&](void* to, size_t size) {
+                if (size > end - offset) throw std::runtime_error("Delta snapshot corrupt");
+                std::memcpy(to, delta.data() + offset, size);
+                offset += size;
+            };
+
+            uint8_t diffed;
+            readSection(&diffed, 1);
+
+            out.beginSection(s.id);
+            if (!diffed) {
+                out.writeBytes(delta.data() + offset, end - offset);
+            }
+            else {
+                const std::pair<SectionHeader, size_t>* old = nullptr;
+                for (const auto& b : baseSections) {
+                    if (b.first.id == s.id) { old = &b; break; }
+                }
+                if (!old) throw std::runtime_error("Delta snapshot does not match its base");
+
+                size_t start = out.buffer.size();
+                out.writeBytes(base.data() + old->second, old->first.size);
+                while (offset < end) {
+                    uint32_t block;
+                    readSection(&block, sizeof(block));
+                    size_t at = static_cast<size_t>(block) * DELTA_BLOCK;
+                    if (at >= old->first.size) throw std::runtime_error("Delta snapshot corrupt");
+                    size_t len = std::min<size_t>(DELTA_BLOCK, old->first.size - at);
+                    readSection(out.buffer.data() + start + at, len);
+                }
+            }
+            out.endSection();
+            offset = end;
+        }
+    }
+
+    inline std::vector<uint8_t> applyDelta(const std::vector<uint8_t>& base, const std::vector<uint8_t>& delta) {
+        SnapshotWriter out;
+        applyDelta(base, delta, out);
+        return std::move(out.buffer);
+    }
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+#include "GridCells.hpp"
+
+// Uniform-grid broadphase. Boxes are binned into every grid cell they touch, the cells
+// are hashed into a table rebuilt from scratch each step (counting sort, no allocation
+// once warmed up), and only boxes sharing a cell are tested against each other.
+//
+//     hash.clear();
+//     for (...) hash.insert(id, worldMin, worldMax);
+//     hash.forEachPair([](uint32_t a, uint32_t b) { ... });
+//
+// Each overlapping pair is reported exactly once: a pair sharing several cells is only
+// reported from the cell holding the min corner of the two boxes' intersection.
+class SpatialHash {
+public:
+    // 0 picks a cell size from the inserted boxes on every build
+    explicit SpatialHash(float cellSize = 0.0f) : fixedCellSize(cellSize) {}
+
+    void clear() { boxes.clear(); }
+
+    void reserve(size_t n) { boxes.reserve(n); }
+
+    void insert(uint32_t id, glm::vec3 min, glm::vec3 max) {
+        boxes.push_back(Box{ min, max, id });
+    }
+
+    size_t size() const { return boxes.size(); }
+    float getCellSize() const { return cellSize; }
+    size_t getEntryCount() const { return entries.size(); }
+
+    // Calls onPair(idA, idB) once for every pair of inserted boxes that overlap (touching counts)
+    template<typename F>
+    void forEachPair(F&& onPair) {
+        build();
+        for (size_t bucket = 0; bucket + 1 < bucketStart.size(); ++bucket) {
+            const uint32_t begin = bucketStart[bucket];
+            const uint32_t end = bucketStart[bucket + 1];
+            for (uint32_t i = begin; i < end; ++i) {
+                const Entry& ei = sorted[i];
+                const Box& a = boxes[ei.box];
+                for (uint32_t j = i + 1; j < end; ++j) {
+                    const Entry& ej = sorted[j];
+                    // Different cells can share a bucket
+                    if (ej.x != ei.x || ej.y != ei.y || ej.z != ei.z) continue;
+                    const Box& b = boxes[ej.box];
+                    if (!overlaps(a, b)) continue;
+
+                    const glm::vec3 corner = glm::max(a.min, b.min);
+                    if (cellOf(corner.x) != ei.x || cellOf(corner.y) != ei.y || cellOf(corner.z) != ei.z) continue;
+                    onPair(a.id, b.id);
+                }
+            }
+        }
+    }
+
+private:
+    struct Box {
+        glm::vec3 min;
+        glm::vec3 max;
+        uint32_t id;
+    };
+
+    struct Entry {
+        int32_t x, y, z;
+        uint32_t box;
+        uint32_t bucket;
+    };
+
+    static bool overlaps(const Box& a, const Box& b) {
+        return a.min.x <= b.max.x && a.max.x >= b.min.x &&
+            a.min.y <= b.max.y && a.max.y >= b.min.y &&
+            a.min.z <= b.max.z && a.max.z >= b.min.z;
+    }
+
+    int32_t cellOf(float v) const { return GridCells::cellOf(v, inverseCellSize); }
+
+    void build() {
+        cellSize = fixedCellSize;
+        if (cellSize <= 0.0f) {
+            // Twice the average box: most boxes touch 1-4 cells and cells still hold few boxes
+            double extent = 0.0;
+            for (const Box& b : boxes) {
+                glm::vec3 e = b.max - b.min;
+                extent += std::max(e.x, std::max(e.y, e.z));
+            }
+            cellSize = boxes.empty() ? 1.0f : static_cast<float>(2.0 * extent / boxes.size());
+            if (!(cellSize > 1e-3f)) cellSize = 1.0f;
+        }
+        inverseCellSize = 1.0f / cellSize;
+
+        entries.clear();
+        for (uint32_t k = 0; k < boxes.size(); ++k) {
+            const Box& b = boxes[k];
+            const int32_t x0 = cellOf(b.min.x), x1 = cellOf(b.max.x);
+            const int32_t y0 = cellOf(b.min.y), y1 = cellOf(b.max.y);
+            const int32_t z0 = cellOf(b.min.z), z1 = cellOf(b.max.z);
+            for (int32_t x = x0; x <= x1; ++x)
+                for (int32_t y = y0; y <= y1; ++y)
+                    for (int32_t z = z0; z <= z1; ++z)
+                        entries.push_back(Entry{ x, y, z, k, GridCells::hashCell(x, y, z) });
+        }
+
+        // Power-of-two table with about two buckets per entry
+        size_t tableSize = 1;
+        while (tableSize < entries.size() * 2) tableSize <<= 1;
+        const uint32_t mask = static_cast<uint32_t>(tableSize - 1);
+
+        // Counting sort by bucket
+        bucketStart.assign(tableSize + 1, 0);
+        for (Entry& e : entries) {
+            e.bucket &= mask;
+            ++bucketStart[e.bucket + 1];
+        }
+        for (size_t b = 1; b <= tableSize; ++b) bucketStart[b] += bucketStart[b - 1];
+
+        sorted.resize(entries.size());
+        cursor.assign(bucketStart.begin(), bucketStart.end() - 1);
+        for (const Entry& e : entries) sorted[cursor[e.bucket]++] = e;
+    }
+
+    float fixedCellSize;
+    float cellSize = 1.0f;
+    float inverseCellSize = 1.0f;
+    std::vector<Box> boxes;
+    std::vector<Entry> entries;
+    std::vector<Entry> sorted;
+    std::vector<uint32_t> bucketStart;
+    std::vector<uint32_t> cursor;
+};
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <iostream>
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+// Vertex data rebuilt every frame, written straight into GPU-visible memory.
+// One immutable buffer, persistently mapped, split into REGIONS per-frame regions: a
+// frame appends to its region and fences it at endFrame(); a region is reused only once
+// the GPU has passed its fence, so writes never touch data still being drawn.
+//
+//     stream.beginFrame();
+//     GLint first;
+//     glm::vec3* p = stream.allocate<glm::vec3>(n, first);
+//     ... fill p, glDrawArrays(mode, first, n) with positionArray() bound ...
+//     stream.endFrame();
+//
+// A frame that asks for more than a region holds gets nullptr; the regions grow to fit
+// at the next beginFrame().
+class StreamBuffer {
+public:
+    static constexpr int REGIONS = 3;
+
+    StreamBuffer() = default;
+    StreamBuffer(const StreamBuffer&) = delete;
+    StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+    ~StreamBuffer() {
+        release();
+        if (vao != 0) glDeleteVertexArrays(1, &vao);
+    }
+
+    void init(size_t bytesPerFrame) {
+        if (vao == 0) {
+            // Tightly packed vec3 positions at location 0, as the debug shaders take them
+            glCreateVertexArrays(1, &vao);
+            glEnableVertexArrayAttrib(vao, 0);
+            glVertexArrayAttribFormat(vao, 0, 3, GL_FLOAT, GL_FALSE, 0);
+            glVertexArrayAttribBinding(vao, 0, 0);
+        }
+        release();
+        regionSize = std::max<size_t>(bytesPerFrame, 1024);
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glCreateBuffers(1, &buffer);
+        glNamedBufferStorage(buffer, regionSize * REGIONS, nullptr, flags);
+        mapped = static_cast<uint8_t*>(glMapNamedBufferRange(buffer, 0, regionSize * REGIONS, flags));
+        glVertexArrayVertexBuffer(vao, 0, buffer, 0, sizeof(glm::vec3));
+        used = 0;
+    }
+
+    bool ready() const { return mapped != nullptr; }
+    GLuint id() const { return buffer; }
+    GLuint positionArray() const { return vao; }
+    size_t capacity() const { return regionSize; }     // bytes per frame
+
+    void beginFrame() {
+        if (wanted > regionSize) {
+            // Every region may still be read; let the GPU finish before freeing them
+            glFinish();
+            init(wanted + wanted / 2);
+        }
+        wanted = 0;
+        region = (region + 1) % REGIONS;
+        used = 0;
+        if (fences[region]) {
+            GLenum result = glClientWaitSync(fences[region], GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+            while (result == GL_TIMEOUT_EXPIRED) {
+                ++stalls;
+                result = glClientWaitSync(fences[region], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000); // 1 ms
+            }
+            glDeleteSync(fences[region]);
+            fences[region] = nullptr;
+        }
+    }
+
+    void endFrame() {
+        if (!ready()) return;
+        fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+
+    // `count` elements in this frame's region; `first` is the index of the first one
+    // when the buffer is read with a stride of sizeof(T) from its start
+    template <typename T>
+    T* allocate(size_t count, GLint& first) {
+        const size_t bytes = count * sizeof(T);
+        const size_t begin = region * regionSize;
+        size_t offset = begin + used;
+        offset = (offset + sizeof(T) - 1) / sizeof(T) * sizeof(T);
+        if (!ready() || offset + bytes > begin + regionSize) {
+            wanted = std::max(wanted, used + bytes + sizeof(T));
+            return nullptr;
+        }
+        used = offset + bytes - begin;
+        wanted = std::max(wanted, used);
+        first = static_cast<GLint>(offset / sizeof(T));
+        return reinterpret_cast<T*>(mapped + offset);
+    }
+
+    uint64_t stallCount() const { return stalls; }     // frames that waited for the GPU
+
+private:
+    void release() {
+        for (GLsync& f : fences) {
+            if (f) glDeleteSync(f);
+            f = nullptr;
+        }
+        if (buffer != 0) {
+            glUnmapNamedBuffer(buffer);
+            glDeleteBuffers(1, &buffer);
+        }
+        buffer = 0;
+        mapped = nullptr;
+    }
+
+    GLuint buffer = 0;
+    GLuint vao = 0;
+    uint8_t* mapped = nullptr;
+    size_t regionSize = 0;
+    int region = 0;
+    size_t used = 0;            // bytes of the current region
+    size_t wanted = 0;          // bytes this frame asked for
+    GLsync fences[REGIONS] = {};
+    uint64_t stalls = 0;
+};
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <vector>
+#include <future>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+
+#include "HeightField.hpp"
+#include "Mesh.hpp"
+
+// Bakes per-vertex terrain lighting into Vertex::Color:
+//   Color.r = sky visibility (horizon-based ambient occlusion, 0..1)
+//   Color.g = directional light visibility: how much of the horizon a light at
+//             lightElevation clears, averaged over all directions (0..1). Directional
+//             lights move, so their N.L stays dynamic and is only scaled by this.
+//   Color.b = unused (0)
+// The bake runs on worker threads; the render loop polls it and applies the result
+// once it is finished, so startup is never blocked.
+struct TerrainBakeSettings {
+    int directions = 8;          // horizon directions per sample
+    int steps = 12;              // samples per direction
+    float maxDistance = 80.0f;   // horizon search radius (world units)
+    float lightElevation = 26.6f;   // degrees above the horizon; the app's sun keeps this height
+};
+
+class TerrainBaker {
+public:
+    TerrainBaker() = default;
+    TerrainBaker(const TerrainBaker&) = delete;
+    TerrainBaker& operator=(const TerrainBaker&) = delete;
+
+    ~TerrainBaker() {
+        cancel = true;
+        for (auto& w : workers) {
+            if (w.valid()) w.wait();
+        }
+    }
+
+    void start(const HeightField& source, const TerrainBakeSettings& bakeSettings = {}) {
+        field = source;
+        settings = bakeSettings;
+        results.assign(static_cast<size_t>(field.cols) * field.rows, glm::vec3(1.0f, 0.0f, 0.0f));
+        startTime = std::chrono::steady_clock::now();
+
+        unsigned int threads = std::max(1u, std::thread::hardware_concurrency());
+        int rowsPerWorker = (field.rows + threads - 1) / threads;
+        pending = 0;
+        for (unsigned int t = 0; t < threads; ++t) {
+            int begin = t * rowsPerWorker;
+            int end = std::min(field.rows, begin + rowsPerWorker);
+            if (begin >= end) break;
+            ++pending;
+            workers.push_back(std::async(std::launch::async, [this, begin, end]() {
+                bakeRows(begin, end);
+                --pending;
+            }));
+        }
+        running = true;
+    }
+
+    // Non-blocking; true once every worker has finished
+    bool ready() const { return running && pending == 0; }
+    bool applied() const { return done; }
+
+    // Writes the baked terms into the mesh vertices and re-uploads them (GL thread only)
+    void apply(Mesh& mesh) {
+        if (!ready() || done) return;
+
+        for (auto& v : mesh.vertices) {
+            int i = static_cast<int>(std::lround((v.Position.x + field.xOffset) / field.step));
+            int j = static_cast<int>(std::lround((v.Position.z + field.zOffset) / field.step));
+            i = std::clamp(i, 0, field.cols - 1);
+            j = std::clamp(j, 0, field.rows - 1);
+            v.Color = results[static_cast<size_t>(j) * field.cols + i];
+        }
+        mesh.uploadVertices();
+
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+        std::cout << "Note: Terrain bake finished in " << elapsed.count() << " sec ("
+            << results.size() << " samples, " << workers.size() << " threads)" << std::endl;
+
+        workers.clear();
+        results.clear();
+        results.shrink_to_fit();
+        done = true;
+    }
+
+private:
+    HeightField field;
+    TerrainBakeSettings settings;
+    std::vector<glm::vec3> results;
+    std::vector<std::future<void>> workers;
+    std::atomic<int> pending{ 0 };
+    std::atomic<bool> cancel{ false };
+    bool running = false;
+    bool done = false;
+    std::chrono::steady_clock::time_point startTime;
+
+    void bakeRows(int begin, int end) {
+        for (int j = begin; j < end && !cancel; ++j) {
+            for (int i = 0; i < field.cols; ++i) {
+                results[static_cast<size_t>(j) * field.cols + i] = bakePoint(field.gridToWorld(i, j));
+            }
+        }
+    }
+
+    // Highest elevation tangent seen from p along a horizontal direction
+    float horizonTangent(const glm::vec3& p, const glm::vec2& dir) const {
+        float maxTan = 0.0f;
+        for (int s = 1; s <= settings.steps; ++s) {
+            // Denser samples near the point, where occluders matter most
+            float t = static_cast<float>(s) / settings.steps;
+            float dist = std::max(field.step, settings.maxDistance * t * t);
+            float h = field.getHeight(p.x + dir.x * dist, p.z + dir.y * dist);
+            maxTan = std::max(maxTan, (h - p.y) / dist);
+        }
+        return maxTan;
+    }
+
+    glm::vec3 bakePoint(const glm::vec3& p) const {
+        // Sky visibility: average unoccluded fraction of the hemisphere over all directions;
+        // light visibility: the same horizons against the light's elevation
+        const float lightTan = std::tan(glm::radians(settings.lightElevation));
+        float occlusion = 0.0f;
+        float lightVisibility = 0.0f;
+        for (int d = 0; d < settings.directions; ++d) {
+            float angle = glm::two_pi<float>() * d / settings.directions;
+            float tanH = horizonTangent(p, glm::vec2(std::cos(angle), std::sin(angle)));
+            occlusion += tanH / std::sqrt(1.0f + tanH * tanH); // sin(horizon angle)
+            lightVisibility += shadow(lightTan, tanH);
+        }
+        float skyVisibility = 1.0f - occlusion / settings.directions;
+        lightVisibility /= settings.directions;
+
+        return glm::vec3(skyVisibility, lightVisibility, 0.0f);
+    }
+
+    // Soft edge over a small angular range instead of a hard shadow line
+    static float shadow(float lightTan, float horizonTan) {
+        return glm::clamp((lightTan - horizonTan) * 4.0f + 1.0f, 0.0f, 1.0f);
+    }
+};
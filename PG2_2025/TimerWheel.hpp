@@ -0,0 +1,81 @@
+#pragma once
+
+#include <vector>
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+// Hierarchical timer wheel (Varghese & Lauck).
+// Level 0 has one slot per tick; each higher level covers the whole range of the level
+// below in one slot and is cascaded down when the lower level wraps. Inserting and
+// advancing one tick are O(1) plus the timers that actually move, so idle timers cost
+// nothing per tick no matter how many there are.
+class TimerWheel {
+public:
+    static constexpr uint32_t LEVEL0_BITS = 8;  // 256 ticks
+    static constexpr uint32_t LEVEL_BITS = 6;   // 64 slots per higher level
+    static constexpr uint32_t LEVELS = 4;       // 2^26 ticks, ~12 days at 60 Hz
+
+    uint64_t now() const { return currentTick; }
+    size_t size() const { return count; }
+
+    // Fires `id` when the wheel reaches `deadline` (ticks). Past deadlines fire on the next tick.
+    void schedule(uint64_t deadline, uint32_t id) {
+        if (deadline <= currentTick) deadline = currentTick + 1;
+        const uint64_t maxDelta = (uint64_t(1) << (LEVEL0_BITS + LEVEL_BITS * (LEVELS - 1))) - 1;
+        if (deadline - currentTick > maxDelta) deadline = currentTick + maxDelta;
+        insert(Timer{ deadline, id });
+        ++count;
+    }
+
+    // Advances by one tick and appends the ids that expired to `expired`
+    void tick(std::vector<uint32_t>& expired) {
+        ++currentTick;
+
+        // Cascade: whenever a level wraps, redistribute the next slot of the level above
+        for (uint32_t level = 1; level < LEVELS; ++level) {
+            uint32_t shift = LEVEL0_BITS + LEVEL_BITS * (level - 1);
+            if ((currentTick & ((uint64_t(1) << shift) - 1)) != 0) break;
+
+            std::vector<Timer>& slot = wheels[level][(currentTick >> shift) & LEVEL_MASK];
+            cascade.swap(slot);
+            for (const Timer& t : cascade) insert(t);
+            cascade.clear();
+        }
+
+        std::vector<Timer>& slot = wheels[0][currentTick & LEVEL0_MASK];
+        for (const Timer& t : slot) expired.push_back(t.id);
+        count -= slot.size();
+        slot.clear();
+    }
+
+private:
+    struct Timer {
+        uint64_t deadline;
+        uint32_t id;
+    };
+
+    static constexpr uint64_t LEVEL0_MASK = (uint64_t(1) << LEVEL0_BITS) - 1;
+    static constexpr uint64_t LEVEL_MASK = (uint64_t(1) << LEVEL_BITS) - 1;
+
+    void insert(const Timer& t) {
+        uint64_t delta = t.deadline - currentTick;
+        if (delta < (uint64_t(1) << LEVEL0_BITS)) {
+            wheels[0][t.deadline & LEVEL0_MASK].push_back(t);
+            return;
+        }
+        for (uint32_t level = 1; level < LEVELS; ++level) {
+            uint32_t shift = LEVEL0_BITS + LEVEL_BITS * (level - 1);
+            if (delta < (uint64_t(1) << (shift + LEVEL_BITS)) || level == LEVELS - 1) {
+                wheels[level][(t.deadline >> shift) & LEVEL_MASK].push_back(t);
+                return;
+            }
+        }
+    }
+
+    // Level 0 uses the first 256 slots, higher levels the first 64
+    std::array<std::array<std::vector<Timer>, (1u << LEVEL0_BITS)>, LEVELS> wheels;
+    std::vector<Timer> cascade;
+    uint64_t currentTick = 0;
+    size_t count = 0;
+};
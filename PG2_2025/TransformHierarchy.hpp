@@ -0,0 +1,234 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "JobSystem.hpp"
+
+// Parent/child transforms with cached local and world matrices.
+// Nodes are addressed by a stable id; internally they are kept in breadth-first order
+// (all roots, then all their children, ...), so a parent always comes before its
+// children and each depth level is one contiguous run. update() walks the levels in
+// order and recomputes only nodes whose own transform changed or whose parent's world
+// matrix did. Within a level nodes do not depend on each other, so a level can be
+// split across worker threads.
+//
+// Ids of destroyed nodes are reused. Destroying a node turns its children into roots.
+class TransformHierarchy {
+public:
+    using Id = uint32_t;
+    static constexpr Id NONE = UINT32_MAX;
+
+    Id create(Id parent = NONE) {
+        Id id;
+        if (!freeIds.empty()) {
+            id = freeIds.back();
+            freeIds.pop_back();
+        }
+        else {
+            id = static_cast<Id>(nodes.size());
+            nodes.emplace_back();
+        }
+        nodes[id] = Node{};
+        nodes[id].alive = true;
+        nodes[id].parent = parent;
+        if (parent != NONE) nodes[parent].children.push_back(id);
+        markDirty(id);
+        ++nodeCount;
+        orderDirty = true;
+        return id;
+    }
+
+    void destroy(Id id) {
+        Node& node = nodes[id];
+        if (!node.alive) return;
+        if (node.parent != NONE) std::erase(nodes[node.parent].children, id);
+        for (Id child : node.children) {
+            nodes[child].parent = NONE;
+            markDirty(child);
+        }
+        node = Node{};
+        freeIds.push_back(id);
+        --nodeCount;
+        orderDirty = true;
+    }
+
+    // Attaches `id` under `parent` (NONE: makes it a root); its local transform is kept.
+    // False, and nothing changes, if `parent` is `id` or one of its descendants.
+    bool setParent(Id id, Id parent) {
+        Node& node = nodes[id];
+        if (node.parent == parent) return true;
+        for (Id above = parent; above != NONE; above = nodes[above].parent) {
+            if (above == id) return false;
+        }
+        if (node.parent != NONE) std::erase(nodes[node.parent].children, id);
+        node.parent = parent;
+        if (parent != NONE) nodes[parent].children.push_back(id);
+        markDirty(id);
+        orderDirty = true;
+        return true;
+    }
+
+    Id parent(Id id) const { return nodes[id].parent; }
+    bool alive(Id id) const { return id < nodes.size() && nodes[id].alive; }
+    size_t size() const { return nodeCount; }
+
+    // === Local transform (relative to the parent): translation * rotation * scale ===
+    // Setters only mark the node dirty when the value really changes.
+
+    void setTranslation(Id id, const glm::vec3& translation) {
+        Node& node = nodes[id];
+        if (node.translation == translation) return;
+        node.translation = translation;
+        markDirty(id);
+    }
+
+    void setRotation(Id id, const glm::quat& rotation) {
+        Node& node = nodes[id];
+        if (node.rotation == rotation) return;
+        node.rotation = rotation;
+        markDirty(id);
+    }
+
+    void setScale(Id id, const glm::vec3& scale) {
+        Node& node = nodes[id];
+        if (node.scale == scale) return;
+        node.scale = scale;
+        markDirty(id);
+    }
+
+    const glm::vec3& translation(Id id) const { return nodes[id].translation; }
+    const glm::quat& rotation(Id id) const { return nodes[id].rotation; }
+    const glm::vec3& scale(Id id) const { return nodes[id].scale; }
+
+    // As of the last update()
+    const glm::mat4& local(Id id) const { return locals[nodes[id].slot]; }
+    const glm::mat4& world(Id id) const { return worlds[nodes[id].slot]; }
+    glm::vec3 worldPosition(Id id) const { return glm::vec3(worlds[nodes[id].slot][3]); }
+
+    // Recomputes the matrices of dirty nodes and everything below them
+    void update(JobSystem* jobs = nullptr) {
+        if (orderDirty) rebuildOrder();
+
+        // Only the nodes changed since the last update are touched here
+        std::fill(changed.begin(), changed.end(), 0);
+        std::fill(localStale.begin(), localStale.end(), 0);
+        for (Id id : dirtyIds) {
+            Node& node = nodes[id];
+            if (!node.alive) continue;
+            changed[node.slot] = localStale[node.slot] = 1;
+            node.dirty = false;
+        }
+        dirtyIds.clear();
+
+        for (size_t level = 0; level + 1 < levels.size(); ++level) {
+            const uint32_t first = levels[level];
+            const uint32_t count = levels[level + 1] - first;
+            auto updateRange = [&](size_t begin, size_t end, size_t) {
+                for (size_t k = first + begin; k < first + end; ++k) updateSlot(static_cast<uint32_t>(k));
+            };
+            if (jobs) jobs->parallelFor(count, UPDATE_CHUNK, updateRange);
+            else updateRange(0, count, 0);
+        }
+        recomputed = 0;
+        for (uint8_t c : changed) recomputed += c;
+    }
+
+    // Nodes whose world matrix the last update() recomputed
+    size_t lastRecomputed() const { return recomputed; }
+
+private:
+    static constexpr size_t UPDATE_CHUNK = 256;
+
+    struct Node {
+        Id parent = NONE;
+        std::vector<Id> children;
+        uint32_t slot = 0;          // position in breadth-first order
+        glm::vec3 translation{ 0.0f };
+        glm::quat rotation{ 1.0f, 0.0f, 0.0f, 0.0f };
+        glm::vec3 scale{ 1.0f };
+        bool dirty = false;         // listed in dirtyIds
+        bool alive = false;
+    };
+
+    void markDirty(Id id) {
+        if (nodes[id].dirty) return;
+        nodes[id].dirty = true;
+        dirtyIds.push_back(id);
+    }
+
+    void updateSlot(uint32_t s) {
+        const uint32_t p = parents[s];
+        if (p != NONE && changed[p]) changed[s] = 1;
+        if (!changed[s]) return;
+        if (localStale[s]) {
+            const Node& node = nodes[order[s]];
+            locals[s] = glm::translate(glm::mat4(1.0f), node.translation) * glm::mat4_cast(node.rotation);
+            if (node.scale != glm::vec3(1.0f)) locals[s] = glm::scale(locals[s], node.scale);
+        }
+        worlds[s] = p == NONE ? locals[s] : worlds[p] * locals[s];
+    }
+
+    // Breadth-first order from the roots (in id order), children in attach order.
+    // Matrices move along with their nodes, so clean nodes stay valid.
+    void rebuildOrder() {
+        std::vector<Id> newOrder;
+        newOrder.reserve(nodeCount);
+        std::vector<uint32_t> newLevels{ 0 };
+        for (Id id = 0; id < nodes.size(); ++id) {
+            if (nodes[id].alive && nodes[id].parent == NONE) newOrder.push_back(id);
+        }
+        for (size_t begin = 0; begin < newOrder.size();) {
+            const size_t end = newOrder.size();
+            newLevels.push_back(static_cast<uint32_t>(end));
+            for (size_t k = begin; k < end; ++k) {
+                for (Id child : nodes[newOrder[k]].children) newOrder.push_back(child);
+            }
+            begin = end;
+        }
+
+        // New nodes are dirty and get their matrices in update()
+        std::vector<glm::mat4> newLocals(newOrder.size(), glm::mat4(1.0f)), newWorlds(newOrder.size(), glm::mat4(1.0f));
+        for (uint32_t s = 0; s < newOrder.size(); ++s) {
+            const Node& node = nodes[newOrder[s]];
+            if (node.slot < order.size() && order[node.slot] == newOrder[s]) {
+                newLocals[s] = locals[node.slot];
+                newWorlds[s] = worlds[node.slot];
+            }
+        }
+        for (uint32_t s = 0; s < newOrder.size(); ++s) nodes[newOrder[s]].slot = s;
+
+        order = std::move(newOrder);
+        levels = std::move(newLevels);
+        locals = std::move(newLocals);
+        worlds = std::move(newWorlds);
+        parents.resize(order.size());
+        for (uint32_t s = 0; s < order.size(); ++s) {
+            const Id p = nodes[order[s]].parent;
+            parents[s] = p == NONE ? NONE : nodes[p].slot;
+        }
+        changed.assign(order.size(), 0);
+        localStale.assign(order.size(), 0);
+        orderDirty = false;
+    }
+
+    std::vector<Node> nodes;            // by id
+    std::vector<Id> freeIds;
+    std::vector<Id> dirtyIds;
+    size_t nodeCount = 0;
+    bool orderDirty = false;
+
+    // By slot, in breadth-first order
+    std::vector<Id> order;
+    std::vector<uint32_t> levels;       // first slot of each depth, plus the end
+    std::vector<uint32_t> parents;      // parent slot or NONE
+    std::vector<glm::mat4> locals;
+    std::vector<glm::mat4> worlds;
+    std::vector<uint8_t> changed;       // world matrix recomputed in this update
+    std::vector<uint8_t> localStale;    // own transform changed in this update
+    size_t recomputed = 0;
+};
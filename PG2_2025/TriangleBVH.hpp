@@ -0,0 +1,576 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <string>
+#include <functional>
+#include <stdexcept>
+#include <cmath>
+#include <cfloat>
+#include <cstdint>
+#include <cstring>
+#include <glm/glm.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define TRIANGLE_BVH_SSE 1
+#endif
+
+#include "Snapshot.hpp"
+
+// Bounding volume hierarchy over a mesh's triangles for exact ray and segment queries.
+// Built top-down with a binned surface area heuristic, then collapsed to four children
+// per node. A ray is tested against a node's four boxes at once, and every leaf holds a
+// group of up to four triangles tested together too (SSE where available). Traversal is
+// front to back with a small stack. Queries are const and may run on any number of threads.
+class TriangleBVH {
+public:
+    static constexpr uint32_t LEAF_SIZE = 4;
+
+    struct Hit {
+        float distance = FLT_MAX;
+        uint32_t triangle = UINT32_MAX;     // index into the source index buffer / 3
+        float u = 0.0f, v = 0.0f;           // barycentrics of vertices 1 and 2
+    };
+
+    bool empty() const { return nodes.empty(); }
+    size_t triangleCount() const { return triangles; }
+    size_t nodeCount() const { return nodes.size(); }
+    uint64_t getSourceHash() const { return sourceHash; }
+
+    // `indices` holds three per triangle
+    void build(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices) {
+        nodes.clear();
+        quads.clear();
+        triangles = indices.size() / 3;
+        sourceHash = hashGeometry(positions, indices);
+        if (triangles == 0) return;
+
+        std::vector<BuildTriangle> tris(triangles);
+        for (size_t t = 0; t < triangles; ++t) {
+            BuildTriangle& bt = tris[t];
+            bt.v[0] = positions[indices[t * 3]];
+            bt.v[1] = positions[indices[t * 3 + 1]];
+            bt.v[2] = positions[indices[t * 3 + 2]];
+            bt.min = glm::min(bt.v[0], glm::min(bt.v[1], bt.v[2]));
+            bt.max = glm::max(bt.v[0], glm::max(bt.v[1], bt.v[2]));
+            bt.centroid = (bt.min + bt.max) * 0.5f;
+            bt.id = static_cast<uint32_t>(t);
+        }
+
+        // Binary SAH tree first, then collapsed into four-wide nodes
+        std::vector<BinaryNode> binary;
+        binary.reserve(triangles / 2 + 1);
+        quads.reserve(triangles / 2 + 1);
+        binary.emplace_back();
+        struct Task { uint32_t node, first, count; };
+        std::vector<Task> tasks{ { 0, 0, static_cast<uint32_t>(triangles) } };
+        while (!tasks.empty()) {
+            Task task = tasks.back();
+            tasks.pop_back();
+
+            glm::vec3 min(FLT_MAX), max(-FLT_MAX), cmin(FLT_MAX), cmax(-FLT_MAX);
+            for (uint32_t i = task.first; i < task.first + task.count; ++i) {
+                min = glm::min(min, tris[i].min);
+                max = glm::max(max, tris[i].max);
+                cmin = glm::min(cmin, tris[i].centroid);
+                cmax = glm::max(cmax, tris[i].centroid);
+            }
+            binary[task.node].min = min;
+            binary[task.node].max = max;
+
+            if (task.count <= LEAF_SIZE) {
+                binary[task.node].leftOrQuad = makeLeaf(tris, task.first, task.count);
+                binary[task.node].leaf = true;
+                continue;
+            }
+
+            uint32_t mid = splitSAH(tris, task.first, task.count, cmin, cmax);
+            const uint32_t left = static_cast<uint32_t>(binary.size());
+            binary.emplace_back();
+            binary.emplace_back();
+            binary[task.node].leftOrQuad = left;
+            tasks.push_back({ left, task.first, mid - task.first });
+            tasks.push_back({ left + 1, mid, task.first + task.count - mid });
+        }
+
+        nodes.reserve(binary.size() / 3 + 1);
+        nodes.emplace_back();
+        std::vector<std::pair<uint32_t, uint32_t>> collapse{ { 0u, 0u } };   // (wide node, binary node)
+        while (!collapse.empty()) {
+            auto [wide, root] = collapse.back();
+            collapse.pop_back();
+
+            // Open the largest internal child until there are four
+            uint32_t children[4];
+            int count = 0;
+            if (binary[root].leaf) children[count++] = root;
+            else {
+                children[count++] = binary[root].leftOrQuad;
+                children[count++] = binary[root].leftOrQuad + 1;
+            }
+            while (count < 4) {
+                int open = -1;
+                float largest = -1.0f;
+                for (int k = 0; k < count; ++k) {
+                    const BinaryNode& c = binary[children[k]];
+                    if (!c.leaf && area(c.min, c.max) > largest) { largest = area(c.min, c.max); open = k; }
+                }
+                if (open < 0) break;
+                const uint32_t left = binary[children[open]].leftOrQuad;
+                children[open] = left;
+                children[count++] = left + 1;
+            }
+
+            for (int k = 0; k < 4; ++k) {
+                Node& node = nodes[wide];
+                if (k >= count) {
+                    node.child[k] = EMPTY;
+                    node.minX[k] = node.minY[k] = node.minZ[k] = FLT_MAX;
+                    node.maxX[k] = node.maxY[k] = node.maxZ[k] = -FLT_MAX;
+                    continue;
+                }
+                const BinaryNode& c = binary[children[k]];
+                node.minX[k] = c.min.x; node.minY[k] = c.min.y; node.minZ[k] = c.min.z;
+                node.maxX[k] = c.max.x; node.maxY[k] = c.max.y; node.maxZ[k] = c.max.z;
+                if (c.leaf) node.child[k] = c.leftOrQuad | LEAF;
+                else {
+                    node.child[k] = static_cast<uint32_t>(nodes.size());
+                    collapse.emplace_back(static_cast<uint32_t>(nodes.size()), children[k]);
+                    nodes.emplace_back();
+                }
+            }
+        }
+    }
+
+    // Closest triangle along the ray before maxDistance. `direction` need not be normalized;
+    // distances are in units of its length.
+    bool raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, Hit& hit) const {
+        hit = Hit{};
+        hit.distance = maxDistance;
+        traverse<false>(origin, direction, hit);
+        return hit.triangle != UINT32_MAX;
+    }
+
+    // Any triangle along the ray before maxDistance (shadow/occlusion rays stop at the first one)
+    bool occluded(const glm::vec3& origin, const glm::vec3& direction, float maxDistance) const {
+        Hit hit;
+        hit.distance = maxDistance;
+        traverse<true>(origin, direction, hit);
+        return hit.triangle != UINT32_MAX;
+    }
+
+    // True if the segment a-b crosses a triangle
+    bool segmentHits(const glm::vec3& a, const glm::vec3& b) const {
+        return occluded(a, b - a, 1.0f);
+    }
+
+    // === Serialization (section "TBVH" of a snapshot file) ===
+
+    void save(SnapshotWriter& w) const {
+        w.beginSection(Snapshot::fourcc("TBVH"));
+        w.write(sourceHash);
+        w.write(static_cast<uint64_t>(triangles));
+        w.writeArray(nodes);
+        w.writeArray(quads);
+        w.endSection();
+    }
+
+    // False (and left empty) if the snapshot has no BVH or it was built from other geometry
+    bool load(SnapshotReader& r, uint64_t expectedHash) {
+        nodes.clear();
+        quads.clear();
+        triangles = 0;
+        if (!r.openSection(Snapshot::fourcc("TBVH"))) return false;
+        if (r.read<uint64_t>() != expectedHash) return false;
+        sourceHash = expectedHash;
+        triangles = static_cast<size_t>(r.read<uint64_t>());
+        r.readArray(nodes);
+        r.readArray(quads);
+        if (!wellFormed()) {
+            nodes.clear();
+            quads.clear();
+            triangles = 0;
+            throw std::runtime_error("BVH: child or triangle index out of range");
+        }
+        return true;
+    }
+
+    static uint64_t hashGeometry(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices) {
+        std::vector<uint8_t> bytes(positions.size() * sizeof(glm::vec3) + indices.size() * sizeof(uint32_t));
+        if (!positions.empty()) std::memcpy(bytes.data(), positions.data(), positions.size() * sizeof(glm::vec3));
+        if (!indices.empty()) std::memcpy(bytes.data() + positions.size() * sizeof(glm::vec3), indices.data(), indices.size() * sizeof(uint32_t));
+        return Snapshot::hash(bytes);
+    }
+
+    // Loads the BVH cached at `cachePath` if it matches the geometry, otherwise builds it
+    // and writes the cache. Cache problems are reported and never fatal.
+    static std::shared_ptr<const TriangleBVH> loadOrBuild(const std::vector<glm::vec3>& positions,
+        const std::vector<uint32_t>& indices, const std::filesystem::path& cachePath) {
+        auto bvh = std::make_shared<TriangleBVH>();
+        const uint64_t hash = hashGeometry(positions, indices);
+        std::error_code ec;
+        if (std::filesystem::exists(cachePath, ec)) {
+            try {
+                SnapshotReader reader = SnapshotReader::fromFile(cachePath);
+                if (bvh->load(reader, hash) && bvh->triangleCount() == indices.size() / 3) return bvh;
+            }
+            catch (const std::exception& e) {
+                std::cerr << "Ignoring BVH cache " << cachePath << ": " << e.what() << std::endl;
+            }
+        }
+
+        bvh->build(positions, indices);
+        // Written aside and renamed into place: models sharing a file may build at once,
+        // and a reader never sees a partial cache
+        static std::atomic<uint32_t> writes{ 0 };
+        std::filesystem::path temporary = cachePath;
+        temporary += "." + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()))
+            + "." + std::to_string(writes++) + ".tmp";
+        try {
+            SnapshotWriter writer;
+            bvh->save(writer);
+            writer.saveToFile(temporary);
+            std::filesystem::rename(temporary, cachePath);
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Cannot write BVH cache: " << e.what() << std::endl;
+            std::filesystem::remove(temporary, ec);
+        }
+        return bvh;
+    }
+
+private:
+    static constexpr uint32_t LEAF = 0x80000000u;     // child is a quad index
+    static constexpr uint32_t EMPTY = 0xFFFFFFFFu;
+
+    // Four child boxes in SoA layout, tested against a ray at once
+    struct Node {
+        float minX[4], minY[4], minZ[4];
+        float maxX[4], maxY[4], maxZ[4];
+        uint32_t child[4];      // node index, quad index | LEAF, or EMPTY
+    };
+
+    struct BinaryNode {
+        glm::vec3 min, max;
+        uint32_t leftOrQuad = 0;   // internal: left child (right is left + 1); leaf: quad index
+        bool leaf = false;
+    };
+
+    // Four triangles in SoA layout; unused lanes are degenerate and never hit
+    struct Quad {
+        float v0x[4], v0y[4], v0z[4];
+        float e1x[4], e1y[4], e1z[4];
+        float e2x[4], e2y[4], e2z[4];
+        uint32_t id[4];
+    };
+
+    struct BuildTriangle {
+        glm::vec3 v[3];
+        glm::vec3 min, max, centroid;
+        uint32_t id;
+    };
+
+    // Every child is a later node or an existing quad, each node has one parent (so
+    // traversal ends), and triangle ids are in range
+    bool wellFormed() const {
+        std::vector<uint8_t> reached(nodes.size(), 0);
+        for (size_t n = 0; n < nodes.size(); ++n) {
+            for (uint32_t child : nodes[n].child) {
+                if (child == EMPTY) continue;
+                if (child & LEAF) {
+                    if ((child & ~LEAF) >= quads.size()) return false;
+                }
+                else if (child <= n || child >= nodes.size() || reached[child]++) return false;
+            }
+        }
+        for (const Quad& q : quads) {
+            for (uint32_t id : q.id) {
+                if (id != UINT32_MAX && id >= triangles) return false;
+            }
+        }
+        return true;
+    }
+
+    static float area(const glm::vec3& min, const glm::vec3& max) {
+        glm::vec3 e = glm::max(max - min, glm::vec3(0.0f));
+        return e.x * e.y + e.y * e.z + e.z * e.x;
+    }
+
+    uint32_t makeLeaf(const std::vector<BuildTriangle>& tris, uint32_t first, uint32_t count) {
+        Quad q{};
+        for (uint32_t k = 0; k < LEAF_SIZE; ++k) {
+            if (k < count) {
+                const BuildTriangle& t = tris[first + k];
+                glm::vec3 e1 = t.v[1] - t.v[0], e2 = t.v[2] - t.v[0];
+                q.v0x[k] = t.v[0].x; q.v0y[k] = t.v[0].y; q.v0z[k] = t.v[0].z;
+                q.e1x[k] = e1.x; q.e1y[k] = e1.y; q.e1z[k] = e1.z;
+                q.e2x[k] = e2.x; q.e2y[k] = e2.y; q.e2z[k] = e2.z;
+                q.id[k] = t.id;
+            }
+            else {
+                q.id[k] = UINT32_MAX;
+            }
+        }
+        quads.push_back(q);
+        return static_cast<uint32_t>(quads.size() - 1);
+    }
+
+    // Partitions [first, first + count) at the cheapest of 16 bins per axis; returns the split.
+    // Falls back to a median split when every centroid lands in one bin.
+    uint32_t splitSAH(std::vector<BuildTriangle>& tris, uint32_t first, uint32_t count, const glm::vec3& cmin, const glm::vec3& cmax) {
+        constexpr int BINS = 16;
+        struct Bin {
+            glm::vec3 min{ FLT_MAX }, max{ -FLT_MAX };
+            uint32_t count = 0;
+        };
+
+        float bestCost = FLT_MAX;
+        int bestAxis = -1, bestSplit = 0;
+        const glm::vec3 extent = cmax - cmin;
+        for (int axis = 0; axis < 3; ++axis) {
+            if (extent[axis] <= 0.0f) continue;
+            const float scale = BINS / extent[axis];
+            Bin bins[BINS];
+            for (uint32_t i = first; i < first + count; ++i) {
+                int b = std::min(BINS - 1, static_cast<int>((tris[i].centroid[axis] - cmin[axis]) * scale));
+                bins[b].count++;
+                bins[b].min = glm::min(bins[b].min, tris[i].min);
+                bins[b].max = glm::max(bins[b].max, tris[i].max);
+            }
+
+            // Sweep from the right, then from the left, summing areas times counts
+            float rightCost[BINS];
+            glm::vec3 rmin(FLT_MAX), rmax(-FLT_MAX);
+            uint32_t rcount = 0;
+            for (int b = BINS - 1; b > 0; --b) {
+                rmin = glm::min(rmin, bins[b].min);
+                rmax = glm::max(rmax, bins[b].max);
+                rcount += bins[b].count;
+                rightCost[b] = rcount ? area(rmin, rmax) * rcount : 0.0f;
+            }
+            glm::vec3 lmin(FLT_MAX), lmax(-FLT_MAX);
+            uint32_t lcount = 0;
+            for (int b = 0; b < BINS - 1; ++b) {
+                lmin = glm::min(lmin, bins[b].min);
+                lmax = glm::max(lmax, bins[b].max);
+                lcount += bins[b].count;
+                if (lcount == 0 || lcount == count) continue;
+                float cost = area(lmin, lmax) * lcount + rightCost[b + 1];
+                if (cost < bestCost) { bestCost = cost; bestAxis = axis; bestSplit = b + 1; }
+            }
+        }
+
+        auto begin = tris.begin() + first, end = tris.begin() + first + count;
+        if (bestAxis < 0) {
+            int axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+            auto mid = begin + count / 2;
+            std::nth_element(begin, mid, end, [axis](const BuildTriangle& a, const BuildTriangle& b) { return a.centroid[axis] < b.centroid[axis]; });
+            return first + count / 2;
+        }
+        const float scale = BINS / extent[bestAxis];
+        auto mid = std::partition(begin, end, [&](const BuildTriangle& t) {
+            return std::min(BINS - 1, static_cast<int>((t.centroid[bestAxis] - cmin[bestAxis]) * scale)) < bestSplit;
+        });
+        return static_cast<uint32_t>(mid - tris.begin());
+    }
+
+    // Entry distance of the ray into each of the node's four boxes; returns a bit per box hit
+    // Slab test of the ray against a node's four boxes. Axes in `parallel` (bit per axis)
+    // have a zero direction component: no slab crossing to compute, a box is either
+    // straddled on that axis for the whole ray or missed.
+    static int intersectNode(const Node& n, const glm::vec3& origin, const glm::vec3& inverse, int parallel, float maxDistance, float enter[4]) {
+#ifdef TRIANGLE_BVH_SSE
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        auto slab = [&](const float* lo, const float* hi, float o, float inv, bool flat, __m128& t0, __m128& t1) {
+            const __m128 bMin = _mm_loadu_ps(lo), bMax = _mm_loadu_ps(hi), vo = _mm_set1_ps(o);
+            if (flat) {
+                inside = _mm_and_ps(inside, _mm_and_ps(_mm_cmple_ps(bMin, vo), _mm_cmple_ps(vo, bMax)));
+                t0 = _mm_set1_ps(-FLT_MAX);
+                t1 = _mm_set1_ps(FLT_MAX);
+                return;
+            }
+            const __m128 vi = _mm_set1_ps(inv);
+            t0 = _mm_mul_ps(_mm_sub_ps(bMin, vo), vi);
+            t1 = _mm_mul_ps(_mm_sub_ps(bMax, vo), vi);
+        };
+        __m128 x0, x1, y0, y1, z0, z1;
+        slab(n.minX, n.maxX, origin.x, inverse.x, parallel & 1, x0, x1);
+        slab(n.minY, n.maxY, origin.y, inverse.y, parallel & 2, y0, y1);
+        slab(n.minZ, n.maxZ, origin.z, inverse.z, parallel & 4, z0, z1);
+        const __m128 tNear = _mm_max_ps(_mm_max_ps(_mm_min_ps(x0, x1), _mm_min_ps(y0, y1)),
+            _mm_max_ps(_mm_min_ps(z0, z1), _mm_setzero_ps()));
+        const __m128 tFar = _mm_min_ps(_mm_min_ps(_mm_max_ps(x0, x1), _mm_max_ps(y0, y1)),
+            _mm_min_ps(_mm_max_ps(z0, z1), _mm_set1_ps(maxDistance)));
+        _mm_storeu_ps(enter, tNear);
+        return _mm_movemask_ps(_mm_and_ps(inside, _mm_cmple_ps(tNear, tFar)));
+#else
+        int bits = 0;
+        for (int k = 0; k < 4; ++k) {
+            const glm::vec3 bMin(n.minX[k], n.minY[k], n.minZ[k]), bMax(n.maxX[k], n.maxY[k], n.maxZ[k]);
+            glm::vec3 tNear, tFar;
+            bool inside = true;
+            for (int a = 0; a < 3; ++a) {
+                if (parallel & (1 << a)) {
+                    inside = inside && bMin[a] <= origin[a] && origin[a] <= bMax[a];
+                    tNear[a] = -FLT_MAX;
+                    tFar[a] = FLT_MAX;
+                    continue;
+                }
+                const float t0 = (bMin[a] - origin[a]) * inverse[a], t1 = (bMax[a] - origin[a]) * inverse[a];
+                tNear[a] = std::min(t0, t1);
+                tFar[a] = std::max(t0, t1);
+            }
+            enter[k] = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+            float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, maxDistance));
+            if (inside && enter[k] <= exit) bits |= 1 << k;
+        }
+        return bits;
+#endif
+    }
+
+    // Moller-Trumbore against the four triangles of a quad; keeps the nearest hit
+    static bool intersectQuad(const Quad& q, const glm::vec3& o, const glm::vec3& d, Hit& hit) {
+#ifdef TRIANGLE_BVH_SSE
+        const __m128 dx = _mm_set1_ps(d.x), dy = _mm_set1_ps(d.y), dz = _mm_set1_ps(d.z);
+        const __m128 e1x = _mm_loadu_ps(q.e1x), e1y = _mm_loadu_ps(q.e1y), e1z = _mm_loadu_ps(q.e1z);
+        const __m128 e2x = _mm_loadu_ps(q.e2x), e2y = _mm_loadu_ps(q.e2y), e2z = _mm_loadu_ps(q.e2z);
+
+        // p = d x e2, det = e1 . p
+        const __m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+        const __m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+        const __m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+        const __m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+        const __m128 absDet = _mm_andnot_ps(_mm_set1_ps(-0.0f), det);
+        const __m128 valid = _mm_cmpgt_ps(absDet, _mm_set1_ps(1e-12f));
+        const __m128 invDet = _mm_div_ps(_mm_set1_ps(1.0f), _mm_or_ps(_mm_and_ps(valid, det), _mm_andnot_ps(valid, _mm_set1_ps(1.0f))));
+
+        // s = o - v0, u = (s . p) / det
+        const __m128 sx = _mm_sub_ps(_mm_set1_ps(o.x), _mm_loadu_ps(q.v0x));
+        const __m128 sy = _mm_sub_ps(_mm_set1_ps(o.y), _mm_loadu_ps(q.v0y));
+        const __m128 sz = _mm_sub_ps(_mm_set1_ps(o.z), _mm_loadu_ps(q.v0z));
+        const __m128 u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, px), _mm_mul_ps(sy, py)), _mm_mul_ps(sz, pz)), invDet);
+
+        // qv = s x e1, v = (d . qv) / det, t = (e2 . qv) / det
+        const __m128 qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(sz, e1y));
+        const __m128 qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(sx, e1z));
+        const __m128 qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(sy, e1x));
+        const __m128 v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)), invDet);
+        const __m128 t = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)), invDet);
+
+        const __m128 zero = _mm_setzero_ps();
+        __m128 mask = _mm_and_ps(valid, _mm_cmpge_ps(u, zero));
+        mask = _mm_and_ps(mask, _mm_cmpge_ps(v, zero));
+        mask = _mm_and_ps(mask, _mm_cmple_ps(_mm_add_ps(u, v), _mm_set1_ps(1.0f)));
+        mask = _mm_and_ps(mask, _mm_cmpge_ps(t, zero));
+        mask = _mm_and_ps(mask, _mm_cmplt_ps(t, _mm_set1_ps(hit.distance)));
+        int bits = _mm_movemask_ps(mask);
+        if (!bits) return false;
+
+        alignas(16) float ts[4], us[4], vs[4];
+        _mm_store_ps(ts, t);
+        _mm_store_ps(us, u);
+        _mm_store_ps(vs, v);
+        for (int k = 0; k < 4; ++k) {
+            if ((bits & (1 << k)) && ts[k] < hit.distance) hit = Hit{ ts[k], q.id[k], us[k], vs[k] };
+        }
+        return true;
+#else
+        bool any = false;
+        for (int k = 0; k < 4; ++k) {
+            const glm::vec3 e1(q.e1x[k], q.e1y[k], q.e1z[k]), e2(q.e2x[k], q.e2y[k], q.e2z[k]);
+            const glm::vec3 p = glm::cross(d, e2);
+            const float det = glm::dot(e1, p);
+            if (std::abs(det) <= 1e-12f) continue;
+            const float invDet = 1.0f / det;
+            const glm::vec3 s = o - glm::vec3(q.v0x[k], q.v0y[k], q.v0z[k]);
+            const float u = glm::dot(s, p) * invDet;
+            if (u < 0.0f || u > 1.0f) continue;
+            const glm::vec3 qv = glm::cross(s, e1);
+            const float v = glm::dot(d, qv) * invDet;
+            if (v < 0.0f || u + v > 1.0f) continue;
+            const float t = glm::dot(e2, qv) * invDet;
+            if (t < 0.0f || t >= hit.distance) continue;
+            hit = Hit{ t, q.id[k], u, v };
+            any = true;
+        }
+        return any;
+#endif
+    }
+
+    // Traversal stack; deeper than any balanced tree needs, spills to the heap otherwise
+    struct Stack {
+        static constexpr int INLINE = 64;
+        uint32_t ids[INLINE];
+        float distances[INLINE];
+        std::vector<std::pair<uint32_t, float>> overflow;
+        int count = 0;
+
+        bool empty() const { return count == 0 && overflow.empty(); }
+        void push(uint32_t id, float distance) {
+            if (count < INLINE) { ids[count] = id; distances[count] = distance; ++count; }
+            else overflow.emplace_back(id, distance);
+        }
+        uint32_t pop(float& distance) {
+            if (!overflow.empty()) {
+                auto [id, d] = overflow.back();
+                overflow.pop_back();
+                distance = d;
+                return id;
+            }
+            --count;
+            distance = distances[count];
+            return ids[count];
+        }
+    };
+
+    template<bool AnyHit>
+    void traverse(const glm::vec3& origin, const glm::vec3& direction, Hit& hit) const {
+        if (nodes.empty()) return;
+        // (bound - origin) * inverse, never bound * inverse - origin * inverse: the latter is
+        // inf - inf = NaN on an axis the ray does not move along. Those axes are tested apart.
+        glm::vec3 inverse(0.0f);
+        int parallel = 0;
+        for (int a = 0; a < 3; ++a) {
+            if (direction[a] == 0.0f) parallel |= 1 << a;
+            else inverse[a] = 1.0f / direction[a];
+        }
+
+        Stack stack;
+        stack.push(0, 0.0f);
+        while (!stack.empty()) {
+            float distance;
+            const uint32_t id = stack.pop(distance);
+            if (distance >= hit.distance) continue;
+            if (id & LEAF) {
+                if (intersectQuad(quads[id & ~LEAF], origin, direction, hit) && AnyHit) return;
+                continue;
+            }
+
+            const Node& node = nodes[id];
+            float enter[4];
+            int bits = intersectNode(node, origin, inverse, parallel, hit.distance, enter);
+
+            // Farthest pushed first so the nearest child is visited next
+            uint32_t order[4];
+            int count = 0;
+            for (int k = 0; k < 4; ++k) {
+                if (!(bits & (1 << k)) || node.child[k] == EMPTY) continue;
+                int j = count++;
+                while (j > 0 && enter[order[j - 1]] < enter[k]) { order[j] = order[j - 1]; --j; }
+                order[j] = k;
+            }
+            for (int j = 0; j < count; ++j) stack.push(node.child[order[j]], enter[order[j]]);
+        }
+    }
+
+    std::vector<Node> nodes;
+    std::vector<Quad> quads;
+    size_t triangles = 0;
+    uint64_t sourceHash = 0;
+};
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+#include "EntityStore.hpp"
+#include "BehaviorSystems.hpp"
+
+struct UpdateSchedulerSettings {
+    // Sleeping: grounded (or resting on another entity), slower than sleepSpeed, no force and no behaviors for sleepDelay seconds
+    float sleepSpeed = 0.05f;
+    float sleepDelay = 0.5f;
+
+    // Tick rate by distance to the focus point (usually the player)
+    float fullRateDistance = 150.0f;   // every step
+    float halfRateDistance = 400.0f;   // every 2nd step, beyond: every farInterval-th step
+    uint32_t farInterval = 4;
+
+    // Entity ticks (behaviors + integration) per step. Counted, not timed, so the same
+    // inputs tick the same entities on any machine and replays stay exact. Full-rate
+    // entities always run; reduced-rate entities over budget are deferred, most-starved
+    // first next step.
+    size_t ticksPerStep = 4096;
+    float maxPendingTime = 0.25f;      // longest step a deferred entity is integrated with
+};
+
+struct UpdateSchedulerStats {
+    size_t awake = 0;
+    size_t sleeping = 0;
+    size_t ticked = 0;
+    size_t deferred = 0;
+};
+
+// Decides which entities are simulated in a step and with which time step.
+// Usage per step: schedule() -> behaviors/integrate on due() with stepTimes().
+class UpdateScheduler {
+public:
+    UpdateSchedulerSettings settings;
+
+    void schedule(EntityStore& store, float dt, glm::vec3 focus, const BehaviorSystems::Systems& systems) {
+        const size_t n = store.size();
+        times.assign(n, 0.0f);
+        dueList.clear();
+        reduced.clear();
+        stats = UpdateSchedulerStats{};
+
+        const float full2 = settings.fullRateDistance * settings.fullRateDistance;
+        const float half2 = settings.halfRateDistance * settings.halfRateDistance;
+
+        for (uint32_t i = 0; i < n; ++i) {
+            Activity& a = store.activity[i];
+            const glm::vec3& v = store.velocities[i];
+            const bool pushed = store.accelerations[i] != glm::vec3(0.0f) || !(store.bodies[i].isGrounded || a.supported);
+            // Checked last, the system lookup is the expensive part
+            auto scripted = [&]() { return !store.behaviors[i].empty() || systems.contains(store.handles[i]); };
+
+            if (a.sleeping) {
+                // Typed systems are not checked here, most entities are asleep. Wake an
+                // entity explicitly (EntityStore::wake) when adding it to a system later.
+                if (!pushed && v == glm::vec3(0.0f) && store.behaviors[i].empty()) {
+                    ++stats.sleeping;
+                    continue;
+                }
+                a.sleeping = false; // woken by a force, collision or new behavior
+                a.restTime = 0.0f;
+            }
+            else if (!pushed && glm::dot(v, v) < settings.sleepSpeed * settings.sleepSpeed && !scripted()) {
+                a.restTime += dt;
+                if (a.restTime >= settings.sleepDelay) {
+                    a.sleeping = true;
+                    a.pendingTime = 0.0f;
+                    store.velocities[i] = glm::vec3(0.0f);
+                    ++stats.sleeping;
+                    continue;
+                }
+            }
+            else {
+                a.restTime = 0.0f;
+            }
+            ++stats.awake;
+
+            glm::vec3 d = store.positions[i] - focus;
+            float dist2 = glm::dot(d, d);
+            uint32_t interval = dist2 <= full2 ? 1u : (dist2 <= half2 ? 2u : settings.farInterval);
+
+            if (interval == 1) {
+                times[i] = a.pendingTime + dt;
+                a.pendingTime = 0.0f;
+                dueList.push_back(i);
+                continue;
+            }
+
+            // Staggered by slot so reduced-rate entities spread over the steps;
+            // an entity deferred by the budget stays due until it runs.
+            bool onPhase = (step + store.handles[i].index) % interval == 0;
+            bool overdue = a.pendingTime + 0.5f * dt >= interval * dt;
+            if (onPhase || overdue) {
+                reduced.push_back(i);
+            }
+            else {
+                a.pendingTime = std::min(a.pendingTime + dt, settings.maxPendingTime);
+            }
+        }
+
+        // How many reduced-rate entities fit in what is left of the budget
+        size_t left = settings.ticksPerStep > dueList.size() ? settings.ticksPerStep - dueList.size() : 0;
+        size_t room = std::min(reduced.size(), left);
+        if (room < reduced.size()) {
+            std::nth_element(reduced.begin(), reduced.begin() + room, reduced.end(), [&](uint32_t a, uint32_t b) {
+                return store.activity[a].pendingTime > store.activity[b].pendingTime;
+                });
+            for (size_t k = room; k < reduced.size(); ++k) {
+                Activity& a = store.activity[reduced[k]];
+                a.pendingTime = std::min(a.pendingTime + dt, settings.maxPendingTime);
+            }
+            stats.deferred = reduced.size() - room;
+            reduced.resize(room);
+        }
+        for (uint32_t i : reduced) {
+            Activity& a = store.activity[i];
+            times[i] = a.pendingTime + dt;
+            a.pendingTime = 0.0f;
+            dueList.push_back(i);
+        }
+        std::sort(dueList.begin(), dueList.end()); // keep memory order for integration
+
+        stats.ticked = dueList.size();
+        ++step;
+    }
+
+    // Only the step counter matters across a restore (it phases reduced-rate ticks);
+    // sleep state and pending time live in EntityStore::activity.
+    void save(SnapshotWriter& w) const {
+        w.beginSection(Snapshot::fourcc("SCHD"));
+        w.write(step);
+        w.endSection();
+    }
+
+    void load(SnapshotReader& r) {
+        if (r.openSection(Snapshot::fourcc("SCHD"))) step = r.read<uint64_t>();
+    }
+
+    const std::vector<uint32_t>& due() const { return dueList; }
+    const std::vector<float>& stepTimes() const { return times; }
+    const UpdateSchedulerStats& getStats() const { return stats; }
+
+private:
+    std::vector<uint32_t> dueList;     // dense indices to update this step
+    std::vector<uint32_t> reduced;
+    std::vector<float> times;          // per dense index, 0 = skipped
+    UpdateSchedulerStats stats;
+    uint64_t step = 0;
+};
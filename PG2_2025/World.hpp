@@ -0,0 +1,551 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <cmath>
+#include <cstdint>
+#include <array>
+#include <unordered_map>
+#include <functional>
+#include <algorithm>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "EntityStore.hpp"
+#include "HeightField.hpp"
+#include "JobSystem.hpp"
+#include "BehaviorSystems.hpp"
+#include "UpdateScheduler.hpp"
+#include "ScriptScheduler.hpp"
+#include "Particles.hpp"
+#include "Snapshot.hpp"
+#include "SpatialHash.hpp"
+#include "DynamicAABBTree.hpp"
+#include "GJK.hpp"
+#include "Frustum.hpp"
+#include "ContactSolver.hpp"
+#include "PathService.hpp"
+#include "WorldPartition.hpp"
+
+// Everything the simulation needs, without any GL state. App owns one for the windowed
+// game; Headless runs one on its own. Models referenced by entities only need bounds.
+class World {
+public:
+    static constexpr float STEP = 1.0f / 60.0f;
+
+    EntityStore entities;
+    HeightField terrain;
+    JobSystem jobs;
+    BehaviorSystems::Systems behaviorSystems;
+    UpdateScheduler scheduler;
+    Scripts::Scheduler scripts{ STEP };
+    ContactSolver contactSolver;
+    PathService paths;
+    WorldPartition partition;       // streamed entities; empty unless content is placed in it
+
+    // Pairs closer than this count as touching, with a negative depth (speculative
+    // contacts). Keeps contacts between resting bodies from flickering on and off.
+    float contactMargin = 0.02f;
+
+    // Models entities may reference; snapshots store indices into this table
+    std::vector<Model*> modelTable;
+
+    World() { behaviorSystems.followPath.setService(&paths); }
+    explicit World(unsigned int threads) : jobs(threads) { behaviorSystems.followPath.setService(&paths); }
+
+    // Navigation grid and path hierarchy for the current terrain; call after changing it
+    void buildNavigation() {
+        paths.build(terrain, &jobs);
+    }
+
+    // One simulation step. `focus` drives region streaming and the distance-based tick
+    // rates (usually the player).
+    // Player input should be applied to the entities before calling this.
+    void step(float dt, glm::vec3 focus) {
+        partition.update(entities, modelTable, focus);
+        scripts.update(entities, dt);
+        scheduler.schedule(entities, dt, focus, behaviorSystems);
+        behaviorSystems.update(entities, scheduler.stepTimes(), &jobs);
+        paths.update(&jobs);
+        entities.integrate(scheduler.due(), scheduler.stepTimes(), terrain, &jobs);
+        resolveCollisions(dt);
+        updateScene();
+        Particles::update(dt, &jobs);
+    }
+
+    // Entities, typed behavior state, scheduler phase, particles and streamed regions.
+    // Closure behaviors and running scripts are not serializable and are left as they
+    // are on load.
+    void save(SnapshotWriter& w) const {
+        entities.save(w, modelTable);
+        behaviorSystems.save(w);
+        scheduler.save(w);
+        Particles::save(w);
+        partition.save(w, entities);
+    }
+
+    // Everything is decoded and checked before any of it is swapped in, so a truncated or
+    // corrupt snapshot throws and leaves the running world as it was. `check` sees the
+    // decoded entities first and throws to reject state kept outside the world.
+    void load(SnapshotReader& r, const std::function<void(const EntityStore::Loaded&)>& check = {}) {
+        EntityStore::Loaded loadedEntities = EntityStore::decode(r, modelTable);
+        if (check) check(loadedEntities);
+        BehaviorSystems::Systems loadedSystems = behaviorSystems;
+        const bool hasSystems = loadedSystems.load(r);
+        UpdateScheduler loadedScheduler = scheduler;
+        loadedScheduler.load(r);
+        Particles::Store loadedParticles;
+        const bool hasParticles = Particles::load(r, loadedParticles);
+        WorldPartition::Loaded loadedPartition;
+        const bool hasPartition = WorldPartition::decode(r, loadedEntities, modelTable, loadedPartition);
+
+        entities.apply(std::move(loadedEntities));
+        if (hasSystems) {
+            behaviorSystems.followPath.cancelRequests();
+            behaviorSystems = std::move(loadedSystems);
+        }
+        scheduler = std::move(loadedScheduler);
+        if (hasParticles) Particles::pool = std::move(loadedParticles);
+        // Without a partition the snapshot holds every entity itself
+        if (hasPartition) partition.apply(std::move(loadedPartition));
+        else partition.clear();
+        clearContactCache();
+        updateScene();
+    }
+
+    using Contact = ::Contact;
+
+    // A pair that started touching this step
+    struct Impact {
+        EntityHandle a, b;
+        glm::vec3 point{ 0.0f };
+        glm::vec3 normal{ 0.0f };   // from a into b
+        float speed = 0.0f;         // closing speed along the normal, before the solver
+    };
+
+    // Box around entity i that holds its collider at any yaw; false if it has no model
+    bool colliderBounds(uint32_t i, glm::vec3& min, glm::vec3& max) const {
+        const Model* model = entities.models[i];
+        if (!model) return false;
+        const glm::vec3 p = entities.positions[i];
+        if (model->hull.empty()) {
+            min = p + model->boundingBoxMin;
+            max = p + model->boundingBoxMax;
+            return true;
+        }
+        const ConvexHull& hull = model->hull;
+        const glm::vec3 pivot = p + model->origin;
+        min = pivot + glm::vec3(-hull.radiusXZ, hull.minY, -hull.radiusXZ);
+        max = pivot + glm::vec3(hull.radiusXZ, hull.maxY, hull.radiusXZ);
+        return true;
+    }
+
+    // Broadphase only: pairs whose collider bounds overlap (grown by half the contact
+    // margin), each pair once, the entity with the lower slot first. Slots, unlike dense
+    // indices, keep their order when a destroy swap-removes, so a pair keeps its key,
+    // cached generations and contact normal orientation.
+    void findCandidates(std::vector<Contact>& out) {
+        out.clear();
+        broadphase.clear();
+        broadphase.reserve(entities.size());
+        glm::vec3 min, max;
+        const glm::vec3 margin(contactMargin * 0.5f);
+        for (uint32_t i = 0; i < entities.size(); ++i) {
+            if (colliderBounds(i, min, max)) broadphase.insert(i, min - margin, max + margin);
+        }
+        broadphase.forEachPair([&](uint32_t a, uint32_t b) {
+            out.push_back(entities.handles[a].index < entities.handles[b].index ? Contact{ a, b } : Contact{ b, a });
+        });
+    }
+
+    // Candidates from the broadphase that really overlap: GJK on the (yawed) convex hulls,
+    // then EPA for the normal and depth. Each pair's GJK starts from the direction its
+    // previous query ended with, which for pairs still apart is usually a separating axis.
+    // Pairs touching in the previous step carry their solver impulses over (warm start);
+    // pairs of two sleeping entities reuse last step's contact without a query.
+    //
+    // The pair tests run on the job system. Each worker thread collects its contacts and
+    // impacts in its own buffer; the buffers are merged sorted by entity handle pair, so
+    // the result is the same for any thread count.
+    void findContacts(std::vector<Contact>& out) {
+        findCandidates(candidates);
+        out.clear();
+        impacts.clear();
+        ++narrowphaseStep;
+
+        // Cache entries are looked up (or added) up front: the workers only touch their own
+        candidatePairs.resize(candidates.size());
+        for (size_t k = 0; k < candidates.size(); ++k) {
+            const Contact& c = candidates[k];
+            PairCache& cached = pairCache[pairKey(c.a, c.b)];
+            const uint32_t generationA = entities.handles[c.a].generation, generationB = entities.handles[c.b].generation;
+            if (cached.step != 0 && (cached.generationA != generationA || cached.generationB != generationB)) {
+                // A slot was recycled: the entry belongs to a dead entity's pair
+                if (cached.touching) {
+                    const uint32_t a = entities.indexOf(EntityHandle{ entities.handles[c.a].index, cached.generationA });
+                    const uint32_t b = entities.indexOf(EntityHandle{ entities.handles[c.b].index, cached.generationB });
+                    lostSupport(cached.contact, a, b, unsupported);
+                }
+                cached = PairCache{};
+            }
+            cached.wasTouching = cached.step == narrowphaseStep - 1 && cached.touching;
+            cached.step = narrowphaseStep;
+            cached.generationA = generationA;
+            cached.generationB = generationB;
+            candidatePairs[k] = &cached;
+        }
+
+        narrowphaseBuffers.resize(jobs.threadCount());
+        for (NarrowphaseBuffer& buffer : narrowphaseBuffers) buffer.clear();
+        jobs.parallelFor(candidates.size(), NARROWPHASE_CHUNK, [&](size_t begin, size_t end, size_t) {
+            NarrowphaseBuffer& buffer = narrowphaseBuffers[jobs.currentThread()];
+            for (size_t k = begin; k < end; ++k) testPair(candidates[k], *candidatePairs[k], buffer);
+        });
+
+        for (const NarrowphaseBuffer& buffer : narrowphaseBuffers) {
+            out.insert(out.end(), buffer.contacts.begin(), buffer.contacts.end());
+            impacts.insert(impacts.end(), buffer.impacts.begin(), buffer.impacts.end());
+            unsupported.insert(unsupported.end(), buffer.lost.begin(), buffer.lost.end());
+        }
+        std::sort(out.begin(), out.end(), [&](const Contact& x, const Contact& y) { return pairKey(x.a, x.b) < pairKey(y.a, y.b); });
+        std::sort(impacts.begin(), impacts.end(), [](const Impact& x, const Impact& y) {
+            return x.a.index != y.a.index ? x.a.index < y.a.index : x.b.index < y.b.index;
+        });
+
+        // Forget pairs that stopped being candidates
+        std::erase_if(pairCache, [&](const auto& entry) {
+            if (entry.second.step == narrowphaseStep) return false;
+            if (entry.second.touching) {
+                uint32_t a = entities.indexOf(EntityHandle{ static_cast<uint32_t>(entry.first >> 32), entry.second.generationA });
+                uint32_t b = entities.indexOf(EntityHandle{ static_cast<uint32_t>(entry.first), entry.second.generationB });
+                lostSupport(entry.second.contact, a, b, unsupported);
+            }
+            return true;
+        });
+        wakeUnsupported(out);
+    }
+
+    void clearContactCache() { pairCache.clear(); }
+
+    // Narrowphase for one pair of entities with models, without the cache
+    bool collide(uint32_t a, uint32_t b, Contact& contact) const {
+        glm::vec3 axis(0.0f);
+        return narrowphase(a, b, axis, contact);
+    }
+
+    // Narrowphase, then the contact solver (see ContactSolver). The impulses are kept
+    // per pair for the next step; impacts spawn a burst of particles.
+    void resolveCollisions(float dt) {
+        findContacts(contacts);
+        contactSolver.solve(entities, contacts, dt, scheduler.settings, &jobs);
+
+        for (const Contact& c : contacts) pairCache[pairKey(c.a, c.b)].contact = c;
+        for (const Impact& impact : impacts) Particles::spawn(impact.point, 100);
+    }
+
+    const std::vector<Contact>& getContacts() const { return contacts; }
+
+    // Pairs that started touching in the last step, in handle order
+    const std::vector<Impact>& getImpacts() const { return impacts; }
+
+    // === Scene queries ===
+    // Against entity bounds as of the last step. Safe to call from several threads at once
+    // while nothing steps or loads the world.
+
+    struct SceneHit {
+        EntityHandle entity;    // null if nothing was hit
+        float distance = 0.0f;
+    };
+
+    // Nearest entity along a ray (`direction` normalized)
+    SceneHit raycast(glm::vec3 origin, glm::vec3 direction, float maxDistance) const {
+        DynamicAABBTree::RayHit hit = scene.raycastClosest(origin, direction, maxDistance);
+        if (hit.proxy == DynamicAABBTree::NULL_NODE) return SceneHit{};
+        return SceneHit{ sceneHandle(hit.userData), hit.distance };
+    }
+
+    // Every entity along a ray, nearest first
+    void raycastAll(glm::vec3 origin, glm::vec3 direction, float maxDistance, std::vector<SceneHit>& out) const {
+        std::vector<DynamicAABBTree::RayHit> hits;
+        scene.raycastAll(origin, direction, maxDistance, hits);
+        for (const DynamicAABBTree::RayHit& hit : hits) out.push_back(SceneHit{ sceneHandle(hit.userData), hit.distance });
+    }
+
+    // Nearest entity along a ray, against its mesh triangles rather than its box.
+    // Boxes are visited nearest first and only boxes closer than the best hit so far are
+    // opened. Entities whose model has no mesh count as their box.
+    SceneHit raycastMesh(glm::vec3 origin, glm::vec3 direction, float maxDistance) const {
+        SceneHit best;
+        float bestDistance = maxDistance;
+        scene.raycast(origin, direction, maxDistance, [&](uint32_t slot, int32_t, float boxDistance) {
+            float d;
+            if (meshHit(slot, origin, direction, bestDistance, boxDistance, false, d)) {
+                best = SceneHit{ sceneHandle(slot), d };
+                bestDistance = d;
+            }
+            return bestDistance;
+        });
+        return best;
+    }
+
+    // True if the segment a-b crosses any entity's mesh (line of sight, shadow rays)
+    bool segmentBlocked(glm::vec3 a, glm::vec3 b) const {
+        const float length = glm::length(b - a);
+        if (length <= 0.0f) return false;
+        const glm::vec3 direction = (b - a) / length;
+        bool blocked = false;
+        scene.raycast(a, direction, length, [&](uint32_t slot, int32_t, float boxDistance) {
+            float d;
+            blocked = meshHit(slot, a, direction, length, boxDistance, true, d);
+            return blocked ? 0.0f : length;
+        });
+        return blocked;
+    }
+
+    void entitiesInSphere(glm::vec3 center, float radius, std::vector<EntityHandle>& out) const {
+        scene.querySphere(center, radius, [&](uint32_t slot, int32_t) { out.push_back(sceneHandle(slot)); return true; });
+    }
+
+    void entitiesInBox(glm::vec3 min, glm::vec3 max, std::vector<EntityHandle>& out) const {
+        scene.queryAABB(min, max, [&](uint32_t slot, int32_t) { out.push_back(sceneHandle(slot)); return true; });
+    }
+
+    void entitiesInFrustum(const Frustum& frustum, std::vector<EntityHandle>& out) const {
+        scene.queryFrustum(frustum, [&](uint32_t slot, int32_t) { out.push_back(sceneHandle(slot)); return true; });
+    }
+
+    const DynamicAABBTree& getScene() const { return scene; }
+
+    // Brings the scene tree in line with the entities: proxies of destroyed or model-less
+    // entities are dropped, new ones added, and the rest moved (cheap while they stay
+    // inside their fat boxes). step() and load() call this.
+    void updateScene() {
+        for (uint32_t slot = 0; slot < sceneProxies.size(); ++slot) {
+            SceneProxy& sp = sceneProxies[slot];
+            if (sp.proxy == DynamicAABBTree::NULL_NODE) continue;
+            uint32_t i = entities.indexOf(EntityHandle{ slot, sp.generation });
+            if (i != EntityStore::INVALID && entities.models[i]) continue;
+            scene.destroyProxy(sp.proxy);
+            sp.proxy = DynamicAABBTree::NULL_NODE;
+        }
+
+        glm::vec3 min, max;
+        for (uint32_t i = 0; i < entities.size(); ++i) {
+            if (!colliderBounds(i, min, max)) continue;
+            const EntityHandle h = entities.handles[i];
+            if (h.index >= sceneProxies.size()) sceneProxies.resize(h.index + 1);
+            SceneProxy& sp = sceneProxies[h.index];
+
+            const glm::vec3 p = entities.positions[i];
+            if (sp.proxy == DynamicAABBTree::NULL_NODE) {
+                sp.proxy = scene.createProxy(min, max, h.index);
+                sp.generation = h.generation;
+            }
+            else {
+                scene.moveProxy(sp.proxy, min, max, p - sp.lastPosition);
+            }
+            sp.lastPosition = p;
+        }
+    }
+
+private:
+    struct SceneProxy {
+        int32_t proxy = DynamicAABBTree::NULL_NODE;
+        uint32_t generation = 0;
+        glm::vec3 lastPosition{ 0.0f };
+    };
+
+    // An entity's convex shape in world space: the model hull turned by the entity's yaw
+    // the same way the mesh is drawn, or its bounding box corners if it has no hull
+    struct Collider {
+        const glm::vec3* points = nullptr;
+        size_t count = 0;
+        glm::mat3 rotation{ 1.0f };
+        glm::vec3 pivot{ 0.0f };
+        std::array<glm::vec3, 8> corners;
+
+        glm::vec3 support(const glm::vec3& direction) const {
+            const glm::vec3* pts = points ? points : corners.data();
+            const glm::vec3 local = glm::transpose(rotation) * direction;
+            size_t best = 0;
+            float bestDot = glm::dot(pts[0], local);
+            for (size_t k = 1; k < count; ++k) {
+                float d = glm::dot(pts[k], local);
+                if (d > bestDot) { bestDot = d; best = k; }
+            }
+            return pivot + rotation * pts[best];
+        }
+    };
+
+    // The rotation Mesh::draw applies for the entity's yaw
+    glm::mat3 yawRotation(uint32_t i) const {
+        return glm::mat3_cast(glm::quat(glm::radians(glm::vec3(0.0f, -entities.orientations[i].yaw - 90.0f, 0.0f))));
+    }
+
+    // Ray against one entity's triangles, in mesh space: world = position + origin + R * v
+    bool meshHit(uint32_t slot, const glm::vec3& origin, const glm::vec3& direction, float maxDistance,
+        float boxDistance, bool anyHit, float& distance) const {
+        // The tree is as of the last step: the entity may have been destroyed since
+        const uint32_t i = entities.indexOf(sceneHandle(slot));
+        if (i == EntityStore::INVALID || !entities.models[i]) return false;
+        const Model* model = entities.models[i];
+        const TriangleBVH* bvh = model->triangleBVH();
+        if (!bvh || bvh->empty()) {
+            distance = boxDistance;
+            return boxDistance < maxDistance;
+        }
+        const glm::mat3 inverse = glm::transpose(yawRotation(i));
+        const glm::vec3 localOrigin = inverse * (origin - entities.positions[i] - model->origin);
+        const glm::vec3 localDirection = inverse * direction;
+        if (anyHit) {
+            distance = boxDistance;
+            return bvh->occluded(localOrigin, localDirection, maxDistance);
+        }
+        TriangleBVH::Hit hit;
+        if (!bvh->raycast(localOrigin, localDirection, maxDistance, hit)) return false;
+        distance = hit.distance;
+        return true;
+    }
+
+    Collider colliderOf(uint32_t i) const {
+        const Model* model = entities.models[i];
+        const glm::vec3 p = entities.positions[i];
+        Collider c;
+        if (model->hull.empty()) {
+            c.pivot = p;
+            c.count = 8;
+            for (int k = 0; k < 8; ++k) {
+                c.corners[k] = glm::vec3(k & 1 ? model->boundingBoxMax.x : model->boundingBoxMin.x,
+                    k & 2 ? model->boundingBoxMax.y : model->boundingBoxMin.y,
+                    k & 4 ? model->boundingBoxMax.z : model->boundingBoxMin.z);
+            }
+            return c;
+        }
+        c.points = model->hull.points.data();
+        c.count = model->hull.points.size();
+        c.pivot = p + model->origin;
+        c.rotation = yawRotation(i);
+        return c;
+    }
+
+    bool narrowphase(uint32_t a, uint32_t b, glm::vec3& axis, Contact& contact) const {
+        const Collider A = colliderOf(a);
+        const Collider B = colliderOf(b);
+        // Both shapes grown by half the margin: rounds the difference by the whole margin
+        auto support = [&](const glm::vec3& d) {
+            const float length = glm::length(d);
+            const glm::vec3 grow = length > 0.0f ? d * (contactMargin / length) : glm::vec3(0.0f);
+            return A.support(d) - B.support(-d) + grow;
+        };
+
+        Gjk::Simplex simplex;
+        if (!Gjk::intersect(support, axis, simplex)) return false;
+        glm::vec3 normal;
+        float depth;
+        if (!Gjk::penetration(support, simplex, normal, depth)) return false;
+        depth -= contactMargin;
+
+        // Deepest point of a inside b, pulled back to the middle of the overlap (or the gap)
+        contact = Contact{ a, b, normal, depth, A.support(normal) - normal * (depth * 0.5f) };
+        return true;
+    }
+
+    struct PairCache {
+        glm::vec3 axis{ 0.0f };     // last GJK direction
+        uint64_t step = 0;          // last step the pair was a candidate
+        bool touching = false;
+        bool wasTouching = false;   // in the step before `step`
+        Contact contact{};          // as solved, if touching
+        uint32_t generationA = 0, generationB = 0;
+    };
+
+    // One worker thread's results from findContacts()
+    struct NarrowphaseBuffer {
+        std::vector<Contact> contacts;
+        std::vector<Impact> impacts;
+        std::vector<uint32_t> lost;     // see lostSupport()
+
+        void clear() {
+            contacts.clear();
+            impacts.clear();
+            lost.clear();
+        }
+    };
+
+    static constexpr size_t NARROWPHASE_CHUNK = 64;
+
+    // One candidate pair; writes only to its own cache entry and the worker's buffer
+    void testPair(const Contact& c, PairCache& cached, NarrowphaseBuffer& out) const {
+        const bool touching = cached.wasTouching;
+        if (touching && entities.activity[c.a].sleeping && entities.activity[c.b].sleeping) {
+            Contact contact = cached.contact;
+            contact.a = c.a;
+            contact.b = c.b;
+            contact.fresh = false;
+            out.contacts.push_back(contact);
+            return;
+        }
+
+        Contact contact;
+        cached.touching = narrowphase(c.a, c.b, cached.axis, contact);
+        if (!cached.touching) {
+            if (touching) lostSupport(cached.contact, c.a, c.b, out.lost);
+            return;
+        }
+        if (touching && glm::dot(contact.normal, cached.contact.normal) > 0.9f) {
+            contact.normalImpulse = cached.contact.normalImpulse;
+            contact.tangentImpulse = cached.contact.tangentImpulse - contact.normal * glm::dot(cached.contact.tangentImpulse, contact.normal);
+        }
+        contact.fresh = !touching;
+        out.contacts.push_back(contact);
+        if (contact.fresh) {
+            const float approach = glm::dot(entities.velocities[c.b] - entities.velocities[c.a], contact.normal);
+            out.impacts.push_back(Impact{ entities.handles[c.a], entities.handles[c.b], contact.point, contact.normal, std::max(-approach, 0.0f) });
+        }
+    }
+
+    // A sleeping body that stopped touching what it was resting on may have to fall.
+    // Contacts at the side change nothing for a resting body.
+    void lostSupport(const Contact& c, uint32_t a, uint32_t b, std::vector<uint32_t>& out) const {
+        if (std::abs(c.normal.y) <= ContactSolver::SUPPORT_SLOPE) return;
+        for (uint32_t i : { a, b }) {
+            if (i != EntityStore::INVALID && entities.activity[i].sleeping) out.push_back(i);
+        }
+    }
+
+    // Wakes the bodies from lostSupport() that nothing else holds up any more
+    void wakeUnsupported(const std::vector<Contact>& current) {
+        if (unsupported.empty()) return;
+        for (const Contact& c : current) {
+            if (std::abs(c.normal.y) <= ContactSolver::SUPPORT_SLOPE) continue;
+            const uint32_t upper = c.normal.y > 0.0f ? c.b : c.a;
+            std::erase(unsupported, upper);
+        }
+        for (uint32_t i : unsupported) {
+            entities.activity[i].sleeping = false;
+            entities.activity[i].supported = false;
+            entities.activity[i].restTime = 0.0f;
+        }
+        unsupported.clear();
+    }
+
+    // (lower slot, higher slot); candidates are in that order, so are the generations
+    uint64_t pairKey(uint32_t a, uint32_t b) const {
+        const uint32_t slotA = entities.handles[a].index, slotB = entities.handles[b].index;
+        return (static_cast<uint64_t>(std::min(slotA, slotB)) << 32) | std::max(slotA, slotB);
+    }
+
+    EntityHandle sceneHandle(uint32_t slot) const { return EntityHandle{ slot, sceneProxies[slot].generation }; }
+
+    SpatialHash broadphase;
+    std::vector<Contact> candidates;
+    std::vector<Contact> contacts;
+    std::vector<uint32_t> unsupported;
+    std::vector<Impact> impacts;
+    std::vector<PairCache*> candidatePairs;             // by candidate
+    std::vector<NarrowphaseBuffer> narrowphaseBuffers;  // by worker thread
+    std::unordered_map<uint64_t, PairCache> pairCache;  // by (lower slot, higher slot)
+    uint64_t narrowphaseStep = 0;
+    DynamicAABBTree scene;
+    std::vector<SceneProxy> sceneProxies;   // by entity slot
+};
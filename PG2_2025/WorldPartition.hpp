@@ -0,0 +1,534 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <chrono>
+#include <future>
+#include <fstream>
+#include <iostream>
+#include <filesystem>
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <glm/glm.hpp>
+
+#include "EntityStore.hpp"
+#include "Snapshot.hpp"
+
+struct WorldPartitionSettings {
+    float regionSize = 128.0f;
+    float loadRadius = 384.0f;      // regions closer than this to the focus are loaded
+    float unloadRadius = 512.0f;    // and frozen again once farther than this
+    size_t spawnsPerStep = 64;      // entities instantiated per step; a count, so runs replay exactly
+    double spawnBudgetMs = 0.0;     // optional extra cap by measured time (at least one entity);
+                                    // 0 = off, leave off for deterministic runs and replays
+    std::filesystem::path directory;    // frozen regions go here; empty: kept in memory
+};
+
+struct WorldPartitionStats {
+    size_t regions = 0;
+    size_t active = 0;          // regions with live entities (fully or partly spawned)
+    size_t loading = 0;
+    size_t liveEntities = 0;
+    size_t frozenEntities = 0;
+    size_t frozenBytes = 0;     // encoded and held in memory
+    size_t spawned = 0;         // in the last update
+    size_t frozen = 0;          // in the last update
+};
+
+// The entities a region stores while frozen (SoA, like EntityStore)
+struct RegionEntities {
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec3> velocities;
+    std::vector<Orientation> orientations;
+    std::vector<PhysicsBody> bodies;
+    std::vector<uint32_t> modelRefs;        // index into the model table + 1, 0: none
+    std::vector<std::string> names;         // empty: unnamed
+
+    size_t size() const { return positions.size(); }
+
+    void clear() {
+        positions.clear(); velocities.clear(); orientations.clear();
+        bodies.clear(); modelRefs.clear(); names.clear();
+    }
+
+    void push(const glm::vec3& position, const glm::vec3& velocity, const Orientation& orientation,
+        const PhysicsBody& body, uint32_t modelRef, std::string_view name) {
+        positions.push_back(position);
+        velocities.push_back(velocity);
+        orientations.push_back(orientation);
+        bodies.push_back(body);
+        modelRefs.push_back(modelRef);
+        names.emplace_back(name);
+    }
+
+    void save(SnapshotWriter& w) const {
+        w.beginSection(Snapshot::fourcc("RGNE"));
+        w.writeArray(positions);
+        w.writeArray(velocities);
+        w.writeArray(orientations);
+        w.writeArray(bodies);
+        w.writeArray(modelRefs);
+        for (const std::string& name : names) w.writeString(name);
+        w.endSection();
+    }
+
+    void load(SnapshotReader& r) {
+        clear();
+        if (!r.openSection(Snapshot::fourcc("RGNE"))) throw std::runtime_error("Region has no entities");
+        r.readArray(positions);
+        r.readArray(velocities);
+        r.readArray(orientations);
+        r.readArray(bodies);
+        r.readArray(modelRefs);
+        const size_t n = positions.size();
+        if (velocities.size() != n || orientations.size() != n || bodies.size() != n || modelRefs.size() != n) {
+            throw std::runtime_error("Region: entity arrays differ in size");
+        }
+        names.resize(n);
+        for (std::string& name : names) name = r.readString();
+    }
+};
+
+// Splits the world into square regions that are simulated only near the focus.
+// Entities placed through the partition belong to a region; entities created directly
+// in the EntityStore (player, camera, scripted props) are not touched.
+//
+// Each update():
+// - Frozen regions in range start loading on a worker thread (file read + decode).
+// - Loaded regions are instantiated on the calling thread, a fixed number of entities
+//   per step, so a region appearing never stalls a frame.
+// - Regions out of range are frozen: their live entities are encoded (one binary
+//   snapshot per region) and destroyed, and written to disk on a worker thread if a
+//   directory is set. Members that walked into another live region move there instead.
+// Simulation cost and, with a directory, memory follow the live regions only.
+// A region that cannot be read or decoded is logged and stays frozen with its content,
+// until it next leaves the range; one that cannot be written stays in memory instead.
+// Typed behaviors, scripts and closures are not stored, as in world snapshots. World
+// snapshots store every region's content and live members (PRTN section).
+class WorldPartition {
+public:
+    WorldPartitionSettings settings;
+
+    ~WorldPartition() {
+        wait();
+    }
+
+    // Adds an entity to the content of the (frozen) region containing `position`; it
+    // is created when the region is next loaded
+    void place(const glm::vec3& position, Model* model, const std::vector<Model*>& modelTable, std::string_view name = {}) {
+        Region& region = regions[keyOf(position)];
+        if (region.state != State::Frozen) throw std::runtime_error("WorldPartition: place() into a live region");
+        region.placed.push(position, glm::vec3(0.0f), Orientation{}, PhysicsBody{}, modelRef(model, modelTable), name);
+    }
+
+    // Encodes what place() added to frozen regions (and writes it out if a directory is
+    // set), so unvisited regions cost no more than their encoded size. Call after placing
+    // a batch; regions that are loading keep theirs until they are loaded.
+    void commit() {
+        for (auto& [key, region] : regions) {
+            if (region.state != State::Frozen || region.loading.valid() || region.placed.size() == 0) continue;
+            RegionEntities content;
+            if (region.count > 0) {
+                finishWrite(key, region);
+                try {
+                    content = region.onDisk ? decode(SnapshotReader::readFile(fileOf(key))) : decode(region.frozen);
+                }
+                catch (const std::exception& e) {
+                    std::cerr << "WorldPartition: " << e.what() << ", placed entities kept for the next load" << std::endl;
+                    continue;
+                }
+            }
+            append(content, region.placed, 0);
+            region.placed = RegionEntities{};
+            storeFrozen(key, region, content);
+        }
+    }
+
+    void update(EntityStore& store, const std::vector<Model*>& modelTable, const glm::vec3& focus) {
+        stats.spawned = stats.frozen = 0;
+        keys.clear();
+        for (const auto& [key, region] : regions) keys.push_back(key);
+        std::sort(keys.begin(), keys.end());    // same order every run
+
+        // Out of range: freeze (live) or start loading (frozen, in range)
+        for (uint64_t key : keys) {
+            Region& region = regions[key];
+            const float distance = distanceTo(key, focus);
+            if (region.state == State::Frozen) {
+                if (distance > settings.unloadRadius) region.failed = false;
+                if (region.failed || region.loading.valid() || distance > settings.loadRadius || region.count + region.placed.size() == 0) continue;
+                if (region.writing.valid()) {
+                    // Freshly frozen: loaded once its write is done
+                    if (region.writing.wait_for(std::chrono::seconds(0)) != std::future_status::ready) continue;
+                    finishWrite(key, region);
+                }
+                startLoading(key, region);
+            }
+            else if (distance > settings.unloadRadius) {
+                freeze(key, region, store, modelTable);
+            }
+        }
+
+        // Finished loads start spawning; spawning shares one budget
+        auto start = Clock::now();
+        size_t room = std::max<size_t>(1, settings.spawnsPerStep);
+        if (settings.spawnBudgetMs > 0.0 && costPerSpawnMs > 0.0) {
+            room = std::min(room, std::max<size_t>(1, static_cast<size_t>(settings.spawnBudgetMs / costPerSpawnMs)));
+        }
+        size_t spawned = 0;
+        for (uint64_t key : keys) {
+            Region& region = regions[key];
+            if (region.state == State::Frozen && region.loading.valid()
+                && region.loading.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+                try {
+                    region.staged = region.loading.get();
+                    checkModels(region.staged, modelTable);
+                }
+                catch (const std::exception& e) {
+                    std::cerr << "WorldPartition: " << e.what() << ", region " << fileOf(key).filename().string() << " kept frozen" << std::endl;
+                    region.staged.clear();
+                    region.failed = true;
+                    continue;
+                }
+                region.frozen.clear();
+                region.count = 0;
+                append(region.staged, region.placed, 0);
+                region.placed.clear();
+                if (distanceTo(key, focus) > settings.unloadRadius) {
+                    storeFrozen(key, region, region.staged);    // left the range while loading
+                    region.staged.clear();
+                    continue;
+                }
+                region.nextSpawn = 0;
+                region.state = State::Spawning;
+            }
+            if (region.state != State::Spawning) continue;
+            const size_t n = std::min(room - spawned, region.staged.size() - region.nextSpawn);
+            spawn(region, n, store, modelTable);
+            spawned += n;
+            if (region.nextSpawn == region.staged.size()) {
+                region.staged.clear();
+                region.nextSpawn = 0;
+                region.state = State::Active;
+            }
+            if (spawned == room) break;
+        }
+        if (spawned > 0 && settings.spawnBudgetMs > 0.0) {
+            const double perSpawn = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / spawned;
+            costPerSpawnMs = costPerSpawnMs > 0.0 ? costPerSpawnMs * 0.9 + perSpawn * 0.1 : perSpawn;
+        }
+        stats.spawned = spawned;
+
+        stats.regions = regions.size();
+        stats.active = stats.loading = stats.liveEntities = stats.frozenEntities = stats.frozenBytes = 0;
+        for (const auto& [key, region] : regions) {
+            stats.active += region.state != State::Frozen;
+            stats.loading += region.loading.valid();
+            stats.liveEntities += region.members.size();
+            stats.frozenEntities += region.count + region.placed.size() + region.staged.size() - region.nextSpawn;
+            stats.frozenBytes += region.frozen.size();
+        }
+    }
+
+    const WorldPartitionStats& getStats() const { return stats; }
+
+    // Region containing a world position, as (column, row)
+    glm::ivec2 regionOf(const glm::vec3& p) const {
+        return glm::ivec2(static_cast<int>(std::floor(p.x / settings.regionSize)), static_cast<int>(std::floor(p.z / settings.regionSize)));
+    }
+
+    bool live(const glm::ivec2& r) const {
+        auto it = regions.find(key(r.x, r.y));
+        return it != regions.end() && it->second.state != State::Frozen;
+    }
+
+    // A decoded, checked PRTN section, not yet part of the partition
+    struct SavedRegion {
+        uint64_t key = 0;
+        bool live = false;
+        std::vector<EntityHandle> members;
+        RegionEntities content;             // not instantiated: frozen, placed or staged
+    };
+    using Loaded = std::vector<SavedRegion>;
+
+    // Each region with its content decoded, so the section does not depend on the
+    // directory; waits for pending writes and reads frozen regions back from disk
+    void save(SnapshotWriter& w, const EntityStore& store) const {
+        std::vector<uint64_t> sorted;
+        for (const auto& [key, region] : regions) sorted.push_back(key);
+        std::sort(sorted.begin(), sorted.end());
+
+        w.beginSection(Snapshot::fourcc("PRTN"));
+        w.write(static_cast<uint64_t>(sorted.size()));
+        for (uint64_t key : sorted) {
+            const Region& region = regions.at(key);
+            RegionEntities content = frozenContent(key, region);
+            append(content, region.staged, region.nextSpawn);
+            append(content, region.placed, 0);
+            std::vector<EntityHandle> members;
+            for (EntityHandle h : region.members) {
+                if (store.indexOf(h) != EntityStore::INVALID) members.push_back(h);
+            }
+            SnapshotWriter encoded;
+            content.save(encoded);
+            w.write(key);
+            w.write(static_cast<uint8_t>(region.state != State::Frozen));
+            w.writeArray(members);
+            w.writeArray(encoded.buffer);
+        }
+        w.endSection();
+    }
+
+    // Reads and validates against the entities being loaded; false if the snapshot has
+    // no partition, throws on a truncated or inconsistent section
+    static bool decode(SnapshotReader& r, const EntityStore::Loaded& entities, const std::vector<Model*>& modelTable, Loaded& out) {
+        out.clear();
+        if (!r.openSection(Snapshot::fourcc("PRTN"))) return false;
+        const uint64_t n = r.read<uint64_t>();
+        std::unordered_set<uint64_t> keys;
+        std::unordered_set<uint32_t> members;
+        for (uint64_t i = 0; i < n; ++i) {
+            SavedRegion saved;
+            saved.key = r.read<uint64_t>();
+            saved.live = r.read<uint8_t>() != 0;
+            r.readArray(saved.members);
+            std::vector<uint8_t> bytes;
+            r.readArray(bytes);
+            saved.content = decode(std::move(bytes));
+            checkModels(saved.content, modelTable);
+            if (!keys.insert(saved.key).second) throw std::runtime_error("Partition: region saved twice");
+            if (!saved.live && !saved.members.empty()) throw std::runtime_error("Partition: frozen region with live members");
+            for (EntityHandle h : saved.members) {
+                if (!entities.contains(h) || !members.insert(h.index).second) throw std::runtime_error("Partition: bad region member");
+            }
+            out.push_back(std::move(saved));
+        }
+        return true;
+    }
+
+    // Replaces every region; regions saved live keep their members and instantiate the
+    // rest of their content as usual
+    void apply(Loaded&& loaded) {
+        wait();
+        regions.clear();
+        for (SavedRegion& saved : loaded) {
+            Region& region = regions[saved.key];
+            if (!saved.live) {
+                storeFrozen(saved.key, region, saved.content);
+                continue;
+            }
+            region.members = std::move(saved.members);
+            region.staged = std::move(saved.content);
+            region.state = region.staged.size() > 0 ? State::Spawning : State::Active;
+        }
+    }
+
+    // Forgets every region, e.g. when loading a snapshot saved without a partition
+    void clear() {
+        wait();
+        regions.clear();
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    enum class State : uint8_t { Frozen, Spawning, Active };
+
+    struct Region {
+        State state = State::Frozen;
+        size_t count = 0;                       // entities in the encoded content
+        std::vector<uint8_t> frozen;            // encoded content when kept in memory
+        RegionEntities placed;                  // added by place(), not encoded yet
+        bool onDisk = false;
+        bool failed = false;                    // last load failed: not retried while in range
+        std::future<RegionEntities> loading;
+        std::shared_future<std::vector<uint8_t>> writing;   // the bytes back if they could not be written
+        RegionEntities staged;                  // loaded, being instantiated
+        size_t nextSpawn = 0;
+        std::vector<EntityHandle> members;      // live entities
+    };
+
+    static uint64_t key(int x, int z) {
+        return static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32 | static_cast<uint32_t>(z);
+    }
+
+    uint64_t keyOf(const glm::vec3& p) const {
+        const glm::ivec2 r = regionOf(p);
+        return key(r.x, r.y);
+    }
+
+    // Horizontal distance from the focus to the region's square (0 inside)
+    float distanceTo(uint64_t k, const glm::vec3& focus) const {
+        const float x0 = static_cast<float>(static_cast<int32_t>(k >> 32)) * settings.regionSize;
+        const float z0 = static_cast<float>(static_cast<int32_t>(k & 0xffffffffu)) * settings.regionSize;
+        const float dx = std::max({ x0 - focus.x, 0.0f, focus.x - (x0 + settings.regionSize) });
+        const float dz = std::max({ z0 - focus.z, 0.0f, focus.z - (z0 + settings.regionSize) });
+        return std::sqrt(dx * dx + dz * dz);
+    }
+
+    std::filesystem::path fileOf(uint64_t k) const {
+        return settings.directory / ("region_" + std::to_string(static_cast<int32_t>(k >> 32)) + "_"
+            + std::to_string(static_cast<int32_t>(k & 0xffffffffu)) + ".bin");
+    }
+
+    static uint32_t modelRef(Model* model, const std::vector<Model*>& modelTable) {
+        if (!model) return 0;
+        auto it = std::find(modelTable.begin(), modelTable.end(), model);
+        if (it == modelTable.end()) throw std::runtime_error("WorldPartition: entity model is not in the model table");
+        return static_cast<uint32_t>(it - modelTable.begin()) + 1;
+    }
+
+    static RegionEntities decode(std::vector<uint8_t>&& bytes) {
+        RegionEntities content;
+        if (bytes.empty()) return content;
+        SnapshotReader reader(std::move(bytes));
+        content.load(reader);
+        return content;
+    }
+
+    static RegionEntities decode(const std::vector<uint8_t>& bytes) {
+        RegionEntities content;
+        if (bytes.empty()) return content;
+        SnapshotReader reader(bytes);
+        content.load(reader);
+        return content;
+    }
+
+    static void checkModels(const RegionEntities& content, const std::vector<Model*>& modelTable) {
+        for (uint32_t ref : content.modelRefs) {
+            if (ref > modelTable.size()) throw std::runtime_error("Region: unknown model index");
+        }
+    }
+
+    static void append(RegionEntities& to, const RegionEntities& from, size_t first) {
+        for (size_t i = first; i < from.size(); ++i) {
+            to.push(from.positions[i], from.velocities[i], from.orientations[i], from.bodies[i], from.modelRefs[i], from.names[i]);
+        }
+    }
+
+    void storeFrozen(uint64_t k, Region& region, const RegionEntities& content) {
+        finishWrite(k, region);     // older content, about to be replaced
+        region.count = content.size();
+        region.onDisk = false;
+        region.frozen.clear();
+        if (content.size() == 0) return;
+        SnapshotWriter w;
+        content.save(w);
+        if (settings.directory.empty()) {
+            region.frozen = std::move(w.buffer);
+            return;
+        }
+        region.onDisk = true;
+        std::filesystem::path path = fileOf(k);
+        region.writing = std::async(std::launch::async, [buffer = std::move(w.buffer), path]() mutable {
+            std::error_code error;
+            std::filesystem::create_directories(path.parent_path(), error);
+            // Written aside and renamed over the old file, so a crash mid-write never leaves
+            // a torn region; one write per region is in flight, so the name is unique
+            std::filesystem::path temporary = path;
+            temporary += ".tmp";
+            {
+                std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+                if (!file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size()) || !file.flush()) error = std::make_error_code(std::errc::io_error);
+            }
+            if (!error) std::filesystem::rename(temporary, path, error);
+            if (!error) return std::vector<uint8_t>();
+            std::filesystem::remove(temporary, error);
+            return std::move(buffer);
+        });
+    }
+
+    // Waits for the region's write; content that could not be written stays in memory
+    void finishWrite(uint64_t k, Region& region) {
+        if (!region.writing.valid()) return;
+        const std::vector<uint8_t>& unwritten = region.writing.get();
+        if (!unwritten.empty()) {
+            std::cerr << "WorldPartition: cannot write " << fileOf(k).string() << ", region kept in memory" << std::endl;
+            region.frozen = unwritten;
+            region.onDisk = false;
+        }
+        region.writing = {};
+    }
+
+    // The encoded content of a frozen region, wherever it is
+    RegionEntities frozenContent(uint64_t k, const Region& region) const {
+        if (region.count == 0) return RegionEntities{};
+        if (region.writing.valid() && !region.writing.get().empty()) return decode(region.writing.get());
+        return region.onDisk ? decode(SnapshotReader::readFile(fileOf(k))) : decode(region.frozen);
+    }
+
+    void wait() {
+        for (auto& [key, region] : regions) {
+            if (region.loading.valid()) region.loading.wait();
+            if (region.writing.valid()) region.writing.wait();
+        }
+    }
+
+    // The frozen content stays with the region until the load succeeds
+    void startLoading(uint64_t k, Region& region) {
+        if (region.onDisk && region.count > 0) {
+            region.loading = std::async(std::launch::async, [path = fileOf(k)]() {
+                return decode(SnapshotReader::readFile(path));
+            });
+        }
+        else {
+            region.loading = std::async(std::launch::async, [bytes = region.frozen]() mutable {
+                return decode(std::move(bytes));
+            });
+        }
+    }
+
+    void spawn(Region& region, size_t n, EntityStore& store, const std::vector<Model*>& modelTable) {
+        const RegionEntities& c = region.staged;
+        for (size_t k = region.nextSpawn; k < region.nextSpawn + n; ++k) {
+            EntityHandle h = store.create(c.positions[k], c.modelRefs[k] ? modelTable[c.modelRefs[k] - 1] : nullptr);
+            const uint32_t d = store.indexOf(h);
+            store.velocities[d] = c.velocities[k];
+            store.orientations[d] = c.orientations[k];
+            store.bodies[d] = c.bodies[k];
+            store.previousYaws[d] = c.orientations[k].yaw;
+            if (!c.names[k].empty()) store.setName(h, c.names[k]);
+            region.members.push_back(h);
+        }
+        region.nextSpawn += n;
+    }
+
+    void freeze(uint64_t k, Region& region, EntityStore& store, const std::vector<Model*>& modelTable) {
+        RegionEntities content;
+        for (EntityHandle h : region.members) {
+            const uint32_t d = store.indexOf(h);
+            if (d == EntityStore::INVALID) continue;    // destroyed by the game
+            const uint64_t now = keyOf(store.positions[d]);
+            if (now != k) {
+                auto it = regions.find(now);
+                if (it != regions.end() && it->second.state == State::Active) {
+                    it->second.members.push_back(h);
+                    continue;
+                }
+            }
+            content.push(store.positions[d], store.velocities[d], store.orientations[d], store.bodies[d],
+                modelRef(store.models[d], modelTable), store.nameOf(h));
+            store.destroy(h);
+        }
+        // Not yet instantiated
+        append(content, region.staged, region.nextSpawn);
+        append(content, region.placed, 0);
+        region.placed.clear();
+        stats.frozen += content.size();
+
+        region.members.clear();
+        region.staged.clear();
+        region.nextSpawn = 0;
+        region.state = State::Frozen;
+        storeFrozen(k, region, content);
+    }
+
+    std::unordered_map<uint64_t, Region> regions;
+    std::vector<uint64_t> keys;
+    double costPerSpawnMs = 0.0;        // moving average
+    WorldPartitionStats stats;
+};
@@ -191,6 +191,65 @@ void App::init_hm()
     height_map = MapGen::GenHeightMap(hmap, 5, heightScale);
     height_map.getUniques();
     std::cout << "Note: Heightmap vertices: " << height_map.vertices.size() << std::endl;
+
+    // Bake terrain AO + sun visibility in the background, swapped in by run() once done
+    world.terrain = MapGen::GenHeightField(hmap, 5, heightScale);
+    world.buildNavigation();
+    terrain_baked_shader = ShaderProgram("assets/shaders/01_shaded_sample/basic_baked.vert",
+        "assets/shaders/01_shaded_sample/basic_baked.frag");
+    terrain_bake.start(world.terrain);
+
+    init_scatter();
+    init_props();
+}
+
+void App::init_props()
+{
+    // Jittered grid over the whole map, placed into the world partition: only regions
+    // near the camera are instantiated and simulated
+    const HeightField& terrain = world.terrain;
+    const float width = (terrain.cols - 1) * terrain.step;
+    const float depth = (terrain.rows - 1) * terrain.step;
+    const float spacing = 20.0f;
+    std::mt19937 rng(46);
+    std::uniform_real_distribution<float> jitter(-0.4f * spacing, 0.4f * spacing);
+    size_t placed = 0;
+    for (float z = 0.5f * spacing; z < depth; z += spacing) {
+        for (float x = 0.5f * spacing; x < width; x += spacing) {
+            const float px = x + jitter(rng) - terrain.xOffset;
+            const float pz = z + jitter(rng) - terrain.zOffset;
+            world.partition.place(glm::vec3(px, terrain.getHeight(px, pz) + 1.0f, pz), propModel, world.modelTable);
+            ++placed;
+        }
+    }
+    world.partition.commit();
+    std::cout << "Note: streamed props: " << placed << std::endl;
+}
+
+void App::init_scatter()
+{
+    ShaderProgram scatter_shader("assets/shaders/scatter.vert",
+        "assets/shaders/01_shaded_sample/basic.frag");
+
+    Model* propModel = new Model("assets/obj/teapot_tri_vnt.obj", scatter_shader);
+    propModel->setTexture(textureInit("assets/box.png"));
+
+    std::vector<ScatterRule> rules;
+
+    ScatterRule props;
+    props.model = propModel;
+    props.density = 0.05f;
+    props.minHeight = 0.1f * heightScale;
+    props.maxHeight = 0.7f * heightScale;
+    props.maxSlope = 25.0f;
+    props.minScale = 0.15f;
+    props.maxScale = 0.35f;
+    props.fadeStart = 100.0f;
+    props.fadeEnd = 250.0f;
+    rules.push_back(props);
+
+    // Generated on worker threads, uploaded by the first draw after it finishes
+    scatter.generate(world.terrain, rules);
 }
 
 GLuint App::textureInit(const std::filesystem::path& file_name)
@@ -262,22 +321,36 @@ void App::init_assets(void) {
     GLuint tex = textureInit("assets/box.png");
     teapotModel->setTexture(tex);
     teapotModel->alpha = 0.5f;
-    entities.emplace("teapot", new Entity(glm::vec3(20, 5, 5), teapotModel));
-    entities.emplace("teapot2", new Entity(glm::vec3(30, 5, 5), teapotModel));
+    EntityHandle teapot = world.entities.create(glm::vec3(20, 5, 5), teapotModel);
+    world.entities.setName(teapot, "teapot");
+    world.entities.setName(world.entities.create(glm::vec3(30, 5, 5), teapotModel), "teapot2");
 
     Model* teapotModel2 = new Model("assets/obj/teapot_tri_vnt.obj", my_shader);
     teapotModel2->setTexture(tex);
-    entities.emplace("teapot3", new Entity(glm::vec3(40, 5, 5), teapotModel2));
+    EntityHandle teapot3 = world.entities.create(glm::vec3(40, 5, 5), teapotModel2);
+    world.entities.setName(teapot3, "teapot3");
 
     Model* cameraModel = new Model("assets/obj/minecraft_simple_rig.obj", my_shader);
     GLuint tex1 = textureInit("assets/textures/Char.png");
-    camera.addModel(cameraModel);
     cameraModel->setTexture(tex1);
-    entities.insert(std::make_pair("camera", &camera));
+    world.entities.setName(camera.attach(world.entities, cameraModel), "camera");
 
     Model* FishModel = new Model("assets/obj/fish.obj", my_shader);
-    Entity* fish = new Entity(glm::vec3(5, 5, 5), FishModel);
-    entities.emplace("fish", fish); // passes a pointer
+    EntityHandle fish = world.entities.create(glm::vec3(5, 5, 5), FishModel);
+    world.entities.setName(fish, "fish");
+    // Props over the whole map, streamed around the camera (init_props)
+    propModel = new Model("assets/obj/teapot_tri_vnt.obj", my_shader);
+    propModel->setTexture(tex);
+    world.modelTable = { teapotModel, teapotModel2, cameraModel, FishModel, propModel };
+    world.scripts.start(fish, ScriptedBehaviors::Patrol({ glm::vec3(5, 0, 5), glm::vec3(40, 0, -20), glm::vec3(-30, 0, -30) }));
+
+    // School trailing the patrolling fish
+    world.behaviorSystems.flock.add(fish);
+    for (int i = 0; i < 48; ++i) {
+        EntityHandle member = world.entities.create(glm::vec3(5.0f + (i % 8) * 1.5f, 5.0f, 8.0f + (i / 8) * 1.5f), FishModel);
+        world.behaviorSystems.flock.add(member);
+    }
+    world.scripts.start(teapot3, ScriptedBehaviors::PeriodicJump(8.0f, 3.0f));
 
 
     // Create and load data into GPU using OpenGL DSA (Direct State Access)
@@ -330,8 +403,6 @@ int App::run(void)
         debug = false;
         ShaderProgram debug_shader("assets/shaders/debug.vert",
             "assets/shaders/debug.frag");
-        ShaderProgram particle_shader("assets/shaders/particles.vert",
-            "assets/shaders/particles.frag");
         glDebugMessageControl(GL_DEBUG_SOURCE_API, GL_DEBUG_TYPE_OTHER, GL_DEBUG_SEVERITY_NOTIFICATION, 0, nullptr, GL_FALSE);
 
         DirectionalLight* sun = new DirectionalLight();
@@ -352,8 +423,9 @@ int App::run(void)
         lights.push_back(flashlight);
 		lights.push_back(pointLight);
 
-        entities["teapot"]->addBehavior(Behaviors::WalkInCircle(glm::vec3(10, 0, 10), 50.0f, 10.0f));
-        entities["teapot"]->addBehavior(Behaviors::PeriodicJump(7.0f, 3.0f));
+        EntityHandle teapot = world.entities.find("teapot");
+        world.behaviorSystems.walkInCircle.add(teapot, glm::vec3(10, 0, 10), 50.0f, 10.0f);
+        world.behaviorSystems.periodicJump.add(teapot, 7.0f, 3.0f);
 
         // Get uniform location in GPU program
         GLint uniform_color_location = glGetUniformLocation(shader_prog_ID, "uniform_Color");
@@ -362,8 +434,11 @@ int App::run(void)
         }
 
         glEnable(GL_DEPTH_TEST); // Enable depth testing
+        frameStream.init(4 << 20);
+        billboards.init();
 
         float lastFrame = glfwGetTime();
+        double accumulator = 0.0;
 
         while (!glfwWindowShouldClose(window))
         {
@@ -371,12 +446,20 @@ int App::run(void)
             float deltaTime = currentFrame - lastFrame;
             lastFrame = currentFrame;
 
-            camera.processKeyboard(pressedKeys, deltaTime);
-            for (auto& [name, entity] : entities) {
-                float height = height_map.getHeightAt(entity->position);
-                entity->update(deltaTime, height);
+            // Fixed-step simulation; rendering interpolates between the last two steps
+            accumulator += std::min(deltaTime, MAX_FRAME_TIME);
+            int steps = 0;
+            while (accumulator >= SIM_STEP && steps < MAX_SIM_STEPS) {
+                simulate(SIM_STEP);
+                accumulator -= SIM_STEP;
+                ++steps;
             }
-            flashlight->position = camera.position + glm::vec3(0.0f, 3.0f, 0.0f);
+            if (steps == MAX_SIM_STEPS) {
+                accumulator = std::fmod(accumulator, SIM_STEP); // too far behind, drop the backlog
+            }
+            const float alpha = static_cast<float>(accumulator / SIM_STEP);
+
+            flashlight->position = camera.position() + glm::vec3(0.0f, 3.0f, 0.0f);
             flashlight->direction = camera.cameraFront;
 
             float sunAngle = currentFrame * 0.3f; // speed of day cycle
@@ -393,53 +476,11 @@ int App::run(void)
 
             glClearColor(r, g, b, 1.0f); // background
 
-            pointLight->position = camera.position+glm::vec3(0.0f, 20.0f, 0.0f);
-
-            Particles::update(deltaTime);
-
-            // Collisions
-            for (auto& [nameA, a] : entities) {
-                for (auto& [nameB, b] : entities) {
-                    if (a == b) continue;
+            pointLight->position = camera.position() + glm::vec3(0.0f, 20.0f, 0.0f);
 
-                    float dist = glm::distance(a->position, b->position);
-                    float combinedRadius = a->getCollisionRadius() + b->getCollisionRadius();
-
-                    if (dist < combinedRadius) {
-                        glm::vec3 aMin = a->position + a->model->boundingBoxMin;
-                        glm::vec3 aMax = a->position + a->model->boundingBoxMax;
-                        glm::vec3 bMin = b->position + b->model->boundingBoxMin;
-                        glm::vec3 bMax = b->position + b->model->boundingBoxMax;
-
-                        bool intersects =
-                            (aMin.x <= bMax.x && aMax.x >= bMin.x) &&
-                            (aMin.y <= bMax.y && aMax.y >= bMin.y) &&
-                            (aMin.z <= bMax.z && aMax.z >= bMin.z);
-
-                        if (!intersects) continue;
-
-                        // Normalize direction from B to A
-                        glm::vec3 dir = glm::normalize(a->position - b->position);
-
-                        // Push each entity away from the other by half the overlap
-                        float overlap = combinedRadius - dist;
-                        glm::vec3 correction = dir * (overlap * 0.5f);
-
-                        // bounce a bit (exchange momentum or apply force)
-                        a->velocity += dir * 10.0f; // tweak strength as needed
-                        b->velocity -= dir * 10.0f;
-
-                        // Get bounding box world-space centers
-                        glm::vec3 centerA = a->position + (a->model->boundingBoxMin + a->model->boundingBoxMax) * 0.5f;
-                        glm::vec3 centerB = b->position + (b->model->boundingBoxMin + b->model->boundingBoxMax) * 0.5f;
-
-                        // Midpoint between bounding box centers
-                        glm::vec3 impactPoint = (centerA + centerB) * 0.5f;
-
-                        // Spawn particles at the impact point
-                        Particles::spawn(impactPoint, 100);
-                    }
-                }
+            if (terrain_bake.ready() && !terrain_bake.applied()) {
+                terrain_bake.apply(height_map);
+                height_map.setShader(terrain_baked_shader);
             }
 
             // FPS calculations
@@ -449,20 +490,27 @@ int App::run(void)
             if (timeDiff >= 1.0) {
                 std::string FPS = std::to_string((1.0 / timeDiff) * counter) + " FPS";
                 std::string vsync_status = "Vsync: " + std::string((vsync_on) ? "On" : "Off");
-                glfwSetWindowTitle(window, (FPS + " " + vsync_status).c_str());
+                const ScatterStats& scatterStats = scatter.getStats();
+                std::string scatter_status = "Scatter: " + std::to_string(scatterStats.instances) + " inst / "
+                    + std::to_string(scatterStats.drawCalls) + " draws";
+                const UpdateSchedulerStats& simStats = world.scheduler.getStats();
+                std::string sim_status = "Entities: " + std::to_string(simStats.awake) + " awake / "
+                    + std::to_string(simStats.ticked) + " ticked";
+                glfwSetWindowTitle(window, (FPS + " " + vsync_status + " " + scatter_status + " " + sim_status).c_str());
                 prevTime = crntTime;
                 counter = 0;
             }
 
             // Clear screen
             glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            frameStream.beginFrame();
 
             // Set uniform color
             glUniform4f(uniform_color_location, r, g, b, a);
 
             // Camera transformation: Update `view` based on movement
             glm::mat4 projection = glm::perspective(glm::radians(45.0f), 800.0f / 600.0f, 0.1f, 1000.0f);
-            glm::mat4 view = camera.getViewMatrix(); // Get updated camera view
+            glm::mat4 view = camera.getViewMatrix(alpha); // Get updated camera view
 
             Frustum frustum = extractFrustum(projection * view);
 
@@ -478,9 +526,11 @@ int App::run(void)
             }
 
             height_map.draw(projection, view, lights);
+            const glm::vec3 eye = camera.getEfPos(alpha);
+            scatter.draw(projection, view, frustum, eye, lights);
             if (debug) {
-                for (auto& [name, entity] : entities) {
-                    entity->drawBoundingBox(projection, view, debug_shader);
+                for (uint32_t i = 0; i < world.entities.size(); ++i) {
+                    if (world.entities.models[i]) world.entities.view(i).drawBoundingBox(projection, view, debug_shader, frameStream);
                 }
             }
 
@@ -489,27 +539,40 @@ int App::run(void)
                 model.draw(projection, view, lights);
             }
 
-            Particles::drawParticles(projection, view, debug_shader);
+            if (Particles::backend == Particles::Backend::Gpu) {
+                gpuParticles.update();
+                gpuParticles.draw(projection, view);
+            }
+            else {
+                billboards.draw(projection, view, frameStream, &world.jobs);
+            }
 
             transparent.clear();
+            syncEntityTransforms(alpha);
             // Render Dynamic Entities (Entities)
-            for (auto& [name, entity] : entities) {
-                if (entity->model->alpha == 1) {
-                    entity->render(projection, view, frustum, lights);
+            for (uint32_t i = 0; i < world.entities.size(); ++i) {
+                Model* model = world.entities.models[i];
+                if (!model) continue;
+                if (!isInsideFrustum(frustum, model->boundingSphereRadius, renderPositions[i])) continue;
+
+                if (model->alpha == 1) {
+                    model->draw(projection, view, lights, transforms.world(entityTransforms[world.entities.handles[i].index].node));
                 }
                 else {
-                    transparent.push_back(entity);
+                    transparent.push_back(i);
                 }
             }
 
-            std::sort(transparent.begin(), transparent.end(), [&](Entity const* a, Entity const* b) {
-                return glm::distance(camera.getEfPos(), a->position) > glm::distance(camera.getEfPos(), b->position);
+            std::sort(transparent.begin(), transparent.end(), [&](uint32_t a, uint32_t b) {
+                return glm::distance(eye, renderPositions[a]) > glm::distance(eye, renderPositions[b]);
                 });
 
-            for (Entity* entity : transparent) {
-                entity->render(projection, view, frustum, lights);
+            for (uint32_t i : transparent) {
+                world.entities.models[i]->draw(projection, view, lights, transforms.world(entityTransforms[world.entities.handles[i].index].node));
             }
 
+            frameStream.endFrame();
+
             // Poll events and swap buffers
             glfwPollEvents();
             glfwSwapBuffers(window);
@@ -524,6 +587,103 @@ int App::run(void)
     return EXIT_SUCCESS;
 }
 
+// Entity nodes follow the interpolated simulation state, placed where the mesh pivot is
+// (position + model origin, turned by the yaw). The hierarchy then recomputes only the
+// entities that moved, plus whatever hangs below them.
+void App::syncEntityTransforms(float alpha) {
+    const EntityStore& entities = world.entities;
+    for (EntityTransform& t : entityTransforms) {
+        if (t.node != TransformHierarchy::NONE && entities.indexOf(t.entity) == EntityStore::INVALID) {
+            transforms.destroy(t.node);
+            t.node = TransformHierarchy::NONE;
+        }
+    }
+
+    renderPositions.resize(entities.size());
+    for (uint32_t i = 0; i < entities.size(); ++i) {
+        const Model* model = entities.models[i];
+        if (!model) continue;
+        renderPositions[i] = entities.renderPosition(i, alpha);
+
+        const EntityHandle handle = entities.handles[i];
+        if (entityTransforms.size() <= handle.index) entityTransforms.resize(handle.index + 1);
+        EntityTransform& t = entityTransforms[handle.index];
+        if (t.node == TransformHierarchy::NONE) {
+            t.entity = handle;
+            t.node = transforms.create();
+        }
+        const float yaw = -entities.renderYaw(i, alpha) - 90.0f;
+        transforms.setTranslation(t.node, renderPositions[i] + model->origin);
+        transforms.setRotation(t.node, glm::angleAxis(glm::radians(yaw), glm::vec3(0.0f, 1.0f, 0.0f)));
+    }
+    transforms.update(&world.jobs);
+}
+
+void App::simulate(float dt) {
+    world.entities.beginStep();
+    camera.processKeyboard(pressedKeys, dt);
+    world.step(dt, camera.position());
+}
+
+void App::quickSave() {
+    try {
+        auto start = std::chrono::steady_clock::now();
+        SnapshotWriter w;
+        world.save(w);
+        camera.save(w);
+        w.saveToFile(QUICKSAVE_FILE);
+        std::chrono::duration<double, std::milli> ms = std::chrono::steady_clock::now() - start;
+        std::cout << "Quick save: " << w.buffer.size() / 1024 << " KiB in " << ms.count() << " ms\n";
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Quick save failed: " << e.what() << std::endl;
+    }
+}
+
+void App::quickLoad() {
+    try {
+        auto start = std::chrono::steady_clock::now();
+        SnapshotReader r = SnapshotReader::fromFile(QUICKSAVE_FILE);
+        // The camera is decoded and its body checked before the world is replaced,
+        // so a bad save never leaves the camera on a dead entity
+        Camera::Loaded loadedCamera;
+        const bool hasCamera = Camera::decode(r, loadedCamera);
+        world.load(r, [&](const EntityStore::Loaded& entities) {
+            if (!entities.contains(hasCamera ? loadedCamera.body : camera.body)) throw std::runtime_error("Snapshot has no live camera body");
+        });
+        if (hasCamera) camera.apply(loadedCamera);
+        std::chrono::duration<double, std::milli> ms = std::chrono::steady_clock::now() - start;
+        std::cout << "Quick load: " << world.entities.size() << " entities in " << ms.count() << " ms\n";
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Quick load failed: " << e.what() << std::endl;
+    }
+}
+
+void App::toggleGpuParticles() {
+    if (Particles::backend == Particles::Backend::Gpu) {
+        Particles::setBackend(Particles::Backend::Cpu);
+        std::cout << "Particles: CPU\n";
+        return;
+    }
+    try {
+        if (!gpuParticles.init()) return;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "GPU particles failed: " << e.what() << std::endl;
+        return;
+    }
+    gpuParticles.clear();
+    Particles::setBackend(Particles::Backend::Gpu);
+    std::cout << "Particles: GPU compute\n";
+}
+
+void App::toggleParticleBlend() {
+    BillboardBlend& blend = billboards.settings.blend;
+    blend = blend == BillboardBlend::Additive ? BillboardBlend::Alpha : BillboardBlend::Additive;
+    std::cout << "Particle blending: " << (blend == BillboardBlend::Alpha ? "alpha, sorted" : "additive") << "\n";
+}
+
 void App::error_callback(int error, const char* description) {
     std::cerr << "Error: " << description << std::endl;
 }
@@ -614,6 +774,18 @@ void App::key_callback(GLFWwindow* window, int key, int scancode, int action, in
         case GLFW_KEY_M:
 			this_inst->debug = !this_inst->debug;
             break;
+        case GLFW_KEY_F5:
+            this_inst->quickSave();
+            break;
+        case GLFW_KEY_F9:
+            this_inst->quickLoad();
+            break;
+        case GLFW_KEY_G:
+            this_inst->toggleGpuParticles();
+            break;
+        case GLFW_KEY_P:
+            this_inst->toggleParticleBlend();
+            break;
         case GLFW_KEY_L:
         {
             GLFWmonitor* monitor = glfwGetPrimaryMonitor();
@@ -8,12 +8,19 @@
 #include <unordered_set>
 #include "Model.hpp"
 #include "Camera.hpp"
-#include "entity.hpp"
+#include "World.hpp"
+#include "ScriptedBehaviors.hpp"
 #include <opencv2/opencv.hpp>
 #include <opencv2/core.hpp>  // Ensure core OpenCV components are included
 #include "mapgen.hpp"
+#include "HeightField.hpp"
+#include "TerrainBake.hpp"
+#include "Scatter.hpp"
+#include "GpuParticles.hpp"
+#include "ParticleBillboards.hpp"
 #include "LightSource.hpp"
 #include "SettingManager.hpp"
+#include "TransformHierarchy.hpp"
 
 
 class App {
@@ -32,17 +39,53 @@ private:
     double timeDiff;    
     unsigned int counter = 0;
     std::unordered_map<std::string, Model> scene;
-    std::unordered_map<std::string, Entity*> entities;
-    std::vector<Entity*> transparent;
+    World world;
+    std::vector<uint32_t> transparent; // dense indices, rebuilt every frame
+    std::vector<glm::vec3> renderPositions; // interpolated, rebuilt every frame
+
+    // Render transforms. Every entity with a model has a node (by entity slot); props and
+    // rigs can be attached under it.
+    TransformHierarchy transforms;
+    struct EntityTransform {
+        EntityHandle entity;
+        TransformHierarchy::Id node = TransformHierarchy::NONE;
+    };
+    std::vector<EntityTransform> entityTransforms;
+    void syncEntityTransforms(float alpha);
 
 
     float heightScale = 50.0f;
     Mesh height_map;
+    TerrainBaker terrain_bake;
+    ShaderProgram terrain_baked_shader;
+    Scatter scatter;
+    GpuParticles gpuParticles;
+    StreamBuffer frameStream;   // per-frame vertex data (sparks, debug boxes)
+    ParticleBillboards billboards;
 public:
     App();
     static GLuint textureInit(const std::filesystem::path& file_name);
     static GLuint gen_tex(cv::Mat& image);
     void init_hm();
+    void init_scatter();
+    void init_props();
+    Model* propModel = nullptr;     // streamed props, placed by init_props()
+
+    // Simulation runs at a fixed rate, independent of the frame rate
+    static constexpr double SIM_STEP = World::STEP;
+    static constexpr int MAX_SIM_STEPS = 5;       // per frame, avoids the spiral of death
+    static constexpr float MAX_FRAME_TIME = 0.25f;
+    void simulate(float dt);
+
+    // F5 / F9
+    static constexpr const char* QUICKSAVE_FILE = "quicksave.pg2s";
+    void quickSave();
+    void quickLoad();
+
+    // G: sparks simulated on the CPU or by compute shaders
+    void toggleGpuParticles();
+    // P: additive or depth-sorted alpha blending of the CPU sparks
+    void toggleParticleBlend();
     std::vector<LightSource*> lights;
 	SettingManager settings = SettingManager("settings.json");
 
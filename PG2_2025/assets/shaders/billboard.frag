@@ -0,0 +1,18 @@
+#version 460 core
+in vec2 uv;
+in vec4 colour;
+out vec4 FragColor;
+
+uniform sampler2D uSprite;
+uniform int uTextured;      // 0: soft round dot
+
+void main() {
+    if (uTextured != 0) {
+        FragColor = colour * texture(uSprite, uv);
+    }
+    else {
+        float r = length(uv - 0.5) * 2.0;
+        FragColor = vec4(colour.rgb, colour.a * (1.0 - smoothstep(0.2, 1.0, r)));
+    }
+    if (FragColor.a < 0.004) discard;
+}
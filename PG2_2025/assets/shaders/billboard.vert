@@ -0,0 +1,24 @@
+#version 460 core
+
+// Per instance, see BillboardInstance in ParticleBillboards.hpp
+layout(location = 0) in vec3 aPosition;
+layout(location = 1) in float aSize;
+layout(location = 2) in vec4 aColour;
+layout(location = 3) in float aLife;
+
+uniform mat4 uViewProjection;
+uniform vec3 uCameraRight;
+uniform vec3 uCameraUp;
+uniform float uFadeTime;
+
+out vec2 uv;
+out vec4 colour;
+
+void main() {
+    // Triangle strip corners from the vertex index: (0,0) (1,0) (0,1) (1,1)
+    uv = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    vec2 corner = (uv - 0.5) * aSize;
+    vec3 world = aPosition + uCameraRight * corner.x + uCameraUp * corner.y;
+    colour = vec4(aColour.rgb, aColour.a * clamp(aLife / uFadeTime, 0.0, 1.0));
+    gl_Position = uViewProjection * vec4(world, 1.0);
+}
@@ -1,6 +0,0 @@
-#version 460 core
-out vec4 FragColor;
-
-void main() {
-    FragColor = vec4(1.0, 0.7, 0.2, 1.0); // orange particles
-}
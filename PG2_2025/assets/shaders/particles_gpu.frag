@@ -0,0 +1,6 @@
+#version 430 core
+out vec4 FragColor;
+uniform vec4 color;
+void main() {
+    FragColor = color;
+}
@@ -0,0 +1,15 @@
+#version 430 core
+
+struct Particle {
+    vec4 positionLife;
+    vec4 velocity;
+};
+
+// Written by the compute passes in GpuParticles.hpp; no vertex attributes
+layout(std430, binding = 1) readonly buffer Particles { Particle particles[]; };
+
+uniform mat4 uMVP;
+
+void main() {
+    gl_Position = uMVP * vec4(particles[gl_VertexID].positionLife.xyz, 1.0);
+}
@@ -0,0 +1,42 @@
+#version 460 core
+
+layout(location = 0) in vec3 aPos;
+layout(location = 1) in vec3 aNormal;
+layout(location = 2) in vec2 aTexCoords;
+layout(location = 3) in vec3 aColor;
+
+// Per-instance data, see ScatterInstance in Scatter.hpp
+struct Instance {
+    vec4 positionYaw;
+    vec4 scale;
+};
+
+layout(std430, binding = 0) readonly buffer Instances {
+    Instance instances[];
+};
+
+uniform mat4 uMVP;   // projection * view (model transform comes from the instance)
+uniform mat4 uModel; // mesh-local offset
+
+out vec3 fragPos;
+out vec3 normal;
+out vec2 TexCoords;
+
+void main()
+{
+    Instance inst = instances[gl_BaseInstance + gl_InstanceID];
+    float c = cos(inst.positionYaw.w);
+    float s = sin(inst.positionYaw.w);
+    mat3 rotation = mat3(c, 0.0, -s,
+                         0.0, 1.0, 0.0,
+                         s, 0.0, c);
+
+    vec3 local = vec3(uModel * vec4(aPos, 1.0)) * inst.scale.x;
+    vec3 world = inst.positionYaw.xyz + rotation * local;
+
+    fragPos = world;
+    normal = rotation * aNormal;
+    TexCoords = aTexCoords;
+
+    gl_Position = uMVP * vec4(world, 1.0);
+}
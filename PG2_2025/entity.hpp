@@ -1,74 +1,93 @@
 #pragma once
+#include <cstdint>
+#include <vector>
+#include <functional>
+#include <iostream>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include "Model.hpp"
 #include "LightSource.hpp"
 #include "Frustum.hpp"
+#include "StreamBuffer.hpp"
 
-class Entity {
-public:
-    glm::vec3 position;
-    glm::vec3 velocity;
-    glm::vec3 acceleration;
-
-    glm::vec3 front;
-    glm::vec3 up;
-    glm::vec3 right;
-    glm::vec3 worldUp;
-
-    using Behavior = std::function<void(Entity&, float)>;
-    std::vector<Behavior> behaviors;
-
-    float yaw;
-    float pitch;
+class CommandBuffer;
 
-    float movementSpeed;
-    float drag;
-    float gravity;
-    bool isGrounded;
+// Generational handle into an EntityStore. Stays valid while the entity lives,
+// and is rejected once the slot is recycled for another entity.
+struct EntityHandle {
+    uint32_t index = UINT32_MAX;   // slot index
+    uint32_t generation = 0;       // 0 is never a live generation
 
-    Model* model; // Pointer to a 3D model (optional)
-
-    Entity(glm::vec3 startPosition, Model* entityModel = nullptr)
-        : position(startPosition), velocity(glm::vec3(0.0f)), acceleration(glm::vec3(0.0f)),
-        front(glm::vec3(0.0f, 0.0f, -1.0f)), up(glm::vec3(0.0f, 1.0f, 0.0f)), worldUp(up),
-        yaw(-90.0f), pitch(0.0f), movementSpeed(100.0f), drag(0.1f), gravity(-9.81f),
-        isGrounded(true), model(entityModel) {
-        updateOrientation();
-    }
+    bool isNull() const { return generation == 0; }
+    bool operator==(const EntityHandle& o) const { return index == o.index && generation == o.generation; }
+    bool operator!=(const EntityHandle& o) const { return !(*this == o); }
+};
 
-    virtual void update(float deltaTime, float groundHeight) {
-        // Apply gravity if not grounded
-        if (!isGrounded) {
-            acceleration.y += gravity;
-        }
+// === Components (stored in contiguous arrays by EntityStore) ===
 
-        for (auto& b : behaviors) {
-            b(*this, deltaTime);
-        }
-
-        // Integrate acceleration into velocity
-        velocity += acceleration * deltaTime;
+// Cold: only touched when rotating or by behaviors that need a facing direction
+struct Orientation {
+    float yaw = -90.0f;
+    float pitch = 0.0f;
+    glm::vec3 front{ 0.0f, 0.0f, -1.0f };
+    glm::vec3 right{ 1.0f, 0.0f, 0.0f };
+    glm::vec3 up{ 0.0f, 1.0f, 0.0f };
+};
 
-        // Apply drag only to horizontal movement
-        velocity.x *= pow(drag, deltaTime);
-        velocity.z *= pow(drag, deltaTime);
+struct PhysicsBody {
+    float movementSpeed = 100.0f;
+    float drag = 0.1f;
+    float gravity = -9.81f;
+    bool isGrounded = true;
+};
 
-        // Update position
-        position += velocity * deltaTime;
+// Update scheduling state, owned by UpdateScheduler
+struct Activity {
+    float restTime = 0.0f;     // seconds spent at rest while awake
+    float pendingTime = 0.0f;  // simulation time not yet integrated (reduced tick rate)
+    bool sleeping = false;
+    bool supported = false;    // resting on another entity (ContactSolver)
+};
 
-        // Check for ground collision
-        if (position.y <= groundHeight) {
-            position.y = groundHeight;
-            velocity.y = 0;
-            isGrounded = true;
-        }
-        else {
-            isGrounded = false;
-        }
+// Lightweight view of one entity's components inside an EntityStore.
+// Only valid until the next create()/destroy() on the store.
+//
+// Behavior contract: behaviors may run on worker threads during EntityStore::integrate.
+// A behavior may only read and write its own entity through `self`. Spawning, destroying
+// or touching any other entity must be recorded in `self.commands`, which is applied
+// after the update phase, in a deterministic order.
+class Entity {
+public:
+    using Behavior = std::function<void(Entity&, float)>;
 
-        // Reset acceleration (forces apply for one frame)
-        acceleration = glm::vec3(0.0f);
+    const EntityHandle handle;
+    CommandBuffer* commands = nullptr; // set while behaviors run
+
+    glm::vec3& position;
+    glm::vec3& velocity;
+    glm::vec3& acceleration;
+
+    glm::vec3& front;
+    glm::vec3& up;
+    glm::vec3& right;
+    float& yaw;
+    float& pitch;
+
+    float& movementSpeed;
+    float& drag;
+    float& gravity;
+    bool& isGrounded;
+
+    Model*& model;
+    std::vector<Behavior>& behaviors;
+
+    Entity(EntityHandle handle, glm::vec3& position, glm::vec3& velocity, glm::vec3& acceleration,
+        Orientation& orientation, PhysicsBody& body, Model*& model, std::vector<Behavior>& behaviors)
+        : handle(handle), position(position), velocity(velocity), acceleration(acceleration),
+        front(orientation.front), up(orientation.up), right(orientation.right),
+        yaw(orientation.yaw), pitch(orientation.pitch),
+        movementSpeed(body.movementSpeed), drag(body.drag), gravity(body.gravity), isGrounded(body.isGrounded),
+        model(model), behaviors(behaviors) {
     }
 
     void addBehavior(Behavior b) {
@@ -79,7 +98,7 @@ public:
         acceleration += force;
     }
 
-    virtual void jump(float jumpStrength) {
+    void jump(float jumpStrength) {
         if (isGrounded) {
             velocity.y = jumpStrength;
             isGrounded = false;
@@ -100,6 +119,7 @@ public:
 
     // Update front, right, up vectors based on yaw & pitch
     void updateOrientation() {
+        static const glm::vec3 worldUp(0.0f, 1.0f, 0.0f);
         glm::vec3 direction;
         direction.x = cos(glm::radians(yaw)) * cos(glm::radians(pitch));
         direction.y = sin(glm::radians(pitch));
@@ -115,17 +135,23 @@ public:
     }
 
     // Render the entity
-    void render(const glm::mat4& projection, const glm::mat4& view, Frustum f, const std::vector<LightSource*> lights) {
-        if (!isInsideFrustum(f, model->boundingSphereRadius, position)) {
+    void render(const glm::mat4& projection, const glm::mat4& view, const Frustum& f, const std::vector<LightSource*>& lights) {
+        render(projection, view, f, lights, position, yaw);
+    }
+
+    // Render at an explicit (e.g. interpolated) transform
+    void render(const glm::mat4& projection, const glm::mat4& view, const Frustum& f, const std::vector<LightSource*>& lights,
+        const glm::vec3& drawPosition, float drawYaw) {
+        if (!model) return;
+        if (!isInsideFrustum(f, model->boundingSphereRadius, drawPosition)) {
             return; // Skip draw
         }
-        if (model) {
-            glm::vec3 modelRotation = glm::vec3(0.0f, -yaw + -90.0f, 0.0f);
-            model->draw(projection, view, lights, position-model->origin, modelRotation);
-        }
+        glm::vec3 modelRotation = glm::vec3(0.0f, -drawYaw + -90.0f, 0.0f);
+        model->draw(projection, view, lights, drawPosition - model->origin, modelRotation);
     }
 
-    void drawBoundingBox(const glm::mat4& projection, const glm::mat4& view, ShaderProgram& debugShader) const {
+    // Lines go through the per-frame stream, not a buffer of their own
+    void drawBoundingBox(const glm::mat4& projection, const glm::mat4& view, ShaderProgram& debugShader, StreamBuffer& stream) const {
         if (!model) {
             std::cerr << "[drawBoundingBox] Warning: Entity has no model.\n";
             return;
@@ -152,22 +178,11 @@ public:
             0,4, 1,5, 2,6, 3,7
         };
 
-        std::vector<glm::vec3> lines;
-        lines.reserve(24);
+        GLint first = 0;
+        glm::vec3* lines = stream.allocate<glm::vec3>(24, first);
+        if (!lines) return;
         for (int i = 0; i < 24; ++i)
-            lines.push_back(corners[indices[i]]);
-
-        // === DSA Setup ===
-        GLuint VAO, VBO;
-        glCreateVertexArrays(1, &VAO);
-        glCreateBuffers(1, &VBO);
-
-        glNamedBufferData(VBO, lines.size() * sizeof(glm::vec3), lines.data(), GL_STATIC_DRAW);
-        glVertexArrayVertexBuffer(VAO, 0, VBO, 0, sizeof(glm::vec3));
-
-        glEnableVertexArrayAttrib(VAO, 0);
-        glVertexArrayAttribFormat(VAO, 0, 3, GL_FLOAT, GL_FALSE, 0);
-        glVertexArrayAttribBinding(VAO, 0, 0);
+            lines[i] = corners[indices[i]];
 
         // === Set uniforms without binding shader ===
         glm::mat4 modelMat = glm::translate(glm::mat4(1.0f), position) *
@@ -181,12 +196,9 @@ public:
 
         // Draw without binding
         glUseProgram(programID);
-        glBindVertexArray(VAO);
-        glDrawArrays(GL_LINES, 0, static_cast<GLsizei>(lines.size()));
+        glBindVertexArray(stream.positionArray());
+        glDrawArrays(GL_LINES, first, 24);
         glBindVertexArray(0);
         glUseProgram(0);
-
-        glDeleteBuffers(1, &VBO);
-        glDeleteVertexArrays(1, &VAO);
     }
 };
@@ -3,15 +3,27 @@
 #include "app.hpp"
 #include <chrono>
 #include <filesystem>
+#include <string>
+#include "Benchmarks.hpp"
+#include "Headless.hpp"
 
-// global App instance
-App app;
-
-int main()
+int main(int argc, char* argv[])
 {
     auto start = std::chrono::steady_clock::now();
 
+    // CPU benchmarks, no window: --bench [name]
+    if (argc > 1 && std::string(argv[1]) == "--bench") {
+        return Benchmarks::run(argc > 2 ? argv[2] : "all");
+    }
+
     try {
+        // Simulation only, no window or GL context: --headless [options]
+        if (argc > 1 && std::string(argv[1]) == "--headless") {
+            return Headless::run(Headless::parseArgs(argc, argv));
+        }
+
+        // Constructed after the mode checks: its destructor releases GL objects
+        App app;
         if (app.init(0)) {
             app.init_assets();
             app.init_hm();
@@ -64,6 +64,29 @@ Mesh MapGen::GenHeightMap(const cv::Mat& hmap, unsigned int mesh_step_size, floa
     return Mesh(GL_TRIANGLES, my_shader, vertices, indices, glm::vec3(0, 0, 0), glm::vec3(0, 0, 0), texID);
 }
 
+HeightField MapGen::GenHeightField(const cv::Mat& hmap, unsigned int mesh_step_size, float heightScale)
+{
+    HeightField field;
+    field.step = static_cast<float>(mesh_step_size);
+    field.xOffset = (hmap.cols - mesh_step_size) / 2.0f;
+    field.zOffset = (hmap.rows - mesh_step_size) / 2.0f;
+
+    // Same sample points as GenHeightMap: quads start at x < cols - step, plus the far edge
+    field.cols = (hmap.cols - mesh_step_size + mesh_step_size - 1) / mesh_step_size + 1;
+    field.rows = (hmap.rows - mesh_step_size + mesh_step_size - 1) / mesh_step_size + 1;
+    field.heights.resize(static_cast<size_t>(field.cols) * field.rows);
+
+    for (int j = 0; j < field.rows; ++j) {
+        for (int i = 0; i < field.cols; ++i) {
+            int x = std::min(i * static_cast<int>(mesh_step_size), hmap.cols - 1);
+            int z = std::min(j * static_cast<int>(mesh_step_size), hmap.rows - 1);
+            field.heights[static_cast<size_t>(j) * field.cols + i] = hmap.at<uchar>(cv::Point(x, z)) / 255.0f * heightScale;
+        }
+    }
+
+    return field;
+}
+
 glm::vec2 MapGen::get_subtex_st(int x, int y) {
     return glm::vec2(x * 1.0f / 16, y * 1.0f / 16);
 }